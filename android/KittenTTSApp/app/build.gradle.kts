@@ -54,6 +54,12 @@ android {
 
     // jniLibs default is src/main/jniLibs — AGP 9 picks it up automatically.
     // assets default is src/main/assets — same.
+
+    // Store the model uncompressed so the native side can mmap it straight
+    // out of the APK (KittenTtsLib.nativeModelLoadFromAssets).
+    androidResources {
+        noCompress += listOf("onnx", "npz")
+    }
 }
 
 
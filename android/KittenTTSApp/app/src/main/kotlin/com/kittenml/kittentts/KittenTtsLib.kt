@@ -1,5 +1,7 @@
 package com.kittenml.kittentts
 
+import android.content.res.AssetManager
+
 /**
  * Thin Kotlin wrapper around the native JNI bridge (libkittentts_jni.so).
  *
@@ -14,8 +16,12 @@ package com.kittenml.kittentts
  * | Call                    | Release with        |
  * |-------------------------|---------------------|
  * | [nativeModelLoad]       | [nativeModelFree]   |
+ * | [nativeModelLoadFromAssets] | [nativeModelFree] |
  * | [nativeModelVoices]     | automatic (String)  |
  * | [nativeSynthesizeToFile]| automatic (String?) |
+ * | [nativeSynthesizeToShortArray], [nativeSynthesizeToFloatArray] | automatic (array) |
+ * | [nativeSynthesizeIntoBuffer] | caller-owned direct buffer |
+ * | [nativeSynthesizeStream] | automatic; the chunk array is only valid during the callback |
  */
 object KittenTtsLib {
 
@@ -58,6 +64,17 @@ object KittenTtsLib {
      */
     external fun nativeModelLoad(onnxPath: String, voicesPath: String): Long
 
+    /**
+     * Load a KittenTTS model directly from APK assets, without copying them
+     * to internal storage.  Assets stored uncompressed are memory-mapped.
+     * @return opaque handle (> 0) on success, 0 on failure or if an asset is missing.
+     */
+    external fun nativeModelLoadFromAssets(
+        assets: AssetManager,
+        onnxAsset: String,
+        voicesAsset: String,
+    ): Long
+
     /** Free a model handle returned by [nativeModelLoad]. */
     external fun nativeModelFree(handle: Long)
 
@@ -80,4 +97,79 @@ object KittenTtsLib {
         speed: Float,
         outputPath: String,
     ): String?
+
+    // ── PCM without a file round-trip ─────────────────────────────────────────
+
+    /** `format` values for [nativeSynthesizeIntoBuffer] (mirror kittentts.h). */
+    const val SAMPLE_F32 = 0
+    const val SAMPLE_I16 = 1
+
+    /** Output sample rate of every synthesis call. */
+    const val SAMPLE_RATE = 24_000
+
+    /**
+     * Synthesise [text] to 16-bit mono PCM at [SAMPLE_RATE].
+     * Blocks until inference is complete — call from a background thread.
+     * @throws RuntimeException on failure.
+     */
+    external fun nativeSynthesizeToShortArray(
+        handle: Long,
+        text: String,
+        voice: String,
+        speed: Float,
+    ): ShortArray
+
+    /** Like [nativeSynthesizeToShortArray] but float PCM in [-1, 1]. */
+    external fun nativeSynthesizeToFloatArray(
+        handle: Long,
+        text: String,
+        voice: String,
+        speed: Float,
+    ): FloatArray
+
+    /**
+     * Synthesise into a direct [java.nio.ByteBuffer] (native byte order)
+     * without any intermediate copy.
+     *
+     * @return the number of samples.  If it exceeds the buffer's capacity
+     *         nothing was written; call again on the same thread with the same
+     *         arguments and a larger buffer — the audio is not re-synthesised.
+     * @throws RuntimeException on failure or if [buffer] is not direct.
+     */
+    external fun nativeSynthesizeIntoBuffer(
+        handle: Long,
+        text: String,
+        voice: String,
+        speed: Float,
+        format: Int,
+        buffer: java.nio.ByteBuffer,
+    ): Int
+
+    /**
+     * Synthesise sentence by sentence, calling [listener] on this thread as
+     * soon as each chunk is ready.  Blocks until done — call from a
+     * background thread.
+     *
+     * @return `null` on success or early stop, or a UTF-8 error message.
+     *         An exception thrown by [listener] stops synthesis and is rethrown.
+     */
+    external fun nativeSynthesizeStream(
+        handle: Long,
+        text: String,
+        voice: String,
+        speed: Float,
+        listener: PcmChunkListener,
+    ): String?
+}
+
+/** Receives streamed PCM from [KittenTtsLib.nativeSynthesizeStream]. */
+fun interface PcmChunkListener {
+    /**
+     * @param pcm        16-bit mono PCM at [KittenTtsLib.SAMPLE_RATE]; only the
+     *                   first [size] samples are valid.  The array is reused for
+     *                   the next chunk, so consume or copy it before returning.
+     * @param chunkIndex zero-based chunk (roughly sentence) index.
+     * @return `true` to continue, `false` to stop after this chunk.
+     */
+    fun onChunk(pcm: ShortArray, size: Int, chunkIndex: Int): Boolean
 }
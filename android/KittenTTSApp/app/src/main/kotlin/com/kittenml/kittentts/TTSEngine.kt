@@ -2,17 +2,20 @@ package com.kittenml.kittentts
 
 import android.content.Context
 import android.media.AudioAttributes
-import android.media.MediaPlayer
+import android.media.AudioFormat
+import android.media.AudioTrack
 import android.util.Log
 import androidx.lifecycle.ViewModel
 import androidx.lifecycle.ViewModelProvider
 import androidx.lifecycle.viewModelScope
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.Job
+import kotlinx.coroutines.channels.Channel
 import kotlinx.coroutines.delay
 import kotlinx.coroutines.flow.MutableStateFlow
 import kotlinx.coroutines.flow.StateFlow
 import kotlinx.coroutines.flow.asStateFlow
+import kotlinx.coroutines.isActive
 import kotlinx.coroutines.launch
 import kotlinx.coroutines.withContext
 import java.io.File
@@ -66,22 +69,33 @@ class TTSEngine(private val appContext: Context) : ViewModel() {
 
     // ── Private ───────────────────────────────────────────────────────────────
     private var modelHandle: Long = 0L
-    private var player: MediaPlayer? = null
-    private var lastWavFile: File? = null
+    private var track: AudioTrack? = null
+    private var lastPcm: ShortArray? = null
+    private var audioJob: Job? = null
+    private var writerJob: Job? = null
     private var progressJob: Job? = null
 
+    /** Frames handed to [track] so far, and whether more are still coming. */
+    @Volatile private var queuedFrames = 0
+    @Volatile private var feeding = false
+
     // ── Model file locations ──────────────────────────────────────────────────
     private val filesDir: File = appContext.filesDir
     private val cacheDir: File = appContext.cacheDir
 
-    private val onnxFile   = File(filesDir, "kitten_tts_mini_v0_8.onnx")
-    private val voicesFile = File(filesDir, "voices.npz")
+    private val onnxFile   = File(filesDir, ONNX_NAME)
+    private val voicesFile = File(filesDir, VOICES_NAME)
     private val configFile = File(filesDir, "config.json")
 
+    /** True when the model ships in the APK and is loaded from assets in place. */
+    private var useBundledAssets = false
+
     private val espeakDataDir = File(filesDir, "espeak-ng-data")
 
     private companion object {
         const val HF_BASE = "https://huggingface.co/KittenML/kitten-tts-mini-0.8/resolve/main"
+        const val ONNX_NAME = "kitten_tts_mini_v0_8.onnx"
+        const val VOICES_NAME = "voices.npz"
     }
 
     // ─────────────────────────────────────────────────────────────────────────
@@ -91,7 +105,7 @@ class TTSEngine(private val appContext: Context) : ViewModel() {
 
     override fun onCleared() {
         super.onCleared()
-        releasePlayer()
+        stop()
         if (modelHandle != 0L) {
             KittenTtsLib.nativeModelFree(modelHandle)
             modelHandle = 0L
@@ -189,26 +203,24 @@ class TTSEngine(private val appContext: Context) : ViewModel() {
     // MARK: - Model download
 
     private suspend fun ensureModels() = withContext(Dispatchers.IO) {
+        // Bundled in assets (built by build_rust_android.sh): the native side
+        // maps them straight out of the APK, so nothing is copied.
+        useBundledAssets = listOf(ONNX_NAME, VOICES_NAME).all { name ->
+            try {
+                appContext.assets.open("models/$name").close(); true
+            } catch (_: Exception) { false }
+        }
+        if (useBundledAssets) {
+            Log.i(TAG, "Using bundled model assets in place")
+            return@withContext
+        }
+
         val needed = listOf(
-            onnxFile   to "kitten_tts_mini_v0_8.onnx",
-            voicesFile to "voices.npz",
+            onnxFile   to ONNX_NAME,
+            voicesFile to VOICES_NAME,
             configFile to "config.json",
         )
 
-        // Check if all bundled in assets first (built by build_rust_android.sh)
-        for ((dest, assetName) in needed) {
-            if (!dest.exists()) {
-                try {
-                    appContext.assets.open("models/$assetName").use { src ->
-                        dest.outputStream().use { dst -> src.copyTo(dst) }
-                    }
-                    Log.i(TAG, "Copied $assetName from assets")
-                } catch (_: Exception) {
-                    // Not in assets — will download below
-                }
-            }
-        }
-
         val missing = needed.filter { (dest, _) -> !dest.exists() }
         if (missing.isEmpty()) return@withContext
 
@@ -304,11 +316,20 @@ class TTSEngine(private val appContext: Context) : ViewModel() {
         Log.i(TAG, "Setting espeak data path: $dataPath")
         KittenTtsLib.nativeSetEspeakDataPath(dataPath)
 
-        Log.i(TAG, "Loading model: ${onnxFile.absolutePath}")
-        val handle = KittenTtsLib.nativeModelLoad(
-            onnxFile.absolutePath,
-            voicesFile.absolutePath,
-        )
+        val handle = if (useBundledAssets) {
+            Log.i(TAG, "Loading model from assets: models/$ONNX_NAME")
+            KittenTtsLib.nativeModelLoadFromAssets(
+                appContext.assets,
+                "models/$ONNX_NAME",
+                "models/$VOICES_NAME",
+            )
+        } else {
+            Log.i(TAG, "Loading model: ${onnxFile.absolutePath}")
+            KittenTtsLib.nativeModelLoad(
+                onnxFile.absolutePath,
+                voicesFile.absolutePath,
+            )
+        }
 
         if (handle == 0L) {
             withContext(Dispatchers.Main) {
@@ -335,118 +356,175 @@ class TTSEngine(private val appContext: Context) : ViewModel() {
     // ─────────────────────────────────────────────────────────────────────────
     // MARK: - Synthesis
 
+    /**
+     * Stream [text] straight into an [AudioTrack]: each sentence is played as
+     * soon as its inference finishes, with no WAV file or decoder in between.
+     */
     fun synthesize(text: String, voice: String, speed: Float) {
         if (_engineState.value != EngineState.Ready || modelHandle == 0L) return
         stop()
         _playState.value = PlayState.Synthesizing
         _synthError.value = null
 
-        val outFile = File(cacheDir, "kittentts_${System.currentTimeMillis()}.wav")
+        val at = openTrack()
+        val chunks = mutableListOf<ShortArray>()
+        // The next sentence is only synthesised once the callback returns,
+        // so the callback just queues the chunk; a writer coroutine feeds the
+        // track, blocking in write() without holding up inference.
+        val pending = Channel<ShortArray>(Channel.UNLIMITED)
+        writerJob = viewModelScope.launch(Dispatchers.IO) {
+            for (pcm in pending) enqueue(at, pcm, pcm.size)
+            feeding = false
+        }
 
-        viewModelScope.launch {
-            val errMsg = withContext(Dispatchers.Default) {
-                KittenTtsLib.nativeSynthesizeToFile(
-                    modelHandle, text, voice, speed, outFile.absolutePath
-                )
+        audioJob = viewModelScope.launch {
+            val errMsg = try {
+                withContext(Dispatchers.Default) {
+                    KittenTtsLib.nativeSynthesizeStream(modelHandle, text, voice, speed) { pcm, size, _ ->
+                        if (!isActive) return@nativeSynthesizeStream false
+                        val chunk = pcm.copyOf(size)
+                        chunks += chunk    // kept for replay
+                        pending.trySend(chunk)
+                        true
+                    }
+                }
+            } finally {
+                pending.close()
             }
 
             if (errMsg != null) {
                 Log.e(TAG, "Synthesis error: $errMsg")
                 _synthError.value = errMsg
-                _playState.value = PlayState.Idle
+                stop()
                 return@launch
             }
-
-            lastWavFile = outFile
-            playFile(outFile)
+            lastPcm = concat(chunks)
         }
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     // MARK: - Audio playback
 
-    private fun playFile(file: File) {
-        releasePlayer()
-
-        val mp = MediaPlayer().also { player = it }
-        try {
-            // AudioAttributes must be set before setDataSource on API 21+.
-            // Without this the emulator may route audio to a virtual sink that
-            // produces no audible output.
-            mp.setAudioAttributes(
+    /** A streaming 16-bit mono track at the model's sample rate. */
+    private fun openTrack(): AudioTrack {
+        val rate = KittenTtsLib.SAMPLE_RATE
+        val minBytes = AudioTrack.getMinBufferSize(
+            rate, AudioFormat.CHANNEL_OUT_MONO, AudioFormat.ENCODING_PCM_16BIT
+        )
+        return AudioTrack.Builder()
+            // Without USAGE_MEDIA the emulator may route audio to a virtual
+            // sink that produces no audible output.
+            .setAudioAttributes(
                 AudioAttributes.Builder()
                     .setUsage(AudioAttributes.USAGE_MEDIA)
                     .setContentType(AudioAttributes.CONTENT_TYPE_SPEECH)
                     .build()
             )
-            mp.setDataSource(file.absolutePath)
-            mp.prepare()
-            val durationMs = mp.duration
-
-            mp.setOnCompletionListener {
-                _playState.value = PlayState.Idle
-                _playProgress.value = 1f
-                progressJob?.cancel()
+            .setAudioFormat(
+                AudioFormat.Builder()
+                    .setSampleRate(rate)
+                    .setChannelMask(AudioFormat.CHANNEL_OUT_MONO)
+                    .setEncoding(AudioFormat.ENCODING_PCM_16BIT)
+                    .build()
+            )
+            .setTransferMode(AudioTrack.MODE_STREAM)
+            // ~0.5 s in the track; further chunks wait in the writer's queue.
+            .setBufferSizeInBytes(maxOf(minBytes, rate))
+            .build()
+            .also {
+                track = it
+                queuedFrames = 0
+                feeding = true
             }
-            mp.start()
-
-            _playState.value = PlayState.Playing(durationMs)
-            _playProgress.value = 0f
-
-            // Progress polling — ~30 fps
-            progressJob?.cancel()
-            progressJob = viewModelScope.launch {
-                while (true) {
-                    delay(33)
-                    val ps = _playState.value
-                    if (ps is PlayState.Playing) {
-                        val pos = mp.currentPosition.toFloat()
-                        _playProgress.value = if (ps.durationMs > 0)
-                            (pos / ps.durationMs).coerceIn(0f, 1f)
-                        else 0f
-                    } else {
-                        break
-                    }
+    }
+
+    /**
+     * Write PCM to [at], starting playback with the first chunk.  Runs on the
+     * writer coroutine and blocks while the track's buffer is full.
+     */
+    private fun enqueue(at: AudioTrack, pcm: ShortArray, size: Int) {
+        if (queuedFrames == 0) {
+            at.play()
+            viewModelScope.launch { trackProgress(at) }
+        }
+        queuedFrames += size
+        _playState.value = PlayState.Playing(queuedFrames * 1000 / KittenTtsLib.SAMPLE_RATE)
+        at.write(pcm, 0, size)
+    }
+
+    /** Poll the play head at ~30 fps until everything queued has played. */
+    private fun trackProgress(at: AudioTrack) {
+        progressJob?.cancel()
+        progressJob = viewModelScope.launch {
+            while (true) {
+                delay(33)
+                val queued = queuedFrames
+                val played = at.playbackHeadPosition
+                _playProgress.value =
+                    if (queued > 0) (played.toFloat() / queued).coerceIn(0f, 1f) else 0f
+                if (!feeding && played >= queued) {
+                    _playState.value = PlayState.Idle
+                    _playProgress.value = 1f
+                    releaseTrack()
+                    break
                 }
             }
-        } catch (e: Exception) {
-            Log.e(TAG, "MediaPlayer error: ${e.message}")
-            _synthError.value = e.message
-            _playState.value = PlayState.Idle
-            releasePlayer()
+        }
+    }
+
+    /** Replay the last utterance from memory. */
+    private fun playPcm(pcm: ShortArray) {
+        stop()
+        val at = openTrack()
+        audioJob = viewModelScope.launch(Dispatchers.IO) {
+            enqueue(at, pcm, pcm.size)
+            feeding = false
         }
     }
 
     fun stop() {
-        progressJob?.cancel()
-        releasePlayer()
+        halt()
         _playState.value = PlayState.Idle
         _playProgress.value = 0f
     }
 
     fun togglePlay() {
-        when (val ps = _playState.value) {
+        when (_playState.value) {
             is PlayState.Playing -> {
-                player?.pause()
-                progressJob?.cancel()
+                // Keep the progress so the bar offers a replay.
+                halt()
                 _playState.value = PlayState.Idle
             }
-            PlayState.Idle -> {
-                lastWavFile?.let { f ->
-                    if (f.exists()) playFile(f)
-                }
-            }
+            PlayState.Idle -> lastPcm?.let { playPcm(it) }
             else -> Unit
         }
     }
 
-    private fun releasePlayer() {
+    /** Cancel synthesis / feeding and release the track. */
+    private fun halt() {
+        audioJob?.cancel()
+        writerJob?.cancel()
         progressJob?.cancel()
-        player?.apply {
-            try { if (isPlaying) stop() } catch (_: Exception) {}
+        releaseTrack()
+    }
+
+    private fun releaseTrack() {
+        track?.apply {
+            // pause + flush unblocks a write() in progress on the feeding thread.
+            try { pause(); flush() } catch (_: Exception) {}
             release()
         }
-        player = null
+        track = null
+    }
+
+    private fun concat(chunks: List<ShortArray>): ShortArray {
+        val all = ShortArray(chunks.sumOf { it.size })
+        var offset = 0
+        for (c in chunks) {
+            c.copyInto(all, offset)
+            offset += c.size
+        }
+        return all
     }
 
     // ─────────────────────────────────────────────────────────────────────────
@@ -745,7 +745,7 @@ log "Compiling JNI bridge -> libkittentts_jni.so..."
     -L "$(dirname "${ORT_SO}")"  -lonnxruntime \
     -L "${ESPEAK_SO_DIR}"        -lespeak-ng \
     --sysroot "${NDK_SYSROOT}" \
-    -lc++_shared -llog -lc -lm \
+    -lc++_shared -llog -landroid -lc -lm \
     -Wl,-rpath,'$ORIGIN' \
     -Wl,--build-id
 
@@ -14,11 +14,17 @@
  *   - model handle is stored as a jlong (uintptr_t); 0 means null.
  *   - Every GetStringUTFChars is paired with a ReleaseStringUTFChars.
  *   - Error strings and voice-list strings from Rust are freed immediately after
- *     being converted to a Java String.
+ *     being converted to a Java String (or thrown as a RuntimeException by the
+ *     PCM methods, which return arrays).
+ *   - PCM returned as a Java array is copied once from the Rust buffer, which is
+ *     then freed; direct ByteBuffers and streamed chunks are written in place.
  */
 
 #include <jni.h>
 #include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <android/asset_manager_jni.h>
 #include <android/log.h>
 #include "kittentts.h"
 
@@ -33,6 +39,49 @@ static inline KittenTtsHandle *to_handle(jlong cookie) {
     return (KittenTtsHandle *)(uintptr_t)cookie;
 }
 
+/** Throw a RuntimeException carrying `err`, then free it. */
+static void throw_error(JNIEnv *env, const char *err) {
+    jclass rte = (*env)->FindClass(env, "java/lang/RuntimeException");
+    if (rte) (*env)->ThrowNew(env, rte, err);
+    kittentts_free_error(err);
+}
+
+/** Same float → int16 conversion as the Rust encoders (f32_to_i16). */
+static inline jshort to_pcm16(float s) {
+    float v = s * 32767.0f;
+    if (v >  32767.0f) v =  32767.0f;
+    if (v < -32768.0f) v = -32768.0f;
+    return (jshort)v;
+}
+
+/**
+ * Synthesise into a library buffer of `format`.  On failure throws and
+ * returns non-zero; on success the caller must kittentts_audio_free(audio).
+ */
+static int synthesize_pcm(JNIEnv *env, jlong handle, jstring text, jstring voice,
+                          jfloat speed, int32_t format, KittenTtsAudio *audio)
+{
+    if (!handle) {
+        jclass rte = (*env)->FindClass(env, "java/lang/RuntimeException");
+        if (rte) (*env)->ThrowNew(env, rte, "null model handle");
+        return -1;
+    }
+    const char *txt = (*env)->GetStringUTFChars(env, text,  NULL);
+    const char *vox = (*env)->GetStringUTFChars(env, voice, NULL);
+
+    const char *err = kittentts_synthesize_to_buffer(
+            to_handle(handle), txt, vox, (float)speed, format, audio);
+
+    (*env)->ReleaseStringUTFChars(env, text,  txt);
+    (*env)->ReleaseStringUTFChars(env, voice, vox);
+
+    if (err) {
+        throw_error(env, err);
+        return -1;
+    }
+    return 0;
+}
+
 /* ── JNI methods ──────────────────────────────────────────────────────────── */
 
 /**
@@ -77,6 +126,68 @@ Java_com_kittenml_kittentts_KittenTtsLib_nativeModelLoad(
     return (jlong)(uintptr_t)h;
 }
 
+/**
+ * long KittenTtsLib.nativeModelLoadFromAssets(
+ *     AssetManager assets, String onnxAsset, String voicesAsset)
+ *
+ * Loads the model straight out of the APK.  Uncompressed assets (see
+ * noCompress in app/build.gradle.kts) are mmap'd through their file
+ * descriptor; compressed ones fall back to AAsset_getBuffer().  Either way
+ * nothing is copied to filesDir.
+ *
+ * Returns a non-zero opaque handle on success, 0 on failure (including a
+ * missing asset).  Free with nativeModelFree().
+ */
+JNIEXPORT jlong JNICALL
+Java_com_kittenml_kittentts_KittenTtsLib_nativeModelLoadFromAssets(
+        JNIEnv *env, jclass cls, jobject assetManager,
+        jstring onnxAsset, jstring voicesAsset)
+{
+    AAssetManager *mgr = AAssetManager_fromJava(env, assetManager);
+    const char *onnxName   = (*env)->GetStringUTFChars(env, onnxAsset,   NULL);
+    const char *voicesName = (*env)->GetStringUTFChars(env, voicesAsset, NULL);
+
+    AAsset *onnx   = mgr ? AAssetManager_open(mgr, onnxName,   AASSET_MODE_BUFFER) : NULL;
+    AAsset *voices = mgr ? AAssetManager_open(mgr, voicesName, AASSET_MODE_BUFFER) : NULL;
+
+    (*env)->ReleaseStringUTFChars(env, onnxAsset,   onnxName);
+    (*env)->ReleaseStringUTFChars(env, voicesAsset, voicesName);
+
+    KittenTtsHandle *h = NULL;
+    if (onnx && voices) {
+        off64_t onnxOff = 0, onnxLen = 0, voicesOff = 0, voicesLen = 0;
+        int onnxFd   = AAsset_openFileDescriptor64(onnx,   &onnxOff,   &onnxLen);
+        int voicesFd = AAsset_openFileDescriptor64(voices, &voicesOff, &voicesLen);
+
+        if (onnxFd >= 0 && voicesFd >= 0) {
+            LOGI("model_load_from_fd: onnx=%lld bytes voices=%lld bytes",
+                 (long long)onnxLen, (long long)voicesLen);
+            h = kittentts_model_load_from_fd(
+                    onnxFd, onnxOff, (size_t)onnxLen,
+                    voicesFd, voicesOff, (size_t)voicesLen, NULL);
+        } else {
+            /* Compressed in the APK — let the asset manager inflate it. */
+            LOGI("model_load_from_memory: assets are compressed");
+            const void *onnxBuf   = AAsset_getBuffer(onnx);
+            const void *voicesBuf = AAsset_getBuffer(voices);
+            if (onnxBuf && voicesBuf) {
+                h = kittentts_model_load_from_memory(
+                        onnxBuf,   (size_t)AAsset_getLength64(onnx),
+                        voicesBuf, (size_t)AAsset_getLength64(voices), NULL);
+            }
+        }
+        if (onnxFd   >= 0) close(onnxFd);
+        if (voicesFd >= 0) close(voicesFd);
+    }
+    if (onnx)   AAsset_close(onnx);
+    if (voices) AAsset_close(voices);
+
+    if (!h) {
+        LOGE("model_load_from_assets returned NULL");
+    }
+    return (jlong)(uintptr_t)h;
+}
+
 /**
  * void KittenTtsLib.nativeModelFree(long handle)
  */
@@ -141,3 +252,203 @@ Java_com_kittenml_kittentts_KittenTtsLib_nativeSynthesizeToFile(
     kittentts_free_error(err);
     return result;
 }
+
+/* ── PCM without a file round-trip ────────────────────────────────────────── */
+
+/**
+ * ShortArray KittenTtsLib.nativeSynthesizeToShortArray(
+ *     long handle, String text, String voice, float speed)
+ *
+ * 16-bit mono PCM at 24 kHz, ready for AudioTrack.write().
+ * Throws RuntimeException on failure.
+ */
+JNIEXPORT jshortArray JNICALL
+Java_com_kittenml_kittentts_KittenTtsLib_nativeSynthesizeToShortArray(
+        JNIEnv *env, jclass cls,
+        jlong   handle,
+        jstring text,
+        jstring voice,
+        jfloat  speed)
+{
+    KittenTtsAudio audio;
+    if (synthesize_pcm(env, handle, text, voice, speed, KITTENTTS_SAMPLE_I16, &audio)) {
+        return NULL;
+    }
+    jshortArray result = (*env)->NewShortArray(env, (jsize)audio.num_samples);
+    if (result) {
+        (*env)->SetShortArrayRegion(env, result, 0, (jsize)audio.num_samples,
+                                    (const jshort *)audio.samples);
+    }
+    kittentts_audio_free(&audio);
+    return result;
+}
+
+/**
+ * FloatArray KittenTtsLib.nativeSynthesizeToFloatArray(
+ *     long handle, String text, String voice, float speed)
+ *
+ * Float mono PCM in [-1, 1] at 24 kHz (AudioFormat.ENCODING_PCM_FLOAT).
+ * Throws RuntimeException on failure.
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_kittenml_kittentts_KittenTtsLib_nativeSynthesizeToFloatArray(
+        JNIEnv *env, jclass cls,
+        jlong   handle,
+        jstring text,
+        jstring voice,
+        jfloat  speed)
+{
+    KittenTtsAudio audio;
+    if (synthesize_pcm(env, handle, text, voice, speed, KITTENTTS_SAMPLE_F32, &audio)) {
+        return NULL;
+    }
+    jfloatArray result = (*env)->NewFloatArray(env, (jsize)audio.num_samples);
+    if (result) {
+        (*env)->SetFloatArrayRegion(env, result, 0, (jsize)audio.num_samples,
+                                    (const jfloat *)audio.samples);
+    }
+    kittentts_audio_free(&audio);
+    return result;
+}
+
+/**
+ * int KittenTtsLib.nativeSynthesizeIntoBuffer(
+ *     long handle, String text, String voice, float speed,
+ *     int format, ByteBuffer buffer)
+ *
+ * Writes PCM of `format` (KITTENTTS_SAMPLE_F32 = 0, _I16 = 1) straight into
+ * a direct ByteBuffer in native byte order and returns the sample count.  If
+ * that count exceeds the buffer's capacity nothing was written: allocate a
+ * larger buffer and call again with the same arguments on the same thread —
+ * the audio kept from the first call is copied without re-synthesising.
+ * Throws RuntimeException on failure or if `buffer` is not direct.
+ */
+JNIEXPORT jint JNICALL
+Java_com_kittenml_kittentts_KittenTtsLib_nativeSynthesizeIntoBuffer(
+        JNIEnv *env, jclass cls,
+        jlong   handle,
+        jstring text,
+        jstring voice,
+        jfloat  speed,
+        jint    format,
+        jobject buffer)
+{
+    jclass rte = (*env)->FindClass(env, "java/lang/RuntimeException");
+    if (!handle) {
+        if (rte) (*env)->ThrowNew(env, rte, "null model handle");
+        return -1;
+    }
+    void  *addr  = (*env)->GetDirectBufferAddress(env, buffer);
+    jlong  bytes = (*env)->GetDirectBufferCapacity(env, buffer);
+    if (!addr || bytes < 0) {
+        if (rte) (*env)->ThrowNew(env, rte, "buffer must be a direct ByteBuffer");
+        return -1;
+    }
+    size_t sample_size = format == KITTENTTS_SAMPLE_I16 ? sizeof(int16_t) : sizeof(float);
+
+    const char *txt = (*env)->GetStringUTFChars(env, text,  NULL);
+    const char *vox = (*env)->GetStringUTFChars(env, voice, NULL);
+
+    KittenTtsAudio audio;
+    const char *err = kittentts_synthesize_into(
+            to_handle(handle), txt, vox, (float)speed, format,
+            addr, (size_t)bytes / sample_size, &audio);
+
+    (*env)->ReleaseStringUTFChars(env, text,  txt);
+    (*env)->ReleaseStringUTFChars(env, voice, vox);
+
+    if (err) {
+        throw_error(env, err);
+        return -1;
+    }
+    return (jint)audio.num_samples;
+}
+
+/* ── Streaming ────────────────────────────────────────────────────────────── */
+
+/** State threaded through kittentts_synthesize_stream() as user_data. */
+typedef struct {
+    JNIEnv     *env;
+    jobject     listener;
+    jmethodID   on_chunk;   /* boolean onChunk(short[] pcm, int size, int chunkIndex) */
+    jshortArray pcm;        /* reused across chunks, grown on demand */
+    jsize       capacity;
+} StreamCtx;
+
+static int32_t on_stream_chunk(const float *samples, size_t num_samples,
+                               uint32_t sample_rate, size_t chunk_index, void *user_data)
+{
+    StreamCtx *ctx = (StreamCtx *)user_data;
+    JNIEnv *env = ctx->env;
+    (void)sample_rate;
+
+    if ((jsize)num_samples > ctx->capacity) {
+        if (ctx->pcm) (*env)->DeleteLocalRef(env, ctx->pcm);
+        ctx->pcm = (*env)->NewShortArray(env, (jsize)num_samples);
+        ctx->capacity = ctx->pcm ? (jsize)num_samples : 0;
+        if (!ctx->pcm) return 1;   /* OutOfMemoryError pending */
+    }
+
+    /* Convert straight into the Java array — no intermediate buffer. */
+    jshort *dst = (*env)->GetPrimitiveArrayCritical(env, ctx->pcm, NULL);
+    if (!dst) return 1;
+    for (size_t i = 0; i < num_samples; i++) dst[i] = to_pcm16(samples[i]);
+    (*env)->ReleasePrimitiveArrayCritical(env, ctx->pcm, dst, 0);
+
+    jboolean more = (*env)->CallBooleanMethod(env, ctx->listener, ctx->on_chunk,
+                                              ctx->pcm, (jint)num_samples, (jint)chunk_index);
+    /* A listener exception stops synthesis and propagates to the Kotlin caller. */
+    if ((*env)->ExceptionCheck(env)) return 1;
+    return more ? 0 : 1;
+}
+
+/**
+ * String? KittenTtsLib.nativeSynthesizeStream(
+ *     long handle, String text, String voice, float speed, PcmChunkListener listener)
+ *
+ * Synthesises sentence by sentence, calling listener.onChunk() on this
+ * thread with 16-bit PCM as soon as each chunk is ready, so the app can
+ * start an AudioTrack after the first sentence.  The array passed to
+ * onChunk is reused for the next chunk: consume (or copy) the first `size`
+ * samples before returning.  Returning false stops early.
+ *
+ * Returns null on success or early stop, or a UTF-8 error message.
+ */
+JNIEXPORT jstring JNICALL
+Java_com_kittenml_kittentts_KittenTtsLib_nativeSynthesizeStream(
+        JNIEnv *env, jclass cls,
+        jlong   handle,
+        jstring text,
+        jstring voice,
+        jfloat  speed,
+        jobject listener)
+{
+    if (!handle) {
+        return (*env)->NewStringUTF(env, "null model handle");
+    }
+    jclass lcls = (*env)->GetObjectClass(env, listener);
+    StreamCtx ctx = {
+        .env      = env,
+        .listener = listener,
+        .on_chunk = (*env)->GetMethodID(env, lcls, "onChunk", "([SII)Z"),
+        .pcm      = NULL,
+        .capacity = 0,
+    };
+    if (!ctx.on_chunk) return NULL;   /* NoSuchMethodError pending */
+
+    const char *txt = (*env)->GetStringUTFChars(env, text,  NULL);
+    const char *vox = (*env)->GetStringUTFChars(env, voice, NULL);
+
+    const char *err = kittentts_synthesize_stream(
+            to_handle(handle), txt, vox, (float)speed, on_stream_chunk, &ctx);
+
+    (*env)->ReleaseStringUTFChars(env, text,  txt);
+    (*env)->ReleaseStringUTFChars(env, voice, vox);
+    if (ctx.pcm) (*env)->DeleteLocalRef(env, ctx.pcm);
+
+    if (!err) return NULL;   /* success, early stop, or listener exception */
+
+    jstring result = (*env)->NewStringUTF(env, err);
+    kittentts_free_error(err);
+    return result;
+}
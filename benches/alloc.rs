@@ -0,0 +1,109 @@
+//! Allocation benchmark: per-stage allocation count, bytes and peak live heap.
+//!
+//! Unlike `benches/pipeline.rs` this measures memory, not time, so it is a
+//! plain `main` rather than a Criterion suite.  Each stage runs once to warm
+//! up and once under an [`AllocScope`]; the table shows the second run.
+//!
+//! Run with:
+//!   cargo bench --bench alloc --features alloc-stats
+//!   cargo bench --bench alloc --features alloc-stats,espeak   # + generate()
+//!
+//! With `espeak` and a model directory the full `generate_with_stats` call is
+//! also measured, reported stage by stage from `GenerationStats`.
+
+use kittentts::alloc::{AllocScope, AllocStats};
+use kittentts::encoding::{AudioFormat, EncoderFactory};
+use kittentts::preprocess::TextPreprocessor;
+use kittentts::tokenize::ipa_to_ids;
+
+#[path = "common/mod.rs"]
+mod common;
+
+/// Same corpus as `benches/pipeline.rs`, abbreviated.
+const CORPUS: &[&str] = &[
+    "Hello world, this is a plain sentence with no special tokens at all.",
+    "The price dropped 15% from $1,299.99 to $1.1K over the 1990s.",
+    "Meet me at 10:30 pm on pages 12-18; call 555-123-4567 or ping 192.168.0.1.",
+    "I don't think they've read <b>the docs</b> at https://example.com yet.",
+];
+
+const IPA_SENTENCE: &str = "ðə kwɪk bɹaʊn fɑːks dʒʌmps oʊvɚ ðə leɪzi dɑːɡ.";
+
+fn main() {
+    assert!(kittentts::alloc::is_enabled(), "build with --features alloc-stats");
+
+    println!("{:<28} {:>10} {:>14} {:>14}", "stage", "allocs", "bytes", "peak live");
+    println!("{}", "─".repeat(69));
+
+    let text = CORPUS.join(" ");
+    let pre = TextPreprocessor::new();
+    measure("preprocess", || drop(pre.process(&text)));
+
+    let ipa = IPA_SENTENCE.repeat(4);
+    measure("ipa_to_ids", || drop(ipa_to_ids(&ipa)));
+
+    let samples: Vec<f32> = (0..kittentts::SAMPLE_RATE as usize * 5)
+        .map(|i| (i as f32 * 0.01).sin() * 0.5)
+        .collect();
+    for format in [AudioFormat::Wav, AudioFormat::Pcm] {
+        let encoder = EncoderFactory::create(format).expect("built-in encoder");
+        measure(&format!("encode {} (5 s)", format.extension()), || {
+            drop(encoder.encode(&samples, kittentts::SAMPLE_RATE).unwrap())
+        });
+    }
+
+    generate(&text);
+}
+
+/// Run `f` once to warm caches, then once under an [`AllocScope`].
+fn measure(label: &str, mut f: impl FnMut()) {
+    f();
+    let scope = AllocScope::begin();
+    f();
+    print_row(label, scope.finish());
+}
+
+fn print_row(label: &str, s: AllocStats) {
+    println!(
+        "{:<28} {:>10} {:>14} {:>14}",
+        label, s.allocations, s.bytes_allocated, s.peak_live_bytes
+    );
+}
+
+#[cfg(feature = "espeak")]
+fn generate(text: &str) {
+    let Some(dir) = common::model_dir() else {
+        eprintln!("SKIP generate: model directory not found");
+        return;
+    };
+    let tts = kittentts::KittenTTS::load(
+        &dir.join("kitten_tts_mini_v0_8.onnx"),
+        &dir.join("voices.npz"),
+        Default::default(),
+        Default::default(),
+    )
+    .expect("failed to load bundled model");
+    let voice = tts.available_voices.first().expect("at least one voice").clone();
+
+    // Warm-up: first-run ORT allocations would dominate otherwise.
+    tts.generate_with_stats(text, &voice, 1.0, true).unwrap();
+    let (_, stats) = tts.generate_with_stats(text, &voice, 1.0, true).unwrap();
+
+    println!();
+    println!(
+        "generate(): {} chunks, {} tokens, {:.2} s audio",
+        stats.chunks,
+        stats.tokens,
+        stats.audio_seconds()
+    );
+    print_row("  preprocess", stats.preprocess.alloc);
+    print_row("  phonemize", stats.phonemize.alloc);
+    print_row("  tokenize", stats.tokenize.alloc);
+    print_row("  inference", stats.inference.alloc);
+    print_row("  total", stats.total.alloc);
+}
+
+#[cfg(not(feature = "espeak"))]
+fn generate(_text: &str) {
+    eprintln!("SKIP generate: requires the `espeak` feature");
+}
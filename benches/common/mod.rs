@@ -0,0 +1,37 @@
+//! Helpers shared by the benches, integration tests and `kittentts-perf`.
+//!
+//! Not a crate module: each target pulls this file in with
+//! `#[path = "…/benches/common/mod.rs"] mod common;`.
+
+use std::path::{Path, PathBuf};
+
+/// Return the path to a bundled model directory that contains:
+///   - `kitten_tts_mini_v0_8.onnx`
+///   - `voices.npz`
+///   - `config.json`
+///
+/// Search order:
+///   1. `$KITTENTTS_MODEL_DIR` environment variable
+///   2. `ios/KittenTTSApp/KittenTTSApp/Models/` relative to workspace root
+///   3. `android/KittenTTSApp/app/src/main/assets/models/` relative to workspace root
+#[allow(dead_code)] // unused by targets built without the features that load a model
+pub fn model_dir() -> Option<PathBuf> {
+    // 1. Explicit override
+    if let Ok(dir) = std::env::var("KITTENTTS_MODEL_DIR") {
+        let p = PathBuf::from(dir);
+        if p.join("kitten_tts_mini_v0_8.onnx").exists() {
+            return Some(p);
+        }
+    }
+
+    // 2. Workspace-relative paths
+    let manifest = Path::new(env!("CARGO_MANIFEST_DIR"));
+    let candidates = [
+        manifest.join("ios/KittenTTSApp/KittenTTSApp/Models"),
+        manifest.join("android/KittenTTSApp/app/src/main/assets/models"),
+    ];
+    candidates
+        .iter()
+        .find(|p| p.join("kitten_tts_mini_v0_8.onnx").exists())
+        .cloned()
+}
@@ -0,0 +1,66 @@
+// Overhead of include/kittentts.hpp over the raw C API.
+// Built and run by scripts/test-cpp.sh --bench (needs KITTENTTS_MODEL_DIR).
+//
+// Times the same IPA synthesis through kittentts_synthesize_ipa_to_buffer()
+// and through kittentts::Model::synthesize_ipa(), interleaved so drift in
+// CPU frequency affects both equally.
+
+#include "kittentts.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+int main(int argc, char **argv) {
+    const char *dir = std::getenv("KITTENTTS_MODEL_DIR");
+    if (!dir) {
+        std::fprintf(stderr, "SKIP: KITTENTTS_MODEL_DIR not set\n");
+        return 0;
+    }
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 50;
+    const std::string d(dir);
+    auto model = kittentts::Model::load(d + "/kitten_tts_mini_v0_8.onnx", d + "/voices.npz");
+    std::string json = model.voices_json();
+    const std::string voice = json.substr(2, json.find('"', 2) - 2);
+    const char *ipa = "ðə kwɪk bɹaʊn fɑːks dʒʌmps oʊvɚ ðə leɪzi dɑːɡ.";
+
+    // Warm-up.
+    for (int i = 0; i < 3; ++i) model.synthesize_ipa(ipa, voice);
+
+    std::vector<double> c_ms, cpp_ms;
+    for (int i = 0; i < iterations; ++i) {
+        auto t0 = Clock::now();
+        KittenTtsAudio raw;
+        const char *err = kittentts_synthesize_ipa_to_buffer(model.get(), ipa, voice.c_str(), 1.0f,
+                                                             KITTENTTS_SAMPLE_F32, &raw);
+        if (err) {
+            std::fprintf(stderr, "C API error: %s\n", err);
+            kittentts_free_error(err);
+            return 1;
+        }
+        kittentts_audio_free(&raw);
+        auto t1 = Clock::now();
+        { kittentts::Audio audio = model.synthesize_ipa(ipa, voice); }
+        auto t2 = Clock::now();
+
+        c_ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+        cpp_ms.push_back(std::chrono::duration<double, std::milli>(t2 - t1).count());
+    }
+
+    const double c = median(c_ms), cpp = median(cpp_ms);
+    std::printf("%-28s %10s\n", "path", "median ms");
+    std::printf("%-28s %10.3f\n", "C  synthesize_ipa_to_buffer", c);
+    std::printf("%-28s %10.3f\n", "C++ Model::synthesize_ipa", cpp);
+    std::printf("overhead: %+.2f%% over %d iterations\n", (cpp - c) / c * 100.0, iterations);
+    return 0;
+}
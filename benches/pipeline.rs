@@ -0,0 +1,329 @@
+//! Criterion micro-benchmarks for every stage of the synthesis pipeline.
+//!
+//! Every benchmark runs over the same fixed corpus so results are comparable
+//! between commits.  Stages that need model files (NPZ loading, ONNX inference)
+//! are skipped with a message when no model directory is found — the same
+//! lookup the integration tests use.
+//!
+//! Run with:
+//!   cargo bench                              # pure-Rust stages + encoders
+//!   cargo bench --features espeak            # + phonemisation
+//!   KITTENTTS_MODEL_DIR=… cargo bench        # + NPZ loading and inference
+//!
+//! `infer_mock` runs the same inference path on `backend::MockBackend`, so
+//! it measures the pipeline's own overhead and needs no model.
+//!   cargo bench -- preprocess                # one group only
+
+use std::hint::black_box;
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+
+use kittentts::backend::{self, MockBackend};
+use kittentts::encoding::{AudioFormat, EncoderFactory};
+use kittentts::npz::{load_npz, parse_npy};
+use kittentts::preprocess::{self, TextPreprocessor};
+use kittentts::tokenize::ipa_to_ids;
+use kittentts::SAMPLE_RATE;
+
+#[path = "common/mod.rs"]
+mod common;
+
+// ── Fixed corpus ─────────────────────────────────────────────────────────────
+
+/// Reference sentences exercising every preprocessor rule at least once.
+const CORPUS: &[&str] = &[
+    "Hello world, this is a plain sentence with no special tokens at all.",
+    "She finished 1st, he came 2nd, and I was 3rd in the 100 km race.",
+    "The price dropped 15% from $1,299.99 to $1.1K over the 1990s.",
+    "Meet me at 10:30 pm on pages 12-18; call 555-123-4567 or ping 192.168.0.1.",
+    "GPT-4 used lr 1e-4 and a 7B parameter model at 3/4 of .5 GHz.",
+    "I don't think they've read <b>the docs</b> at https://example.com yet.",
+    "Email support@example.com if the 2.4 GHz radio drops below 40 °C.",
+];
+
+/// IPA for "The quick brown fox jumps over the lazy dog." — repeated to build
+/// inputs of a chosen token length.
+const IPA_SENTENCE: &str = "ðə kwɪk bɹaʊn fɑːks dʒʌmps oʊvɚ ðə leɪzi dɑːɡ.";
+
+/// Sequence lengths (in tokens) used for tokenisation and inference.
+const SEQ_LENS: &[usize] = &[16, 64, 128, 256, 400];
+
+/// Audio durations (in seconds) used for the encoder benchmarks.
+const DURATIONS_S: &[u32] = &[1, 5, 20];
+
+fn corpus_text() -> String {
+    CORPUS.join(" ")
+}
+
+/// Build an IPA string that tokenises to roughly `tokens` token IDs.
+fn ipa_of_len(tokens: usize) -> String {
+    let mut ipa = String::new();
+    while ipa_to_ids(&ipa).len() < tokens {
+        for word in IPA_SENTENCE.split(' ') {
+            if !ipa.is_empty() {
+                ipa.push(' ');
+            }
+            ipa.push_str(word);
+            if ipa_to_ids(&ipa).len() >= tokens {
+                break;
+            }
+        }
+    }
+    ipa
+}
+
+/// A 440 Hz sine at 24 kHz, `seconds` long.
+fn sine(seconds: u32) -> Vec<f32> {
+    let n = (SAMPLE_RATE * seconds) as usize;
+    (0..n)
+        .map(|i| 0.5 * (i as f32 * 440.0 * 2.0 * std::f32::consts::PI / SAMPLE_RATE as f32).sin())
+        .collect()
+}
+
+/// Build a v1.0 NPY buffer with the shape of one voice embedding matrix.
+fn make_npy(shape: &[usize]) -> Vec<u8> {
+    let shape_str = shape.iter().map(|d| d.to_string()).collect::<Vec<_>>().join(", ");
+    let mut header =
+        format!("{{'descr': '<f4', 'fortran_order': False, 'shape': ({},), }}", shape_str);
+    let raw_len = header.len() + 1;
+    let padded_len = ((raw_len + 10 + 63) / 64) * 64 - 10;
+    header.extend(std::iter::repeat(' ').take(padded_len - raw_len));
+    header.push('\n');
+
+    let n: usize = shape.iter().product();
+    let mut buf = Vec::with_capacity(10 + header.len() + n * 4);
+    buf.extend_from_slice(b"\x93NUMPY");
+    buf.push(1);
+    buf.push(0);
+    buf.extend_from_slice(&(header.len() as u16).to_le_bytes());
+    buf.extend_from_slice(header.as_bytes());
+    for i in 0..n {
+        buf.extend_from_slice(&(i as f32 * 1e-3).to_le_bytes());
+    }
+    buf
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// § preprocess
+// ─────────────────────────────────────────────────────────────────────────────
+
+fn bench_preprocess(c: &mut Criterion) {
+    let text = corpus_text();
+    let stages: &[(&str, fn(&str) -> String)] = &[
+        ("remove_html_tags", |t| preprocess::remove_html_tags(t).into_owned()),
+        ("remove_urls", |t| preprocess::remove_urls(t).into_owned()),
+        ("remove_emails", |t| preprocess::remove_emails(t).into_owned()),
+        ("expand_contractions", preprocess::expand_contractions),
+        ("expand_ip_addresses", preprocess::expand_ip_addresses),
+        ("normalize_leading_decimals", preprocess::normalize_leading_decimals),
+        ("expand_currency", preprocess::expand_currency),
+        ("expand_percentages", preprocess::expand_percentages),
+        ("expand_scientific_notation", preprocess::expand_scientific_notation),
+        ("expand_time", preprocess::expand_time),
+        ("expand_ordinals", preprocess::expand_ordinals),
+        ("expand_units", preprocess::expand_units),
+        ("expand_scale_suffixes", preprocess::expand_scale_suffixes),
+        ("expand_fractions", preprocess::expand_fractions),
+        ("expand_decades", preprocess::expand_decades),
+        ("expand_phone_numbers", preprocess::expand_phone_numbers),
+        ("expand_ranges", preprocess::expand_ranges),
+        ("expand_model_names", preprocess::expand_model_names),
+        ("replace_numbers", preprocess::replace_numbers),
+        ("remove_punctuation", |t| preprocess::remove_punctuation(t).into_owned()),
+        ("remove_extra_whitespace", preprocess::remove_extra_whitespace),
+    ];
+
+    let mut group = c.benchmark_group("preprocess");
+    group.throughput(Throughput::Bytes(text.len() as u64));
+    for (name, stage) in stages {
+        group.bench_with_input(BenchmarkId::new("stage", name), &text, |b, t| {
+            b.iter(|| stage(black_box(t)))
+        });
+    }
+
+    let pp = TextPreprocessor::new();
+    group.bench_with_input(BenchmarkId::new("process", "corpus"), &text, |b, t| {
+        b.iter(|| pp.process(black_box(t)))
+    });
+    for (i, sentence) in CORPUS.iter().enumerate() {
+        group.bench_with_input(BenchmarkId::new("process", i), sentence, |b, t| {
+            b.iter(|| pp.process(black_box(t)))
+        });
+    }
+    group.finish();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// § phonemize (requires `espeak` feature)
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(feature = "espeak")]
+fn bench_phonemize(c: &mut Criterion) {
+    use kittentts::phonemize::{is_espeak_available, phonemize};
+
+    if !is_espeak_available() {
+        eprintln!("SKIP phonemize: espeak-ng failed to initialise");
+        return;
+    }
+    let pp = TextPreprocessor::new();
+    let cleaned: Vec<String> = CORPUS.iter().map(|s| pp.process(s)).collect();
+
+    let mut group = c.benchmark_group("phonemize");
+    for (i, text) in cleaned.iter().enumerate() {
+        group.throughput(Throughput::Bytes(text.len() as u64));
+        group.bench_with_input(BenchmarkId::new("sentence", i), text, |b, t| {
+            b.iter(|| phonemize(black_box(t)).unwrap())
+        });
+    }
+    group.finish();
+}
+
+#[cfg(not(feature = "espeak"))]
+fn bench_phonemize(_c: &mut Criterion) {
+    eprintln!("SKIP phonemize: build with --features espeak");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// § tokenize
+// ─────────────────────────────────────────────────────────────────────────────
+
+fn bench_tokenize(c: &mut Criterion) {
+    let mut group = c.benchmark_group("ipa_to_ids");
+    for &len in SEQ_LENS {
+        let ipa = ipa_of_len(len);
+        group.throughput(Throughput::Elements(len as u64));
+        group.bench_with_input(BenchmarkId::from_parameter(len), &ipa, |b, ipa| {
+            b.iter(|| ipa_to_ids(black_box(ipa)))
+        });
+    }
+    group.finish();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// § npz
+// ─────────────────────────────────────────────────────────────────────────────
+
+fn bench_npz(c: &mut Criterion) {
+    let mut group = c.benchmark_group("npz");
+
+    // One voice matrix is 400 style rows × 256 floats.
+    let npy = make_npy(&[400, 256]);
+    group.throughput(Throughput::Bytes(npy.len() as u64));
+    group.bench_function("parse_npy/400x256", |b| b.iter(|| parse_npy(black_box(&npy)).unwrap()));
+
+    match common::model_dir() {
+        Some(dir) => {
+            let voices = dir.join("voices.npz");
+            let size = std::fs::metadata(&voices).map(|m| m.len()).unwrap_or(0);
+            group.throughput(Throughput::Bytes(size));
+            group.bench_function("load_npz/voices", |b| {
+                b.iter(|| load_npz(black_box(&voices)).unwrap())
+            });
+        }
+        None => eprintln!("SKIP npz/load_npz: model directory not found"),
+    }
+    group.finish();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// § model inference
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(feature = "onnxruntime")]
+fn bench_infer(c: &mut Criterion) {
+    let Some(dir) = common::model_dir() else {
+        eprintln!("SKIP infer_ipa: model directory not found");
+        return;
+    };
+    let tts = kittentts::KittenTTS::load(
+        &dir.join("kitten_tts_mini_v0_8.onnx"),
+        &dir.join("voices.npz"),
+        Default::default(),
+        Default::default(),
+    )
+    .expect("failed to load bundled model");
+    let voice = tts.available_voices.first().expect("at least one voice").clone();
+
+    let mut group = c.benchmark_group("infer_ipa");
+    group.sample_size(10);
+    for &len in SEQ_LENS {
+        let ipa = ipa_of_len(len);
+        group.throughput(Throughput::Elements(len as u64));
+        group.bench_with_input(BenchmarkId::from_parameter(len), &ipa, |b, ipa| {
+            b.iter(|| tts.generate_from_ipa(black_box(ipa), &voice, 1.0, ipa.len()).unwrap())
+        });
+    }
+    group.finish();
+}
+
+fn bench_infer_mock(c: &mut Criterion) {
+    let tts = kittentts::KittenTTS::from_backend(
+        Box::new(MockBackend::default()),
+        backend::synthetic_voices(&["mock"]),
+        Default::default(),
+        Default::default(),
+        &Default::default(),
+    )
+    .expect("mock backend cannot fail to load");
+
+    let mut group = c.benchmark_group("infer_mock");
+    for &len in SEQ_LENS {
+        let ipa = ipa_of_len(len);
+        group.throughput(Throughput::Elements(len as u64));
+        group.bench_with_input(BenchmarkId::from_parameter(len), &ipa, |b, ipa| {
+            b.iter(|| tts.generate_from_ipa(black_box(ipa), "mock", 1.0, ipa.len()).unwrap())
+        });
+    }
+    group.finish();
+}
+
+#[cfg(not(feature = "onnxruntime"))]
+fn bench_infer(_c: &mut Criterion) {
+    eprintln!("SKIP infer_ipa: build with the default `onnxruntime` feature");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// § encoding
+// ─────────────────────────────────────────────────────────────────────────────
+
+fn bench_encoders(c: &mut Criterion) {
+    let formats = [
+        AudioFormat::Wav,
+        AudioFormat::Pcm,
+        AudioFormat::Mp3,
+        AudioFormat::Opus,
+        AudioFormat::Flac,
+    ];
+
+    let mut group = c.benchmark_group("encode");
+    group.sample_size(20);
+    for format in formats {
+        // Formats whose Cargo feature is off are skipped.
+        let Ok(encoder) = EncoderFactory::create(format) else {
+            eprintln!("SKIP encode/{}: feature not enabled", format.extension());
+            continue;
+        };
+        for &secs in DURATIONS_S {
+            let samples = sine(secs);
+            group.throughput(Throughput::Elements(samples.len() as u64));
+            group.bench_with_input(
+                BenchmarkId::new(format.extension(), format!("{secs}s")),
+                &samples,
+                |b, s| b.iter(|| encoder.encode(black_box(s), SAMPLE_RATE).unwrap()),
+            );
+        }
+    }
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    bench_preprocess,
+    bench_phonemize,
+    bench_tokenize,
+    bench_npz,
+    bench_infer,
+    bench_infer_mock,
+    bench_encoders,
+);
+criterion_main!(benches);
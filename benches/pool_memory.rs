@@ -0,0 +1,103 @@
+//! Memory benchmark: resident set size versus session pool size.
+//!
+//! Each configuration loads the model in a fresh child process (RSS never
+//! shrinks back after a load, so measuring several in one process would
+//! mix them), runs one warm-up inference per session and reports `VmRSS`.
+//! The table compares pools that pack weights per session with pools that
+//! share them through `LoadOptions::share_prepacked_weights`.
+//!
+//! Run with:
+//!   KITTENTTS_MODEL_DIR=… cargo bench --bench pool_memory
+//!
+//! Linux only (RSS is read from `/proc/self/status`).
+
+use std::{path::Path, process::Command};
+
+use kittentts::{
+    model::{KittenTtsOnnx, LoadOptions},
+    stats::current_rss_bytes,
+};
+
+#[path = "common/mod.rs"]
+mod common;
+
+/// Set in the child process to `<pool size>,<share 0|1>`.
+const CHILD_ENV: &str = "KITTENTTS_POOL_MEMORY_CHILD";
+
+const POOL_SIZES: &[usize] = &[1, 2, 4, 8];
+
+fn main() {
+    let Some(dir) = common::model_dir() else {
+        eprintln!("SKIP pool_memory: model directory not found");
+        return;
+    };
+    if let Ok(spec) = std::env::var(CHILD_ENV) {
+        child(&dir, &spec);
+        return;
+    }
+    if current_rss_bytes().is_none() {
+        eprintln!("SKIP pool_memory: RSS not available on this platform");
+        return;
+    }
+
+    println!(
+        "{:>6} {:>14} {:>14} {:>18} {:>18}",
+        "pool", "own MB", "shared MB", "own MB/session", "shared MB/session"
+    );
+    println!("{}", "─".repeat(74));
+    let (mut first_own, mut first_shared) = (0, 0);
+    for &size in POOL_SIZES {
+        let own = measure(size, false);
+        let shared = measure(size, true);
+        if size == 1 {
+            (first_own, first_shared) = (own, shared);
+        }
+        // Cost of each session beyond the first.
+        let per = |rss: u64, first: u64| {
+            if size > 1 { mb(rss.saturating_sub(first)) / (size - 1) as f64 } else { 0.0 }
+        };
+        println!(
+            "{:>6} {:>14.1} {:>14.1} {:>18.1} {:>18.1}",
+            size,
+            mb(own),
+            mb(shared),
+            per(own, first_own),
+            per(shared, first_shared)
+        );
+    }
+}
+
+/// RSS in bytes of a child process that loaded a pool of `size` sessions.
+fn measure(size: usize, share: bool) -> u64 {
+    let exe = std::env::current_exe().expect("current exe");
+    let out = Command::new(exe)
+        .env(CHILD_ENV, format!("{size},{}", share as u8))
+        .output()
+        .expect("failed to spawn child");
+    assert!(out.status.success(), "child failed: {}", String::from_utf8_lossy(&out.stderr));
+    String::from_utf8_lossy(&out.stdout).trim().parse().expect("child prints RSS bytes")
+}
+
+fn child(dir: &Path, spec: &str) {
+    let (size, share) = spec.split_once(',').expect("<size>,<share>");
+    let options = LoadOptions {
+        session_pool_size: size.parse().expect("pool size"),
+        share_prepacked_weights: share == "1",
+        // One inference per session, so activation buffers count too.
+        warm_up: true,
+        ..Default::default()
+    };
+    let _tts = KittenTtsOnnx::load_with_options(
+        &dir.join("kitten_tts_mini_v0_8.onnx"),
+        &dir.join("voices.npz"),
+        Default::default(),
+        Default::default(),
+        &options,
+    )
+    .expect("failed to load bundled model");
+    println!("{}", current_rss_bytes().expect("RSS"));
+}
+
+fn mb(bytes: u64) -> f64 {
+    bytes as f64 / (1024.0 * 1024.0)
+}
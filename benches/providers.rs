@@ -0,0 +1,69 @@
+//! Execution-provider benchmark: real-time factor per ORT provider.
+//!
+//! Loads the model once per provider compiled into this build and runs the
+//! reference corpus (`baseline::REFERENCE_CORPUS`) through each, reporting
+//! the RTF distribution and inference time per utterance.  Providers the
+//! build or the ONNX Runtime library lacks are listed as skipped.
+//!
+//! Run with:
+//!   cargo bench --bench providers --features espeak
+//!   cargo bench --bench providers --features espeak,xnnpack
+//!
+//! `KITTENTTS_THREADS` sets `LoadOptions::intra_threads` for every provider.
+
+use std::path::Path;
+
+use kittentts::{
+    baseline::{self, Baseline},
+    model::{ExecutionProvider, KittenTtsOnnx, LoadOptions},
+};
+
+#[path = "common/mod.rs"]
+mod common;
+
+const ITERATIONS: usize = 3;
+
+fn main() {
+    let Some(dir) = common::model_dir() else {
+        eprintln!("SKIP providers: model directory not found");
+        return;
+    };
+    let threads = std::env::var("KITTENTTS_THREADS").ok().and_then(|t| t.parse().ok());
+
+    println!(
+        "{:<10} {:>9} {:>9} {:>9} {:>14} {:>12}",
+        "provider", "rtf p50", "rtf p90", "rtf mean", "inference ms", "audio s/s"
+    );
+    println!("{}", "─".repeat(68));
+    for provider in ExecutionProvider::ALL {
+        if !provider.is_compiled_in() {
+            println!("{:<10} skipped: build without the `{}` feature", provider.name(), provider.name());
+            continue;
+        }
+        match run(&dir, provider, threads) {
+            Ok(b) => println!(
+                "{:<10} {:>9.4} {:>9.4} {:>9.4} {:>14.2} {:>12.1}",
+                provider.name(),
+                b.rtf.p50,
+                b.rtf.p90,
+                b.rtf.mean,
+                b.stages.inference_ms,
+                b.audio_sec_per_sec
+            ),
+            Err(e) => println!("{:<10} skipped: {e:#}", provider.name()),
+        }
+    }
+}
+
+fn run(dir: &Path, provider: ExecutionProvider, threads: Option<usize>) -> anyhow::Result<Baseline> {
+    let options = LoadOptions { execution_provider: provider, intra_threads: threads, ..Default::default() };
+    let tts = KittenTtsOnnx::load_with_options(
+        &dir.join("kitten_tts_mini_v0_8.onnx"),
+        &dir.join("voices.npz"),
+        Default::default(),
+        Default::default(),
+        &options,
+    )?;
+    let voice = tts.available_voices.first().expect("at least one voice").clone();
+    baseline::record_corpus(&tts, baseline::REFERENCE_CORPUS, &voice, ITERATIONS, 1, provider.name())
+}
@@ -13,14 +13,34 @@
  *
  * Memory rules
  * ────────────
- *  • KittenTtsHandle  — created by kittentts_model_load(), freed by kittentts_model_free().
+ *  • KittenTtsHandle  — created by any kittentts_model_load*() function, freed by
+ *    kittentts_model_free().
  *  • Voice-list JSON  — returned by kittentts_model_voices(), freed by kittentts_free_string().
- *  • Error strings    — returned by kittentts_synthesize_to_file(), freed by kittentts_free_error().
- *    NULL return from synthesize means success (no string to free).
+ *  • Error strings    — returned by every kittentts_synthesize_*() function, freed by
+ *    kittentts_free_error().  NULL return from synthesize means success (no string to free).
+ *  • KittenTtsAudio   — samples filled by kittentts_synthesize_to_buffer(),
+ *    kittentts_synthesize_ipa_to_buffer() and the *_batch() functions are
+ *    library-owned, freed by kittentts_audio_free().  Samples filled by
+ *    kittentts_synthesize_into() live in the caller's buffer.
+ *  • KittenTtsJob     — created by kittentts_submit(), freed by kittentts_job_free().
+ *    Audio taken with kittentts_job_result() is freed by kittentts_audio_free().
  */
 
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
+/* Nullability qualifiers are a clang extension; drop them elsewhere (GCC, MSVC). */
+#if !defined(__clang__)
+#  ifndef _Nonnull
+#    define _Nonnull
+#  endif
+#  ifndef _Nullable
+#    define _Nullable
+#  endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -55,6 +75,172 @@ KittenTtsHandle * _Nullable kittentts_model_load(
     const char * _Nonnull voices_path
 );
 
+/** Version of KittenTtsLoadOptions this header describes. */
+#define KITTENTTS_LOAD_OPTIONS_VERSION 4
+
+/* KittenTtsLoadOptions.execution_provider values. */
+#define KITTENTTS_EP_CPU     0
+#define KITTENTTS_EP_XNNPACK 1
+
+/**
+ * Load-time tuning for kittentts_model_load_ex().
+ *
+ * Always fill with kittentts_load_options_init() first and then override
+ * individual fields, so fields added in later versions keep their defaults.
+ * Each version appends fields; the library reads only those of `version`.
+ */
+typedef struct {
+    uint32_t version;                  /* set by kittentts_load_options_init()         */
+    uint32_t intra_op_threads;         /* ORT threads per operator; 0 = ORT default    */
+    uint32_t inter_op_threads;         /* parallel graph branches; 0 or 1 = sequential */
+    uint32_t session_pool_size;        /* concurrent syntheses; each copies weights    */
+    int32_t  graph_optimization_level; /* -1 default, 0 off, 1 basic, 2 ext., 3 all   */
+    int32_t  warm_up;                  /* non-zero: one inference per session at load  */
+    int32_t  lazy_voices;              /* non-zero: decompress voices on first use     */
+    /* Optimised-graph cache file, or NULL. */
+    const char * _Nullable optimized_model_path;
+    /* config.json supplying speed_priors / voice_aliases, or NULL. */
+    const char * _Nullable config_path;
+    /* Since version 2: non-zero runs on kittentts_init_shared_threads() pools;
+     * intra_op_threads / inter_op_threads are then ignored. */
+    int32_t  shared_threads;
+    /* Since version 3: non-zero makes pooled sessions share one copy of the
+     * weights ORT prepacks, so memory grows less per extra session. */
+    int32_t  share_prepacked_weights;
+    /* Since version 4: KITTENTTS_EP_CPU (default) or KITTENTTS_EP_XNNPACK.  With
+     * XNNPACK, intra_op_threads sizes XNNPACK's pool; nodes it cannot run
+     * fall back to the CPU provider.  Needs a library built with `xnnpack`. */
+    int32_t  execution_provider;
+} KittenTtsLoadOptions;
+
+/**
+ * Fill `opts` with defaults that reproduce kittentts_model_load().  Pass
+ * KITTENTTS_LOAD_OPTIONS_VERSION: only that layout's fields are written.
+ */
+void kittentts_load_options_init(KittenTtsLoadOptions * _Nonnull opts, uint32_t version);
+
+/**
+ * Create process-wide ORT thread pools shared by every model loaded with
+ * opts->shared_threads, instead of one set of pools per session.  Keeps the
+ * ORT thread count fixed as session pools and models are added.
+ *
+ * Call once, before loading any model.  Fails in builds without the
+ * `onnxruntime` Cargo feature.  `spin` is -1 (ORT default), 0 or 1.
+ * `intra_affinity` uses ORT's intra_op_thread_affinities syntax — one
+ * ';'-separated group of 1-based processor ids per intra-op thread except
+ * the caller, e.g. "2;3;4" for 4 threads — or is NULL.
+ *
+ * @code
+ *   const char *err = kittentts_init_shared_threads(4, 0, 0, NULL);
+ *   KittenTtsLoadOptions opts;
+ *   kittentts_load_options_init(&opts, KITTENTTS_LOAD_OPTIONS_VERSION);
+ *   opts.shared_threads = 1;
+ *   opts.session_pool_size = 4;
+ * @endcode
+ *
+ * @return  NULL on success, or an error string (free with kittentts_free_error()).
+ */
+const char * _Nullable kittentts_init_shared_threads(
+    uint32_t intra_op_threads,
+    uint32_t inter_op_threads,
+    int32_t spin,
+    const char * _Nullable intra_affinity
+);
+
+/**
+ * Load a model with tuning options.
+ *
+ * If `optimized_model_path` names a file newer than the ONNX model, it is
+ * loaded directly and graph optimisation is skipped; otherwise the
+ * optimised graph is written there for the next launch.
+ *
+ * @param onnx_path    Absolute path to `kitten_tts_mini_v0_8.onnx`.
+ * @param voices_path  Absolute path to `voices.npz`.
+ * @param opts         Options, or NULL for the defaults.
+ * @return             Opaque model handle, or NULL on failure (details to stderr).
+ *                     Release with kittentts_model_free().
+ *
+ * @code
+ *   KittenTtsLoadOptions opts;
+ *   kittentts_load_options_init(&opts, KITTENTTS_LOAD_OPTIONS_VERSION);
+ *   opts.session_pool_size = 2;
+ *   opts.warm_up = 1;
+ *   opts.lazy_voices = 1;
+ *   KittenTtsHandle *model = kittentts_model_load_ex(onnx, voices, &opts);
+ * @endcode
+ */
+KittenTtsHandle * _Nullable kittentts_model_load_ex(
+    const char * _Nonnull onnx_path,
+    const char * _Nonnull voices_path,
+    const KittenTtsLoadOptions * _Nullable opts
+);
+
+/**
+ * Load a model from serialized ONNX and voices.npz bytes in memory.
+ *
+ * Neither buffer is referenced after this returns, so an mmap'd region or
+ * AAsset_getBuffer() result may be released straight away.  Voices are
+ * parsed eagerly regardless of opts->lazy_voices.
+ *
+ * @return  Opaque model handle, or NULL on failure (details to stderr).
+ *          Release with kittentts_model_free().
+ */
+KittenTtsHandle * _Nullable kittentts_model_load_from_memory(
+    const uint8_t * _Nonnull onnx_data,
+    size_t onnx_len,
+    const uint8_t * _Nonnull voices_data,
+    size_t voices_len,
+    const KittenTtsLoadOptions * _Nullable opts
+);
+
+/**
+ * Load a .kitten single-file bundle (packed with kittentts-bundle).
+ *
+ * The bundle is mmap'd for the lifetime of the model; voice rows are read in
+ * place, so processes loading the same bundle share its pages.  Speed priors
+ * and voice aliases come from the bundle and opts->config_path is ignored.
+ *
+ * @return  Opaque model handle, or NULL on failure (details to stderr).
+ *          Release with kittentts_model_free().
+ */
+KittenTtsHandle * _Nullable kittentts_model_load_bundle(
+    const char * _Nonnull path,
+    const KittenTtsLoadOptions * _Nullable opts
+);
+
+#if !defined(_WIN32)
+/**
+ * Load a model from regions of open files — typically uncompressed APK
+ * assets opened with AAsset_openFileDescriptor64(), so the model never has
+ * to be copied out to filesDir.  Each region is mmap'd for the duration of
+ * the call; the descriptors are not closed.  An empty region, or one that
+ * extends past the end of its file, fails the load instead of faulting on
+ * first read.  POSIX only.
+ *
+ * @code
+ *   off64_t onnx_off, onnx_len, voices_off, voices_len;
+ *   int onnx_fd   = AAsset_openFileDescriptor64(onnx_asset,   &onnx_off,   &onnx_len);
+ *   int voices_fd = AAsset_openFileDescriptor64(voices_asset, &voices_off, &voices_len);
+ *   KittenTtsHandle *model = kittentts_model_load_from_fd(
+ *       onnx_fd, onnx_off, (size_t)onnx_len, voices_fd, voices_off, (size_t)voices_len, NULL);
+ *   close(onnx_fd);
+ *   close(voices_fd);
+ * @endcode
+ *
+ * @return  Opaque model handle, or NULL on failure (details to stderr).
+ *          Release with kittentts_model_free().
+ */
+KittenTtsHandle * _Nullable kittentts_model_load_from_fd(
+    int32_t onnx_fd,
+    int64_t onnx_offset,
+    size_t onnx_len,
+    int32_t voices_fd,
+    int64_t voices_offset,
+    size_t voices_len,
+    const KittenTtsLoadOptions * _Nullable opts
+);
+#endif
+
 /**
  * Return the available voice names as a compact JSON array string.
  *
@@ -90,10 +276,332 @@ const char * _Nullable kittentts_synthesize_to_file(
     const char * _Nonnull  output_path
 );
 
+/* ── In-memory synthesis ─────────────────────────────────────────────────── */
+
+/** Sample formats for KittenTtsAudio.format. */
+#define KITTENTTS_SAMPLE_F32 0   /**< float, range [-1.0, 1.0] */
+#define KITTENTTS_SAMPLE_I16 1   /**< int16_t                  */
+
+/** Mono PCM audio returned by the buffer synthesis functions. */
+typedef struct KittenTtsAudio {
+    void     * _Nullable samples;   /**< float* or int16_t*, per `format` */
+    size_t               num_samples;
+    uint32_t             sample_rate; /**< 24000 */
+    uint32_t             channels;    /**< always 1 */
+    int32_t              format;      /**< KITTENTTS_SAMPLE_F32 or _I16 */
+} KittenTtsAudio;
+
+/**
+ * Synthesise text into a library-allocated PCM buffer — no file I/O.
+ *
+ *   KittenTtsAudio audio;
+ *   const char *err = kittentts_synthesize_to_buffer(
+ *       model, "Hello!", voice, 1.0f, KITTENTTS_SAMPLE_I16, &audio);
+ *   if (!err) {
+ *       play((const int16_t *)audio.samples, audio.num_samples, audio.sample_rate);
+ *       kittentts_audio_free(&audio);
+ *   } else {
+ *       kittentts_free_error(err);
+ *   }
+ *
+ * @param format  KITTENTTS_SAMPLE_F32 or KITTENTTS_SAMPLE_I16.
+ * @param out     Filled on success; out->samples is NULL on failure.
+ * @return        NULL on success, otherwise an error for kittentts_free_error().
+ */
+const char * _Nullable kittentts_synthesize_to_buffer(
+    const KittenTtsHandle * _Nonnull model,
+    const char * _Nonnull  text,
+    const char * _Nonnull  voice,
+    float                  speed,
+    int32_t                format,
+    KittenTtsAudio * _Nonnull out
+);
+
+/**
+ * Synthesise text into a caller-owned buffer (two-call size query).
+ *
+ *   KittenTtsAudio audio;
+ *   kittentts_synthesize_into(model, text, voice, 1.0f,
+ *                             KITTENTTS_SAMPLE_F32, NULL, 0, &audio);
+ *   float *buf = malloc(audio.num_samples * sizeof(float));
+ *   kittentts_synthesize_into(model, text, voice, 1.0f,
+ *                             KITTENTTS_SAMPLE_F32, buf, audio.num_samples, &audio);
+ *
+ * The first call synthesises and reports the required size with
+ * out->samples == NULL.  The second call, with the same arguments on the
+ * same thread, copies the already-synthesised audio without running the
+ * model again and sets out->samples = buffer.  If the buffer is large enough
+ * on the first call, the audio is copied straight away.
+ *
+ * @param buffer    Caller memory, or NULL to query the size.
+ * @param capacity  Size of `buffer` in samples (not bytes).
+ * @return          NULL on success, otherwise an error for kittentts_free_error().
+ */
+const char * _Nullable kittentts_synthesize_into(
+    const KittenTtsHandle * _Nonnull model,
+    const char * _Nonnull  text,
+    const char * _Nonnull  voice,
+    float                  speed,
+    int32_t                format,
+    void * _Nullable       buffer,
+    size_t                 capacity,
+    KittenTtsAudio * _Nonnull out
+);
+
+/**
+ * Free the samples of a KittenTtsAudio filled by kittentts_synthesize_to_buffer()
+ * (or the IPA / batch variants) and reset it to empty.  Safe on an empty struct.  Never call it on audio
+ * from kittentts_synthesize_into() — that buffer belongs to the caller.
+ */
+void kittentts_audio_free(KittenTtsAudio * _Nullable audio);
+
+/* ── IPA input and batches ───────────────────────────────────────────────── */
+
+/**
+ * Synthesise a pre-computed IPA string (espeak-ng en-us symbols) into a
+ * library-allocated buffer.  Needs no phonemiser, so it also works in
+ * builds without espeak-ng.  Otherwise like kittentts_synthesize_to_buffer().
+ */
+const char * _Nullable kittentts_synthesize_ipa_to_buffer(
+    const KittenTtsHandle * _Nonnull model,
+    const char * _Nonnull  ipa,
+    const char * _Nonnull  voice,
+    float                  speed,
+    int32_t                format,
+    KittenTtsAudio * _Nonnull out
+);
+
+/**
+ * Synthesise `count` IPA strings in one call, one buffer per item.
+ *
+ * Items run in parallel across the model's session pool
+ * (KittenTtsLoadOptions.session_pool_size); with the default pool of one
+ * they run in order on the calling thread.
+ *
+ *   const char *phrases[] = { "həloʊ", "ɡʊdbaɪ" };
+ *   KittenTtsAudio audio[2];
+ *   const char *err = kittentts_synthesize_ipa_batch(
+ *       model, phrases, 2, voice, 1.0f, KITTENTTS_SAMPLE_I16, audio);
+ *   if (!err) {
+ *       for (int i = 0; i < 2; i++) { cache(i, &audio[i]); kittentts_audio_free(&audio[i]); }
+ *   }
+ *
+ * @param ipa  Array of `count` strings; may be NULL when `count` is 0.
+ * @param out  Array of `count` structs.  On success release each with
+ *             kittentts_audio_free(); on failure none hold samples.  May be
+ *             NULL when `count` is 0, which succeeds without synthesising.
+ * @return     NULL on success, otherwise an error (naming the failing item)
+ *             for kittentts_free_error().
+ */
+const char * _Nullable kittentts_synthesize_ipa_batch(
+    const KittenTtsHandle * _Nonnull model,
+    const char * _Nonnull const * _Nullable ipa,
+    size_t                 count,
+    const char * _Nonnull  voice,
+    float                  speed,
+    int32_t                format,
+    KittenTtsAudio * _Nullable out
+);
+
+/** kittentts_synthesize_ipa_batch() for text utterances. */
+const char * _Nullable kittentts_synthesize_batch(
+    const KittenTtsHandle * _Nonnull model,
+    const char * _Nonnull const * _Nullable texts,
+    size_t                 count,
+    const char * _Nonnull  voice,
+    float                  speed,
+    int32_t                format,
+    KittenTtsAudio * _Nullable out
+);
+
+/* ── Streaming synthesis ─────────────────────────────────────────────────── */
+
+/**
+ * Per-chunk callback for kittentts_synthesize_stream().
+ *
+ * @param samples      Mono float PCM in [-1.0, 1.0].  Borrowed: valid only until
+ *                     the callback returns — copy it if you need it later.
+ * @param num_samples  Number of samples in this chunk.
+ * @param sample_rate  Always 24000.
+ * @param chunk_index  Zero-based index of the chunk within the text.
+ * @param user_data    The pointer passed to kittentts_synthesize_stream().
+ * @return             0 to continue, non-zero to stop after this chunk.
+ */
+typedef int32_t (*KittenTtsChunkCallback)(
+    const float * _Nonnull samples,
+    size_t                 num_samples,
+    uint32_t               sample_rate,
+    size_t                 chunk_index,
+    void * _Nullable       user_data
+);
+
+/**
+ * Synthesise text chunk by chunk (roughly one sentence each), delivering each
+ * chunk's audio as soon as its inference finishes, so playback can start
+ * after the first sentence.
+ *
+ * Threading and reentrancy:
+ *  • The callback is invoked synchronously on the thread that called
+ *    kittentts_synthesize_stream(), in chunk order, and never after it
+ *    returns.  Do heavy work (e.g. writing to an audio device) without
+ *    blocking for long, as the next chunk waits for the callback.
+ *  • No library lock is held while the callback runs.  The callback may
+ *    call other kittentts functions, including synthesis on the same model,
+ *    but must NOT call kittentts_model_free() on it.
+ *  • Concurrent kittentts_synthesize_stream() calls on one model from
+ *    different threads are safe; each gets its own callbacks.
+ *
+ * Returning non-zero from the callback stops synthesis early; remaining
+ * chunks are skipped and the call returns NULL.
+ *
+ * @return  NULL on success or early stop, otherwise an error for
+ *          kittentts_free_error().
+ */
+const char * _Nullable kittentts_synthesize_stream(
+    const KittenTtsHandle * _Nonnull model,
+    const char * _Nonnull    text,
+    const char * _Nonnull    voice,
+    float                    speed,
+    KittenTtsChunkCallback _Nonnull callback,
+    void * _Nullable         user_data
+);
+
+/* ── Statistics ──────────────────────────────────────────────────────────── */
+
+/** Version of KittenTtsStats this header describes. */
+#define KITTENTTS_STATS_VERSION 1
+
+/**
+ * Synthesis counters.  Set `version` to KITTENTTS_STATS_VERSION before
+ * passing the struct in.  Times are wall-clock milliseconds.
+ */
+typedef struct {
+    uint32_t version;
+    uint64_t requests;             /* completed calls; a batch counts each item */
+    uint64_t chunks;
+    uint64_t tokens;
+    uint64_t samples;
+    double   audio_seconds;
+    double   preprocess_ms;
+    double   phonemize_ms;
+    double   tokenize_ms;
+    double   inference_ms;
+    double   total_ms;
+    double   real_time_factor;     /* wall time / audio time; < 1 is faster     */
+    uint64_t session_waits;        /* waits for a pooled session (model only)   */
+    uint64_t voice_cache_hits;     /* voice already in memory (model only)      */
+    uint64_t voice_cache_misses;   /* lazy voice decompressed (model only)      */
+    double   voice_cache_hit_rate; /* 1.0 before any lookup                     */
+    int32_t  optimized_model_cache_hit; /* non-zero: optimised graph reused     */
+    /* Largest Rust heap growth of one request, on its calling thread.  ORT's
+     * arena and intra-op allocations, most of inference memory, are not
+     * counted; use process RSS for that.  0 unless built with alloc-stats. */
+    uint64_t peak_rust_heap_bytes;
+} KittenTtsStats;
+
+/**
+ * Cumulative statistics of `model` since it was loaded.  Cheap enough to poll.
+ *
+ * @return NULL on success, otherwise an error string to release with
+ *         kittentts_free_error().
+ */
+const char * _Nullable kittentts_model_stats(
+    const KittenTtsHandle * _Nonnull model,
+    KittenTtsStats * _Nonnull out
+);
+
+/**
+ * Statistics of the last synthesis call made on the calling thread, on any
+ * model; a batch call reports all its items together.  Fields marked
+ * "model only" are zero.
+ *
+ * @return NULL on success, otherwise an error string to release with
+ *         kittentts_free_error() (also when the thread has not synthesised
+ *         anything yet).
+ */
+const char * _Nullable kittentts_last_stats(KittenTtsStats * _Nonnull out);
+
+/* ── Background jobs ─────────────────────────────────────────────────────── */
+
+/** Opaque handle to a background synthesis job. */
+typedef struct KittenTtsJob KittenTtsJob;
+
+/** Job states returned by kittentts_job_poll() / kittentts_job_wait(). */
+#define KITTENTTS_JOB_QUEUED    0
+#define KITTENTTS_JOB_RUNNING   1
+#define KITTENTTS_JOB_DONE      2
+#define KITTENTTS_JOB_FAILED    3
+#define KITTENTTS_JOB_CANCELLED 4
+
+/**
+ * Set the number of library worker threads that run submitted jobs
+ * (default 1).  Jobs run in FIFO order.  Call before the first kittentts_submit().
+ *
+ * @return  NULL on success, otherwise an error for kittentts_free_error().
+ */
+const char * _Nullable kittentts_set_job_workers(size_t workers);
+
+/**
+ * Queue text for synthesis and return immediately — no thread of your own
+ * is needed, and many utterances can be queued at once.
+ *
+ *   KittenTtsJob *job = kittentts_submit(model, text, voice, 1.0f, KITTENTTS_SAMPLE_I16);
+ *   if (kittentts_job_wait(job, 5000) == KITTENTTS_JOB_DONE) {
+ *       KittenTtsAudio audio;
+ *       if (!kittentts_job_result(job, &audio)) { play(&audio); kittentts_audio_free(&audio); }
+ *   }
+ *   kittentts_job_free(job);
+ *
+ * The job keeps the model alive, so kittentts_model_free() is safe while
+ * jobs are pending.  All kittentts_job_*() functions are thread-safe.
+ *
+ * @param format  Sample format of the result (KITTENTTS_SAMPLE_F32 / _I16).
+ * @return        Job handle, or NULL on invalid arguments.  Errors during
+ *                synthesis (e.g. unknown voice) surface as KITTENTTS_JOB_FAILED.
+ */
+KittenTtsJob * _Nullable kittentts_submit(
+    const KittenTtsHandle * _Nonnull model,
+    const char * _Nonnull  text,
+    const char * _Nonnull  voice,
+    float                  speed,
+    int32_t                format
+);
+
+/** Current job state (KITTENTTS_JOB_*) without blocking; -1 for NULL. */
+int32_t kittentts_job_poll(const KittenTtsJob * _Nullable job);
+
+/**
+ * Wait until the job finishes or `timeout_ms` elapses (negative = forever).
+ * @return  The state at that point: QUEUED / RUNNING on timeout.
+ */
+int32_t kittentts_job_wait(const KittenTtsJob * _Nullable job, int64_t timeout_ms);
+
+/**
+ * Request cancellation.  A queued job never runs; a running job stops at the
+ * next sentence boundary and ends as KITTENTTS_JOB_CANCELLED.  Returns at once.
+ */
+void kittentts_job_cancel(const KittenTtsJob * _Nullable job);
+
+/**
+ * Move a finished job's audio into `out` (free with kittentts_audio_free()).
+ * The audio can be taken once.
+ *
+ * @return  NULL on success.  Otherwise an error for kittentts_free_error():
+ *          the synthesis error of a FAILED job, or a note that the job is
+ *          unfinished, cancelled, or its result was already taken.
+ */
+const char * _Nullable kittentts_job_result(
+    const KittenTtsJob * _Nonnull job,
+    KittenTtsAudio * _Nonnull out
+);
+
+/** Release a job handle, cancelling it first if unfinished (does not wait). */
+void kittentts_job_free(KittenTtsJob * _Nullable job);
+
 /** Free a string returned by kittentts_model_voices(). */
 void kittentts_free_string(const char * _Nullable s);
 
-/** Free an error string returned by kittentts_synthesize_to_file(). */
+/** Free an error string returned by a kittentts_synthesize_*() function. */
 void kittentts_free_error(const char * _Nullable s);
 
 /** Destroy a model handle and release all associated memory. */
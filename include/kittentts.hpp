@@ -0,0 +1,390 @@
+/**
+ * kittentts.hpp — header-only C++17 wrapper around kittentts.h.
+ *
+ * Owns every handle and string the C API hands out, turns error strings into
+ * kittentts::Error exceptions, and adds std::future and callback-based
+ * streaming on top.  Each call is a direct forward to one C function; no
+ * extra buffers are allocated and audio is never copied unless you ask for
+ * a std::vector.
+ *
+ *   #include "kittentts.hpp"
+ *
+ *   auto model = kittentts::Model::load("kitten_tts_mini_v0_8.onnx", "voices.npz");
+ *   kittentts::Audio audio = model.synthesize("Hello!", "Jasper");
+ *   play(audio.f32(), audio.size(), audio.sample_rate());
+ *
+ *   model.stream("Long text. Many sentences.", "Jasper", 1.0f,
+ *                [](const float *pcm, size_t n, size_t chunk) { play(pcm, n); return true; });
+ *
+ * Functions that take text need the library built with the `espeak` feature;
+ * the IPA functions work in every build.
+ *
+ * Memory rules: Model, Audio and Job are move-only and release their C
+ * resources in the destructor.  Audio borrowed through f32()/i16()/span()
+ * is valid until the Audio is destroyed or moved from.
+ */
+
+#pragma once
+
+#include "kittentts.h"
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+namespace kittentts {
+
+/** Thrown for every error the C API reports. */
+class Error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+namespace detail {
+
+/** Throw `err` (an owned C error string) if non-null, freeing it first. */
+inline void check(const char *err) {
+    if (err) {
+        std::string msg(err);
+        kittentts_free_error(err);
+        throw Error(msg);
+    }
+}
+
+}  // namespace detail
+
+/** Sample format of an Audio buffer. */
+enum class SampleFormat : int32_t {
+    F32 = KITTENTTS_SAMPLE_F32,
+    I16 = KITTENTTS_SAMPLE_I16,
+};
+
+// ─── Audio ──────────────────────────────────────────────────────────────────
+
+/** Library-owned mono PCM; frees itself with kittentts_audio_free(). */
+class Audio {
+public:
+    Audio() noexcept : raw_{} {}
+    ~Audio() { kittentts_audio_free(&raw_); }
+
+    Audio(Audio &&other) noexcept : raw_(other.raw_) { other.raw_ = KittenTtsAudio{}; }
+    Audio &operator=(Audio &&other) noexcept {
+        if (this != &other) {
+            kittentts_audio_free(&raw_);
+            raw_ = other.raw_;
+            other.raw_ = KittenTtsAudio{};
+        }
+        return *this;
+    }
+    Audio(const Audio &) = delete;
+    Audio &operator=(const Audio &) = delete;
+
+    size_t size() const noexcept { return raw_.num_samples; }
+    bool empty() const noexcept { return raw_.num_samples == 0; }
+    uint32_t sample_rate() const noexcept { return raw_.sample_rate; }
+    SampleFormat format() const noexcept { return static_cast<SampleFormat>(raw_.format); }
+
+    /** Samples as float; nullptr unless format() == F32. */
+    const float *f32() const noexcept {
+        return format() == SampleFormat::F32 ? static_cast<const float *>(raw_.samples) : nullptr;
+    }
+    /** Samples as int16_t; nullptr unless format() == I16. */
+    const int16_t *i16() const noexcept {
+        return format() == SampleFormat::I16 ? static_cast<const int16_t *>(raw_.samples) : nullptr;
+    }
+
+    /** Float samples, so `for (float s : audio)` works on F32 audio. */
+    const float *begin() const noexcept { return f32(); }
+    const float *end() const noexcept { return f32() ? f32() + size() : nullptr; }
+
+#if __cplusplus >= 202002L
+    std::span<const float> span() const noexcept { return {f32(), f32() ? size() : 0}; }
+    std::span<const int16_t> span_i16() const noexcept { return {i16(), i16() ? size() : 0}; }
+#endif
+
+    /** Copy F32 samples into a vector. */
+    std::vector<float> to_vector() const { return std::vector<float>(begin(), end()); }
+
+    /** The underlying C struct, e.g. to fill with a C call. */
+    KittenTtsAudio *raw() noexcept { return &raw_; }
+
+private:
+    KittenTtsAudio raw_;
+};
+
+// ─── Job ────────────────────────────────────────────────────────────────────
+
+/** Job state, mirroring KITTENTTS_JOB_*. */
+enum class JobStatus : int32_t {
+    Queued = KITTENTTS_JOB_QUEUED,
+    Running = KITTENTTS_JOB_RUNNING,
+    Done = KITTENTTS_JOB_DONE,
+    Failed = KITTENTTS_JOB_FAILED,
+    Cancelled = KITTENTTS_JOB_CANCELLED,
+};
+
+/** A background synthesis job on the library's worker pool. */
+class Job {
+public:
+    explicit Job(KittenTtsJob *job) noexcept : job_(job) {}
+    ~Job() { kittentts_job_free(job_); }
+
+    Job(Job &&other) noexcept : job_(std::exchange(other.job_, nullptr)) {}
+    Job &operator=(Job &&other) noexcept {
+        if (this != &other) {
+            kittentts_job_free(job_);
+            job_ = std::exchange(other.job_, nullptr);
+        }
+        return *this;
+    }
+    Job(const Job &) = delete;
+    Job &operator=(const Job &) = delete;
+
+    JobStatus poll() const noexcept { return static_cast<JobStatus>(kittentts_job_poll(job_)); }
+
+    /** Wait until the job finishes (`timeout` < 0 waits forever). */
+    JobStatus wait(std::chrono::milliseconds timeout = std::chrono::milliseconds(-1)) const noexcept {
+        return static_cast<JobStatus>(kittentts_job_wait(job_, timeout.count()));
+    }
+
+    void cancel() const noexcept { kittentts_job_cancel(job_); }
+
+    /** Wait for the job and take its audio; throws Error if it failed or was cancelled. */
+    Audio get() {
+        wait();
+        Audio audio;
+        detail::check(kittentts_job_result(job_, audio.raw()));
+        return audio;
+    }
+
+private:
+    KittenTtsJob *job_;
+};
+
+// ─── Load options ───────────────────────────────────────────────────────────
+
+/** KittenTtsLoadOptions, initialised to the library defaults. */
+struct LoadOptions : KittenTtsLoadOptions {
+    LoadOptions() noexcept : KittenTtsLoadOptions{} {
+        kittentts_load_options_init(this, KITTENTTS_LOAD_OPTIONS_VERSION);
+    }
+};
+
+/**
+ * Create the process-wide ORT thread pools used by models loaded with
+ * `shared_threads = 1`.  Call once, before loading any model.
+ */
+inline void init_shared_threads(uint32_t intra_op_threads, uint32_t inter_op_threads = 0,
+                                int32_t spin = -1, const char *intra_affinity = nullptr) {
+    detail::check(kittentts_init_shared_threads(intra_op_threads, inter_op_threads, spin,
+                                                intra_affinity));
+}
+
+// ─── Model ──────────────────────────────────────────────────────────────────
+
+/** A loaded model.  Move-only; thread-safe for concurrent synthesis. */
+class Model {
+public:
+    static Model load(const std::string &onnx_path, const std::string &voices_path) {
+        return Model(kittentts_model_load(onnx_path.c_str(), voices_path.c_str()));
+    }
+    static Model load(const std::string &onnx_path, const std::string &voices_path,
+                      const LoadOptions &options) {
+        return Model(kittentts_model_load_ex(onnx_path.c_str(), voices_path.c_str(), &options));
+    }
+    /** Load from serialized model and voices.npz bytes; neither is kept. */
+    static Model load_from_memory(const void *onnx, size_t onnx_len, const void *voices,
+                                  size_t voices_len, const LoadOptions *options = nullptr) {
+        return Model(kittentts_model_load_from_memory(static_cast<const uint8_t *>(onnx), onnx_len,
+                                                      static_cast<const uint8_t *>(voices),
+                                                      voices_len, options));
+    }
+
+    ~Model() { kittentts_model_free(handle_); }
+    Model(Model &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Model &operator=(Model &&other) noexcept {
+        if (this != &other) {
+            kittentts_model_free(handle_);
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    Model(const Model &) = delete;
+    Model &operator=(const Model &) = delete;
+
+    /** Voice names as a JSON array string, e.g. `["Bella","Jasper"]`. */
+    std::string voices_json() const {
+        const char *json = kittentts_model_voices(handle_);
+        if (!json) throw Error("kittentts_model_voices failed");
+        std::string out(json);
+        kittentts_free_string(json);
+        return out;
+    }
+
+    /** Cumulative counters since load (kittentts_model_stats). */
+    KittenTtsStats stats() const {
+        KittenTtsStats out{};
+        out.version = KITTENTTS_STATS_VERSION;
+        detail::check(kittentts_model_stats(handle_, &out));
+        return out;
+    }
+
+    // ── Synthesis into library buffers (no copy) ───────────────────────────
+
+    Audio synthesize(const std::string &text, const std::string &voice, float speed = 1.0f,
+                     SampleFormat format = SampleFormat::F32) const {
+        Audio audio;
+        detail::check(kittentts_synthesize_to_buffer(handle_, text.c_str(), voice.c_str(), speed,
+                                                      static_cast<int32_t>(format), audio.raw()));
+        return audio;
+    }
+
+    Audio synthesize_ipa(const std::string &ipa, const std::string &voice, float speed = 1.0f,
+                         SampleFormat format = SampleFormat::F32) const {
+        Audio audio;
+        detail::check(kittentts_synthesize_ipa_to_buffer(handle_, ipa.c_str(), voice.c_str(),
+                                                          speed, static_cast<int32_t>(format),
+                                                          audio.raw()));
+        return audio;
+    }
+
+    /** One Audio per IPA string, run in parallel across the session pool. */
+    std::vector<Audio> synthesize_ipa_batch(const std::vector<std::string> &ipa,
+                                            const std::string &voice, float speed = 1.0f,
+                                            SampleFormat format = SampleFormat::F32) const {
+        return batch(ipa, voice, speed, format, &kittentts_synthesize_ipa_batch);
+    }
+
+    /** One Audio per text, run in parallel across the session pool. */
+    std::vector<Audio> synthesize_batch(const std::vector<std::string> &texts,
+                                        const std::string &voice, float speed = 1.0f,
+                                        SampleFormat format = SampleFormat::F32) const {
+        return batch(texts, voice, speed, format, &kittentts_synthesize_batch);
+    }
+
+    // ── Synthesis into caller memory ───────────────────────────────────────
+
+    /**
+     * Synthesise into `capacity` floats at `buffer` and return the sample
+     * count.  If that exceeds `capacity` nothing is written; call again on
+     * the same thread with a large enough buffer to copy the pending audio
+     * without running the model again.
+     */
+    size_t synthesize_into(const std::string &text, const std::string &voice, float speed,
+                           float *buffer, size_t capacity) const {
+        KittenTtsAudio info{};
+        detail::check(kittentts_synthesize_into(handle_, text.c_str(), voice.c_str(), speed,
+                                                KITTENTTS_SAMPLE_F32, buffer, capacity, &info));
+        return info.num_samples;
+    }
+
+    /**
+     * Synthesise into `out`, reusing its storage across calls.  The audio
+     * is written into the vector's current elements; it is only grown (and
+     * zero-filled) by the amount a longer result needs.
+     */
+    void synthesize_into(const std::string &text, const std::string &voice, float speed,
+                         std::vector<float> &out) const {
+        size_t n = synthesize_into(text, voice, speed, out.data(), out.size());
+        if (n > out.size()) {  // too small: the second call copies the pending result
+            out.resize(n);
+            synthesize_into(text, voice, speed, out.data(), out.size());
+        }
+        out.resize(n);
+    }
+
+    // ── Streaming ──────────────────────────────────────────────────────────
+
+    /**
+     * Deliver audio chunk by chunk as each sentence finishes.
+     *
+     * `on_chunk(const float *samples, size_t n, size_t chunk_index)` runs on
+     * the calling thread; return false to stop early.  The samples are only
+     * valid during the call.  Exceptions thrown by `on_chunk` stop synthesis
+     * and are rethrown from stream().
+     */
+    template <class F>
+    void stream(const std::string &text, const std::string &voice, float speed, F &&on_chunk) const {
+        struct Ctx {
+            F &fn;
+            std::exception_ptr error;
+        } ctx{on_chunk, nullptr};
+        auto trampoline = [](const float *samples, size_t n, uint32_t, size_t index,
+                             void *user) -> int32_t {
+            auto *c = static_cast<Ctx *>(user);
+            try {
+                return c->fn(samples, n, index) ? 0 : 1;
+            } catch (...) {
+                c->error = std::current_exception();
+                return 1;
+            }
+        };
+        const char *err = kittentts_synthesize_stream(handle_, text.c_str(), voice.c_str(), speed,
+                                                      trampoline, &ctx);
+        if (ctx.error) {
+            kittentts_free_error(err);
+            std::rethrow_exception(ctx.error);
+        }
+        detail::check(err);
+    }
+
+    // ── Asynchronous ───────────────────────────────────────────────────────
+
+    /** Queue text on the library's worker pool (see kittentts_set_job_workers()). */
+    Job submit(const std::string &text, const std::string &voice, float speed = 1.0f,
+               SampleFormat format = SampleFormat::F32) const {
+        KittenTtsJob *job = kittentts_submit(handle_, text.c_str(), voice.c_str(), speed,
+                                             static_cast<int32_t>(format));
+        if (!job) throw Error("kittentts_submit: invalid arguments");
+        return Job(job);
+    }
+
+    /**
+     * Queue text and return a future for its audio.  Synthesis starts
+     * immediately on the library's worker pool; the future's get() waits for
+     * it.  The job keeps the model alive, so the Model may be destroyed first.
+     */
+    std::future<Audio> synthesize_async(const std::string &text, const std::string &voice,
+                                        float speed = 1.0f,
+                                        SampleFormat format = SampleFormat::F32) const {
+        return std::async(std::launch::deferred,
+                          [job = submit(text, voice, speed, format)]() mutable { return job.get(); });
+    }
+
+    /** The raw handle, for C functions this wrapper does not cover. */
+    const KittenTtsHandle *get() const noexcept { return handle_; }
+
+private:
+    explicit Model(KittenTtsHandle *handle) : handle_(handle) {
+        if (!handle_) throw Error("failed to load KittenTTS model (details on stderr)");
+    }
+
+    using BatchFn = const char *(*)(const KittenTtsHandle *, const char *const *, size_t,
+                                    const char *, float, int32_t, KittenTtsAudio *);
+
+    std::vector<Audio> batch(const std::vector<std::string> &items, const std::string &voice,
+                             float speed, SampleFormat format, BatchFn fn) const {
+        std::vector<const char *> ptrs;
+        ptrs.reserve(items.size());
+        for (const auto &s : items) ptrs.push_back(s.c_str());
+        std::vector<KittenTtsAudio> raw(items.size());
+        detail::check(fn(handle_, ptrs.data(), ptrs.size(), voice.c_str(), speed,
+                         static_cast<int32_t>(format), raw.data()));
+        std::vector<Audio> out(items.size());
+        for (size_t i = 0; i < raw.size(); ++i) *out[i].raw() = raw[i];
+        return out;
+    }
+
+    KittenTtsHandle *handle_;
+};
+
+}  // namespace kittentts
@@ -37,8 +37,19 @@ final class TTSEngine: ObservableObject {
     private var audioEngine  = AVAudioEngine()
     private var playerNode   = AVAudioPlayerNode()
     private var progressTimer: Timer?
-    private var audioFile: AVAudioFile?
-    private var audioFileURL: URL?
+    private var activeSink: PCMStreamSink?             // the utterance being played
+    private var lastBuffers: [AVAudioPCMBuffer] = []   // kept for replay
+    private var scheduledFrames: AVAudioFramePosition = 0
+    private var feeding = false                         // more chunks may still arrive
+    private var scheduledBuffers = 0                    // known once feeding ends
+    private var playedBuffers = 0
+    private var playback = 0                            // ignores stale completions
+
+    /// The library's native output: mono float32 at 24 kHz, so chunks are
+    /// copied into buffers as-is with no sample conversion.
+    private static let pcmFormat = AVAudioFormat(
+        commonFormat: .pcmFormatFloat32, sampleRate: 24_000, channels: 1, interleaved: false
+    )!
 
     // ── Model file locations ───────────────────────────────────────────────
     private static let appSupport: URL = {
@@ -225,77 +236,142 @@ final class TTSEngine: ObservableObject {
     // ─────────────────────────────────────────────────────────────────────
     // MARK: - Synthesis
 
+    /// Stream the utterance onto the player node chunk by chunk (roughly one
+    /// sentence each), so playback starts as soon as the first inference
+    /// finishes — no WAV file is written or read.
     func synthesize(text: String, voice: String, speed: Float) async {
         guard case .ready = engineState, let handle = modelHandle else { return }
         stop()
         playState = .synthesizing
         synthError = nil
 
-        let outURL = FileManager.default.temporaryDirectory
-            .appendingPathComponent("kittentts_\(UUID().uuidString).wav")
+        do {
+            try startEngine()
+        } catch {
+            synthError = error.localizedDescription
+            playState = .idle
+            return
+        }
+
+        let generation = playback
+        let sink = PCMStreamSink(
+            player: playerNode, format: Self.pcmFormat,
+            onScheduled: { [weak self] sink, frames in
+                Task { @MainActor [weak self] in self?.chunkScheduled(by: sink, totalFrames: frames) }
+            },
+            onPlayed: { [weak self] in
+                Task { @MainActor [weak self] in self?.bufferPlayed(generation: generation) }
+            }
+        )
+        activeSink = sink
+        feeding = true
 
         let errPtr = await Task.detached(priority: .userInitiated) {
-            kittentts_synthesize_to_file(handle, text, voice, speed, outURL.path)
+            sink.run(model: handle, text: text, voice: voice, speed: speed)
         }.value
 
+        // stop() or a new synthesize() took over while this one ran.
+        guard activeSink === sink else {
+            if let errPtr { kittentts_free_error(errPtr) }
+            return
+        }
+        feeding = false
+        lastBuffers = sink.buffers
+        scheduledBuffers = lastBuffers.count
+        // The per-chunk main-actor updates may still be queued behind us.
+        chunkScheduled(by: sink, totalFrames: sink.totalFrames)
+
         if let errPtr {
             synthError = String(cString: errPtr)
             kittentts_free_error(errPtr)
-            playState = .idle
+            stop()
             return
         }
+        // Every buffer may already have played, e.g. after an underrun.
+        finishIfDone()
+    }
 
-        audioFileURL = outURL
-        do {
-            try play(url: outURL)
-        } catch {
-            synthError = error.localizedDescription
-            playState = .idle
+    /// Called on the main actor after each chunk is scheduled.
+    private func chunkScheduled(by sink: PCMStreamSink, totalFrames: AVAudioFramePosition) {
+        guard sink === activeSink, totalFrames > scheduledFrames else { return }
+        let first = scheduledFrames == 0
+        scheduledFrames = totalFrames
+        playState = .playing(duration: Double(totalFrames) / Self.pcmFormat.sampleRate)
+        if first { startProgressTimer() }
+    }
+
+    /// Called on the main actor as each buffer finishes playing.
+    private func bufferPlayed(generation: Int) {
+        guard generation == playback else { return }
+        playedBuffers += 1
+        finishIfDone()
+    }
+
+    /// Playback is over once synthesis is done and every buffer has played.
+    private func finishIfDone() {
+        if !feeding && scheduledBuffers > 0 && playedBuffers >= scheduledBuffers {
+            stop()
         }
     }
 
     // ─────────────────────────────────────────────────────────────────────
     // MARK: - Audio playback
 
-    private func play(url: URL) throws {
+    /// Start the engine with the player node stopped; the node starts with
+    /// the first scheduled buffer, so its clock only counts audio.
+    private func startEngine() throws {
+        // Completions fired by stopping the node belong to the old playback.
+        playback += 1
+        playerNode.stop()
         audioEngine.stop()
-
-        let file = try AVAudioFile(forReading: url)
-        audioFile = file
-
-        let format = file.processingFormat
-        let duration = Double(file.length) / format.sampleRate
-
-        audioEngine.connect(playerNode, to: audioEngine.mainMixerNode, format: format)
+        audioEngine.connect(playerNode, to: audioEngine.mainMixerNode, format: Self.pcmFormat)
 
         try AVAudioSession.sharedInstance().setCategory(.playback, mode: .default)
         try AVAudioSession.sharedInstance().setActive(true)
         try audioEngine.start()
 
-        playerNode.scheduleFile(file, at: nil) { [weak self] in
-            Task { @MainActor [weak self] in
-                self?.playState = .idle
-                self?.playProgress = 0
-                self?.progressTimer?.invalidate()
+        scheduledFrames = 0
+        scheduledBuffers = 0
+        playedBuffers = 0
+    }
+
+    /// Replay the last utterance from its in-memory buffers.
+    private func play(buffers: [AVAudioPCMBuffer]) throws {
+        try startEngine()
+        let generation = playback
+        for buffer in buffers {
+            playerNode.scheduleBuffer(buffer, completionCallbackType: .dataPlayed) { [weak self] _ in
+                Task { @MainActor [weak self] in self?.bufferPlayed(generation: generation) }
             }
+            scheduledFrames += AVAudioFramePosition(buffer.frameLength)
         }
+        scheduledBuffers = buffers.count
         playerNode.play()
+        playState = .playing(duration: Double(scheduledFrames) / Self.pcmFormat.sampleRate)
+        startProgressTimer()
+    }
 
-        playState = .playing(duration: duration)
-
-        // Progress timer — fires 30 fps
+    /// Progress from the player's render position — fires 30 fps.  The end
+    /// of playback comes from the buffers' completion callbacks instead.
+    private func startProgressTimer() {
         progressTimer?.invalidate()
-        let startTime = Date()
         progressTimer = Timer.scheduledTimer(withTimeInterval: 1.0/30.0, repeats: true) { [weak self] _ in
-            guard let self else { return }
-            let elapsed = Date().timeIntervalSince(startTime)
-            Task { @MainActor in
-                self.playProgress = min(elapsed / duration, 1.0)
+            Task { @MainActor [weak self] in
+                guard let self,
+                      let nodeTime = self.playerNode.lastRenderTime,
+                      let playerTime = self.playerNode.playerTime(forNodeTime: nodeTime),
+                      self.scheduledFrames > 0 else { return }
+                let played = playerTime.sampleTime
+                self.playProgress = min(Double(played) / Double(self.scheduledFrames), 1.0)
             }
         }
     }
 
     func stop() {
+        activeSink?.cancel()
+        activeSink = nil
+        feeding = false
+        playback += 1
         playerNode.stop()
         audioEngine.stop()
         progressTimer?.invalidate()
@@ -306,12 +382,20 @@ final class TTSEngine: ObservableObject {
     func togglePlay() {
         switch playState {
         case .playing:
+            // Cancels synthesis still in progress; the part already heard
+            // stays available for replay.
+            if let sink = activeSink {
+                sink.cancel()
+                lastBuffers = sink.buffers
+                activeSink = nil
+                feeding = false
+            }
             playerNode.pause()
             progressTimer?.invalidate()
             playState = .idle
         case .idle:
-            if let url = audioFileURL {
-                try? play(url: url)
+            if !lastBuffers.isEmpty {
+                try? play(buffers: lastBuffers)
             }
         default: break
         }
@@ -330,6 +414,78 @@ final class TTSEngine: ObservableObject {
     }
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+// MARK: - PCMStreamSink
+
+/// Bridges `kittentts_synthesize_stream` to an `AVAudioPlayerNode`.
+///
+/// The C callback runs on the synthesis thread; each chunk is copied once
+/// (the library's samples are only borrowed for the callback) straight into
+/// an `AVAudioPCMBuffer` of the same float32 format and scheduled at once.
+/// The first chunk starts the player node.
+private final class PCMStreamSink: @unchecked Sendable {
+    private let player: AVAudioPlayerNode
+    private let format: AVAudioFormat
+    private let onScheduled: (PCMStreamSink, AVAudioFramePosition) -> Void
+    private let onPlayed: () -> Void
+    private let lock = NSLock()
+    private var cancelled = false
+    private var _buffers: [AVAudioPCMBuffer] = []
+    private var frames: AVAudioFramePosition = 0
+
+    init(player: AVAudioPlayerNode, format: AVAudioFormat,
+         onScheduled: @escaping (PCMStreamSink, AVAudioFramePosition) -> Void,
+         onPlayed: @escaping () -> Void) {
+        self.player = player
+        self.format = format
+        self.onScheduled = onScheduled
+        self.onPlayed = onPlayed
+    }
+
+    /// Buffers scheduled so far, in order.
+    var buffers: [AVAudioPCMBuffer] {
+        lock.lock(); defer { lock.unlock() }
+        return _buffers
+    }
+
+    /// Frames scheduled so far.
+    var totalFrames: AVAudioFramePosition {
+        lock.lock(); defer { lock.unlock() }
+        return frames
+    }
+
+    /// Stop after the chunk in flight; no further buffers are scheduled.
+    func cancel() {
+        lock.lock(); cancelled = true; lock.unlock()
+    }
+
+    /// Blocks until synthesis finishes or is cancelled.
+    /// Returns an error for `kittentts_free_error()`, or nil.
+    func run(model: OpaquePointer, text: String, voice: String, speed: Float) -> UnsafePointer<CChar>? {
+        let ctx = Unmanaged.passUnretained(self).toOpaque()
+        return kittentts_synthesize_stream(model, text, voice, speed, { samples, count, _, _, userData in
+            let sink = Unmanaged<PCMStreamSink>.fromOpaque(userData!).takeUnretainedValue()
+            return sink.receive(samples, count: count) ? 0 : 1
+        }, ctx)
+    }
+
+    private func receive(_ samples: UnsafePointer<Float>, count: Int) -> Bool {
+        lock.lock(); defer { lock.unlock() }
+        guard !cancelled,
+              let buffer = AVAudioPCMBuffer(pcmFormat: format, frameCapacity: AVAudioFrameCount(count))
+        else { return false }
+        buffer.floatChannelData![0].update(from: samples, count: count)
+        buffer.frameLength = AVAudioFrameCount(count)
+        let onPlayed = self.onPlayed
+        player.scheduleBuffer(buffer, completionCallbackType: .dataPlayed) { _ in onPlayed() }
+        if _buffers.isEmpty { player.play() }
+        _buffers.append(buffer)
+        frames += AVAudioFramePosition(count)
+        onScheduled(self, frames)
+        return true
+    }
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 private enum AssocKey {
     static var obs = "progressObserver"
@@ -0,0 +1,65 @@
+#!/usr/bin/env bash
+# =============================================================================
+# scripts/test-cpp.sh
+# Build the kittentts staticlib, then compile and run the C++ wrapper test
+# (tests/cpp) and, with --bench, its overhead benchmark (benches/cpp).
+#
+# ── QUICK START ───────────────────────────────────────────────────────────────
+#
+#  bash scripts/test-cpp.sh                 # wrapper test, C++17
+#  bash scripts/test-cpp.sh --std c++20     # also exercises the std::span API
+#  KITTENTTS_MODEL_DIR=/path/to/models bash scripts/test-cpp.sh --bench
+#
+# Model-backed checks and the benchmark need KITTENTTS_MODEL_DIR (a directory
+# with kitten_tts_mini_v0_8.onnx and voices.npz); without it they are skipped.
+#
+# ── PREREQUISITES ─────────────────────────────────────────────────────────────
+#
+#  cargo, and a C++17 compiler ($CXX, default c++).
+# =============================================================================
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+CXX="${CXX:-c++}"
+STD="c++17"
+BENCH=0
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --std)   STD="$2"; shift 2 ;;
+        --bench) BENCH=1; shift ;;
+        -h|--help) sed -n '2,19p' "$0"; exit 0 ;;
+        *) echo "unknown option: $1" >&2; exit 2 ;;
+    esac
+done
+
+cd "${ROOT_DIR}"
+OUT_DIR="${ROOT_DIR}/target/cpp"
+mkdir -p "${OUT_DIR}"
+
+# ── 1. Rust staticlib ────────────────────────────────────────────────────────
+# --print native-static-libs reports the system libraries the staticlib needs
+# (ORT's C++ runtime, pthread, dl, …) for the final link.
+echo "==> Building libkittentts.a (release, espeak)"
+NATIVE_LIBS="$(cargo rustc --release --lib --features espeak -- --print native-static-libs 2>&1 \
+    | sed -n 's/.*native-static-libs: //p' | tail -n1)"
+LIB="${ROOT_DIR}/target/release/libkittentts.a"
+[ -f "${LIB}" ] || { echo "missing ${LIB}" >&2; exit 1; }
+
+build() {  # build <source> <output>
+    # shellcheck disable=SC2086  # NATIVE_LIBS is a list of flags
+    "${CXX}" -std="${STD}" -O2 -Wall -Wextra -I "${ROOT_DIR}/include" \
+        "$1" "${LIB}" ${NATIVE_LIBS} -o "$2"
+}
+
+# ── 2. Wrapper test ──────────────────────────────────────────────────────────
+echo "==> Compiling tests/cpp/kittentts_test.cpp (${STD})"
+build tests/cpp/kittentts_test.cpp "${OUT_DIR}/kittentts_test"
+"${OUT_DIR}/kittentts_test"
+
+# ── 3. Overhead benchmark ────────────────────────────────────────────────────
+if [ "${BENCH}" -eq 1 ]; then
+    echo "==> Compiling benches/cpp/kittentts_bench.cpp (${STD})"
+    build benches/cpp/kittentts_bench.cpp "${OUT_DIR}/kittentts_bench"
+    "${OUT_DIR}/kittentts_bench"
+fi
@@ -0,0 +1,413 @@
+//! CPU sets, NUMA topology and one model replica per node.
+//!
+//! On multi-socket hosts an unpinned inference thread drifts between
+//! sockets and reads the weights across the interconnect.  [`Replicas`]
+//! loads one [`KittenTtsOnnx`] per CPU set — by default one per NUMA node
+//! ([`numa_nodes`]) — and keeps each replica's work on its own CPUs:
+//!
+//! * the replica is loaded on a thread pinned to its CPUs, so the weights
+//!   are first touched (and so placed) on the local node, and the ORT
+//!   thread pools its sessions create inherit the CPU mask;
+//! * its requests run on [`JobPool`] workers pinned to the same CPUs;
+//! * [`Replicas::submit`] routes a request to the replica whose CPUs
+//!   include the one the caller is running on.
+//!
+//! Any Linux box can exercise this by splitting its CPUs into sets with
+//! [`CpuSet::split`].  Pinning is Linux/Android only; elsewhere
+//! [`pin_current_thread`] fails and [`numa_nodes`] reports a single node.
+//!
+//! ```no_run
+//! use kittentts::{affinity::Replicas, model::{KittenTtsOnnx, LoadOptions}};
+//! # use std::path::Path;
+//!
+//! let replicas = Replicas::per_numa_node(
+//!     |options| {
+//!         KittenTtsOnnx::load_with_options(
+//!             Path::new("model.onnx"),
+//!             Path::new("voices.npz"),
+//!             Default::default(),
+//!             Default::default(),
+//!             options,
+//!         )
+//!     },
+//!     &LoadOptions { session_pool_size: 2, ..Default::default() },
+//! )?;
+//! let job = replicas.submit(|tts, _cancel| tts.generate_from_ipa("həloʊ", "Jasper", 1.0, 5));
+//! # anyhow::Ok(())
+//! ```
+
+use std::{
+    fmt,
+    sync::{
+        atomic::{AtomicUsize, Ordering},
+        Arc,
+    },
+};
+
+use anyhow::{ensure, Context, Result};
+
+use crate::{
+    jobs::{CancelToken, Job, JobPool},
+    model::{KittenTtsOnnx, LoadOptions},
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+// CPU sets
+// ─────────────────────────────────────────────────────────────────────────────
+
+/// A set of logical CPU ids, kept sorted.
+///
+/// Parses from and formats to the kernel's list syntax, e.g. `"0-3,8,10-11"`
+/// (as in `/sys/devices/system/node/node0/cpulist` or `taskset -c`).
+#[derive(Debug, Clone, Default, PartialEq, Eq, Hash)]
+pub struct CpuSet(Vec<usize>);
+
+impl CpuSet {
+    pub fn new(cpus: impl IntoIterator<Item = usize>) -> Self {
+        let mut cpus: Vec<usize> = cpus.into_iter().collect();
+        cpus.sort_unstable();
+        cpus.dedup();
+        Self(cpus)
+    }
+
+    pub fn cpus(&self) -> &[usize] {
+        &self.0
+    }
+
+    pub fn len(&self) -> usize {
+        self.0.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.0.is_empty()
+    }
+
+    pub fn contains(&self, cpu: usize) -> bool {
+        self.0.binary_search(&cpu).is_ok()
+    }
+
+    pub fn intersection(&self, other: &CpuSet) -> CpuSet {
+        Self(self.0.iter().copied().filter(|&cpu| other.contains(cpu)).collect())
+    }
+
+    /// Up to `parts` non-empty sets of consecutive CPUs, sized as evenly as
+    /// possible.
+    pub fn split(&self, parts: usize) -> Vec<CpuSet> {
+        let parts = parts.clamp(1, self.len().max(1));
+        let (base, extra) = (self.len() / parts, self.len() % parts);
+        let mut rest = self.0.as_slice();
+        (0..parts)
+            .map(|i| {
+                let (head, tail) = rest.split_at(base + usize::from(i < extra));
+                rest = tail;
+                Self(head.to_vec())
+            })
+            .filter(|set| !set.is_empty())
+            .collect()
+    }
+}
+
+impl std::str::FromStr for CpuSet {
+    type Err = anyhow::Error;
+
+    fn from_str(s: &str) -> Result<Self> {
+        let mut cpus = Vec::new();
+        for part in s.split(',').map(str::trim).filter(|p| !p.is_empty()) {
+            let id = |n: &str| n.trim().parse::<usize>().with_context(|| format!("invalid CPU id '{n}' in '{s}'"));
+            match part.split_once('-') {
+                Some((first, last)) => {
+                    let (first, last) = (id(first)?, id(last)?);
+                    ensure!(first <= last, "invalid CPU range '{part}' in '{s}'");
+                    cpus.extend(first..=last);
+                }
+                None => cpus.push(id(part)?),
+            }
+        }
+        Ok(Self::new(cpus))
+    }
+}
+
+impl fmt::Display for CpuSet {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        let mut i = 0;
+        while i < self.0.len() {
+            let first = self.0[i];
+            while i + 1 < self.0.len() && self.0[i + 1] == self.0[i] + 1 {
+                i += 1;
+            }
+            let sep = if first == self.0[0] { "" } else { "," };
+            match self.0[i] {
+                last if last == first => write!(f, "{sep}{first}")?,
+                last => write!(f, "{sep}{first}-{last}")?,
+            }
+            i += 1;
+        }
+        Ok(())
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Thread placement
+// ─────────────────────────────────────────────────────────────────────────────
+
+/// Restrict the calling thread to `cpus`.  Threads it spawns afterwards
+/// inherit the restriction.
+#[cfg(any(target_os = "linux", target_os = "android"))]
+pub fn pin_current_thread(cpus: &CpuSet) -> Result<()> {
+    ensure!(!cpus.is_empty(), "cannot pin a thread to an empty CPU set");
+    // SAFETY: cpu_set_t is a plain bitmask; all-zero is the empty set.
+    let mut set: libc::cpu_set_t = unsafe { std::mem::zeroed() };
+    for &cpu in cpus.cpus() {
+        ensure!(cpu < libc::CPU_SETSIZE as usize, "CPU {cpu} is beyond CPU_SETSIZE");
+        unsafe { libc::CPU_SET(cpu, &mut set) };
+    }
+    let rc = unsafe { libc::sched_setaffinity(0, std::mem::size_of::<libc::cpu_set_t>(), &set) };
+    if rc != 0 {
+        return Err(std::io::Error::last_os_error())
+            .with_context(|| format!("Cannot pin thread to CPUs {cpus}"));
+    }
+    Ok(())
+}
+
+#[cfg(not(any(target_os = "linux", target_os = "android")))]
+pub fn pin_current_thread(cpus: &CpuSet) -> Result<()> {
+    anyhow::bail!("Cannot pin thread to CPUs {cpus}: CPU pinning is only supported on Linux")
+}
+
+/// CPUs the calling thread may run on.
+#[cfg(any(target_os = "linux", target_os = "android"))]
+pub fn allowed_cpus() -> Result<CpuSet> {
+    let mut set: libc::cpu_set_t = unsafe { std::mem::zeroed() };
+    let rc = unsafe { libc::sched_getaffinity(0, std::mem::size_of::<libc::cpu_set_t>(), &mut set) };
+    if rc != 0 {
+        return Err(std::io::Error::last_os_error()).context("Cannot read thread CPU affinity");
+    }
+    Ok(CpuSet::new((0..libc::CPU_SETSIZE as usize).filter(|&cpu| unsafe { libc::CPU_ISSET(cpu, &set) })))
+}
+
+#[cfg(not(any(target_os = "linux", target_os = "android")))]
+pub fn allowed_cpus() -> Result<CpuSet> {
+    Ok(CpuSet::new(0..std::thread::available_parallelism().map_or(1, |n| n.get())))
+}
+
+/// The CPU the calling thread is running on right now, where the OS says.
+pub fn current_cpu() -> Option<usize> {
+    #[cfg(any(target_os = "linux", target_os = "android"))]
+    {
+        let cpu = unsafe { libc::sched_getcpu() };
+        if cpu >= 0 {
+            return Some(cpu as usize);
+        }
+    }
+    None
+}
+
+/// One NUMA node and the CPUs of it this process may use.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct NumaNode {
+    pub id: usize,
+    pub cpus: CpuSet,
+}
+
+/// NUMA nodes with at least one CPU this thread may run on, from
+/// `/sys/devices/system/node`.  A machine (or OS) without NUMA information
+/// is reported as one node holding every allowed CPU.
+pub fn numa_nodes() -> Result<Vec<NumaNode>> {
+    let allowed = allowed_cpus()?;
+    let mut nodes = Vec::new();
+    if let Ok(dir) = std::fs::read_dir("/sys/devices/system/node") {
+        for entry in dir.flatten() {
+            let name = entry.file_name();
+            let Some(id) = name.to_str().and_then(|n| n.strip_prefix("node")).and_then(|n| n.parse().ok())
+            else {
+                continue;
+            };
+            let path = entry.path().join("cpulist");
+            let list = std::fs::read_to_string(&path)
+                .with_context(|| format!("Cannot read {}", path.display()))?;
+            let cpus = list.trim().parse::<CpuSet>()?.intersection(&allowed);
+            if !cpus.is_empty() {
+                nodes.push(NumaNode { id, cpus });
+            }
+        }
+    }
+    nodes.sort_by_key(|node| node.id);
+    if nodes.is_empty() {
+        nodes.push(NumaNode { id: 0, cpus: allowed });
+    }
+    Ok(nodes)
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Replicas
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct Replica {
+    cpus: CpuSet,
+    model: Arc<KittenTtsOnnx>,
+    /// One worker per pooled session, pinned to `cpus`.
+    workers: JobPool,
+}
+
+/// One model per CPU set, each served by workers pinned to its CPUs.
+pub struct Replicas {
+    replicas: Vec<Replica>,
+    /// Round-robin fallback when the caller's CPU is in no replica's set.
+    next: AtomicUsize,
+}
+
+impl Replicas {
+    /// One replica per [NUMA node](numa_nodes).
+    pub fn per_numa_node(
+        load: impl Fn(&LoadOptions) -> Result<KittenTtsOnnx> + Sync,
+        options: &LoadOptions,
+    ) -> Result<Self> {
+        let sets = numa_nodes()?.into_iter().map(|node| node.cpus).collect();
+        Self::load(sets, load, options)
+    }
+
+    /// One replica per entry of `cpu_sets`, loaded in parallel.
+    ///
+    /// `load` runs on a thread pinned to the replica's CPUs and receives
+    /// `options` with per-session thread pools and, unless set, an
+    /// `intra_threads` that splits the set between the pooled sessions.
+    pub fn load(
+        cpu_sets: Vec<CpuSet>,
+        load: impl Fn(&LoadOptions) -> Result<KittenTtsOnnx> + Sync,
+        options: &LoadOptions,
+    ) -> Result<Self> {
+        ensure!(!cpu_sets.is_empty(), "Replicas need at least one CPU set");
+        let load = &load;
+        let models = std::thread::scope(|s| {
+            let handles: Vec<_> = cpu_sets
+                .iter()
+                .map(|cpus| {
+                    s.spawn(move || {
+                        pin_current_thread(cpus)?;
+                        load(&replica_options(options, cpus))
+                            .with_context(|| format!("Cannot load replica on CPUs {cpus}"))
+                    })
+                })
+                .collect();
+            handles
+                .into_iter()
+                .map(|h| h.join().expect("replica loader panicked"))
+                .collect::<Result<Vec<_>>>()
+        })?;
+        let replicas = cpu_sets
+            .into_iter()
+            .zip(models)
+            .map(|(cpus, model)| {
+                let workers = JobPool::pinned(model.session_pool_size(), &cpus)?;
+                Ok(Replica { cpus, model: Arc::new(model), workers })
+            })
+            .collect::<Result<_>>()?;
+        Ok(Self { replicas, next: AtomicUsize::new(0) })
+    }
+
+    pub fn len(&self) -> usize {
+        self.replicas.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.replicas.is_empty()
+    }
+
+    pub fn cpus(&self, replica: usize) -> &CpuSet {
+        &self.replicas[replica].cpus
+    }
+
+    pub fn model(&self, replica: usize) -> &Arc<KittenTtsOnnx> {
+        &self.replicas[replica].model
+    }
+
+    /// The replica whose CPUs include the one the caller is running on,
+    /// else the next in round-robin order.
+    pub fn local_index(&self) -> usize {
+        current_cpu()
+            .and_then(|cpu| self.replicas.iter().position(|r| r.cpus.contains(cpu)))
+            .unwrap_or_else(|| self.next.fetch_add(1, Ordering::Relaxed) % self.replicas.len())
+    }
+
+    /// Queue `body` on a worker of the [local](Self::local_index) replica.
+    pub fn submit<F>(&self, body: F) -> Arc<Job>
+    where
+        F: FnOnce(&KittenTtsOnnx, &CancelToken) -> Result<Vec<f32>> + Send + 'static,
+    {
+        let replica = &self.replicas[self.local_index()];
+        let model = Arc::clone(&replica.model);
+        replica.workers.submit(move |cancel| body(&model, cancel))
+    }
+}
+
+/// `options` for a replica on `cpus`: per-session pools sized to the set
+/// rather than to the whole machine.
+fn replica_options(options: &LoadOptions, cpus: &CpuSet) -> LoadOptions {
+    let sessions = options.session_pool_size.max(1);
+    LoadOptions {
+        intra_threads: Some(options.intra_threads.unwrap_or((cpus.len() / sessions).max(1))),
+        shared_threads: false,
+        ..options.clone()
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tests
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_cpu_list_round_trip() {
+        let set: CpuSet = "8, 0-3,10-11,2".parse().unwrap();
+        assert_eq!(set.cpus(), &[0, 1, 2, 3, 8, 10, 11]);
+        assert_eq!(set.to_string(), "0-3,8,10-11");
+        assert_eq!("5".parse::<CpuSet>().unwrap().to_string(), "5");
+        assert!("".parse::<CpuSet>().unwrap().is_empty());
+        assert!("3-1".parse::<CpuSet>().is_err());
+        assert!("a".parse::<CpuSet>().is_err());
+    }
+
+    #[test]
+    fn test_split_and_intersect() {
+        let set = CpuSet::new(0..7);
+        let parts = set.split(3);
+        assert_eq!(parts.iter().map(CpuSet::to_string).collect::<Vec<_>>(), ["0-2", "3-4", "5-6"]);
+        assert_eq!(CpuSet::new([1]).split(4), vec![CpuSet::new([1])]);
+        assert_eq!(set.intersection(&"4-9".parse().unwrap()).to_string(), "4-6");
+    }
+
+    #[test]
+    fn test_replica_options_split_cpus() {
+        let base = LoadOptions { session_pool_size: 2, shared_threads: true, ..Default::default() };
+        let opts = replica_options(&base, &CpuSet::new(0..8));
+        assert_eq!((opts.intra_threads, opts.shared_threads), (Some(4), false));
+        let explicit = LoadOptions { intra_threads: Some(3), ..base };
+        assert_eq!(replica_options(&explicit, &CpuSet::new(0..8)).intra_threads, Some(3));
+    }
+
+    #[test]
+    fn test_numa_nodes_cover_allowed_cpus() {
+        let allowed = allowed_cpus().unwrap();
+        let nodes = numa_nodes().unwrap();
+        assert!(!nodes.is_empty());
+        assert!(nodes.iter().all(|n| !n.cpus.is_empty() && n.cpus.intersection(&allowed) == n.cpus));
+    }
+
+    #[cfg(any(target_os = "linux", target_os = "android"))]
+    #[test]
+    fn test_pin_current_thread() {
+        let first = CpuSet::new([allowed_cpus().unwrap().cpus()[0]]);
+        let (allowed, cpu) = std::thread::spawn(move || {
+            pin_current_thread(&first).unwrap();
+            (allowed_cpus().unwrap(), current_cpu())
+        })
+        .join()
+        .unwrap();
+        assert_eq!(allowed.len(), 1);
+        assert_eq!(cpu, Some(allowed.cpus()[0]));
+        assert!(pin_current_thread(&CpuSet::default()).is_err());
+    }
+}
@@ -0,0 +1,292 @@
+//! Allocation and peak-memory accounting.
+//!
+//! With the **`alloc-stats`** Cargo feature this module installs
+//! [`CountingAllocator`] as the process-wide global allocator.  It forwards
+//! every call to the system allocator and keeps two sets of counters:
+//!
+//! - **per thread** — read through [`AllocScope`], which measures one region
+//!   of code on the current thread (one pipeline stage, one request);
+//! - **process-wide** — read through [`global_stats`].
+//!
+//! Without the feature every function is still present, but scopes always
+//! report zero and [`is_enabled`] returns `false`, so instrumented code
+//! compiles the same way in both configurations.
+//!
+//! ```no_run
+//! let scope = kittentts::alloc::AllocScope::begin();
+//! let words = kittentts::preprocess::TextPreprocessor::new().process("It costs $5.");
+//! let stats = scope.finish();
+//! println!("{} allocations, {} bytes, peak {} bytes",
+//!     stats.allocations, stats.bytes_allocated, stats.peak_live_bytes);
+//! ```
+//!
+//! The feature defines a `#[global_allocator]`, so it cannot be combined with
+//! another global allocator in the same binary.
+//!
+//! Only Rust heap allocations are seen, and per-thread counters only see
+//! those made on the measuring thread.  ONNX Runtime allocates its arena
+//! and intermediate tensors through its own C++ allocator, partly on its
+//! intra-op threads, so the bulk of inference memory is **not** counted:
+//! the `inference` stage reports only the Rust-side tensors and output
+//! copy.  Use process RSS for the full footprint.
+
+use std::marker::PhantomData;
+
+/// Allocation counters for one measured region.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct AllocStats {
+    /// Number of allocations (a `realloc` counts as one).
+    pub allocations: u64,
+    /// Total bytes requested, ignoring frees.
+    pub bytes_allocated: u64,
+    /// Highest net heap growth above the level at the start of the region.
+    pub peak_live_bytes: u64,
+}
+
+impl AllocStats {
+    /// Combine the stats of two regions that ran one after the other.
+    pub fn merge(&mut self, other: AllocStats) {
+        self.allocations += other.allocations;
+        self.bytes_allocated += other.bytes_allocated;
+        self.peak_live_bytes = self.peak_live_bytes.max(other.peak_live_bytes);
+    }
+}
+
+/// `true` when the counting allocator is compiled in (`alloc-stats` feature).
+pub fn is_enabled() -> bool {
+    cfg!(feature = "alloc-stats")
+}
+
+// ─── Counting allocator (alloc-stats feature) ────────────────────────────────
+
+#[cfg(feature = "alloc-stats")]
+mod counting {
+    use std::{
+        alloc::{GlobalAlloc, Layout, System},
+        cell::Cell,
+        sync::atomic::{AtomicI64, AtomicU64, Ordering::Relaxed},
+    };
+
+    /// Raw per-thread counters.  `live` can go negative when this thread
+    /// frees memory another thread allocated.
+    #[derive(Clone, Copy)]
+    pub(super) struct Counters {
+        pub allocations: u64,
+        pub bytes: u64,
+        pub live: i64,
+        pub peak: i64,
+    }
+
+    thread_local! {
+        // `const` initialisation: touching the counters never allocates,
+        // which would otherwise recurse into the allocator.
+        pub(super) static THREAD: Cell<Counters> = const {
+            Cell::new(Counters { allocations: 0, bytes: 0, live: 0, peak: 0 })
+        };
+    }
+
+    pub(super) static ALLOCATIONS: AtomicU64 = AtomicU64::new(0);
+    pub(super) static BYTES: AtomicU64 = AtomicU64::new(0);
+    pub(super) static LIVE: AtomicI64 = AtomicI64::new(0);
+    pub(super) static PEAK: AtomicI64 = AtomicI64::new(0);
+
+    fn record(allocated: usize, freed: usize) {
+        let delta = allocated as i64 - freed as i64;
+        if allocated > 0 {
+            ALLOCATIONS.fetch_add(1, Relaxed);
+            BYTES.fetch_add(allocated as u64, Relaxed);
+        }
+        let live = LIVE.fetch_add(delta, Relaxed) + delta;
+        PEAK.fetch_max(live, Relaxed);
+
+        // `try_with` fails during thread teardown — those frees are dropped.
+        let _ = THREAD.try_with(|c| {
+            let mut v = c.get();
+            if allocated > 0 {
+                v.allocations += 1;
+                v.bytes += allocated as u64;
+            }
+            v.live += delta;
+            v.peak = v.peak.max(v.live);
+            c.set(v);
+        });
+    }
+
+    /// Global allocator that counts every allocation, then defers to
+    /// [`System`].
+    pub struct CountingAllocator;
+
+    unsafe impl GlobalAlloc for CountingAllocator {
+        unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+            let p = unsafe { System.alloc(layout) };
+            if !p.is_null() {
+                record(layout.size(), 0);
+            }
+            p
+        }
+
+        unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+            let p = unsafe { System.alloc_zeroed(layout) };
+            if !p.is_null() {
+                record(layout.size(), 0);
+            }
+            p
+        }
+
+        unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+            unsafe { System.dealloc(ptr, layout) };
+            record(0, layout.size());
+        }
+
+        unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+            let p = unsafe { System.realloc(ptr, layout, new_size) };
+            if !p.is_null() {
+                record(new_size, layout.size());
+            }
+            p
+        }
+    }
+
+    #[global_allocator]
+    static GLOBAL: CountingAllocator = CountingAllocator;
+}
+
+#[cfg(feature = "alloc-stats")]
+pub use counting::CountingAllocator;
+
+// ─── Public API (always compiled) ────────────────────────────────────────────
+
+/// Process-wide counters since startup.  `peak_live_bytes` is the highest
+/// total heap size observed.
+///
+/// All zero without the `alloc-stats` feature.
+pub fn global_stats() -> AllocStats {
+    #[cfg(feature = "alloc-stats")]
+    {
+        use std::sync::atomic::Ordering::Relaxed;
+        AllocStats {
+            allocations: counting::ALLOCATIONS.load(Relaxed),
+            bytes_allocated: counting::BYTES.load(Relaxed),
+            peak_live_bytes: counting::PEAK.load(Relaxed).max(0) as u64,
+        }
+    }
+    #[cfg(not(feature = "alloc-stats"))]
+    {
+        AllocStats::default()
+    }
+}
+
+/// Measures the allocations made by the current thread between
+/// [`begin`](Self::begin) and [`finish`](Self::finish).
+///
+/// Scopes nest: an inner scope does not hide its peak from the outer one.
+/// A scope is bound to the thread that created it.
+pub struct AllocScope {
+    #[cfg(feature = "alloc-stats")]
+    start: counting::Counters,
+    #[cfg(feature = "alloc-stats")]
+    outer_peak: i64,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl AllocScope {
+    /// Start measuring on the current thread.
+    pub fn begin() -> Self {
+        #[cfg(feature = "alloc-stats")]
+        {
+            let mut start = counting::THREAD.with(|c| c.get());
+            let outer_peak = start.peak;
+            start.peak = start.live;
+            counting::THREAD.with(|c| c.set(start));
+            Self { start, outer_peak, _not_send: PhantomData }
+        }
+        #[cfg(not(feature = "alloc-stats"))]
+        {
+            Self { _not_send: PhantomData }
+        }
+    }
+
+    /// Counters accumulated so far, without ending the scope.
+    pub fn stats(&self) -> AllocStats {
+        #[cfg(feature = "alloc-stats")]
+        {
+            let now = counting::THREAD.with(|c| c.get());
+            AllocStats {
+                allocations: now.allocations - self.start.allocations,
+                bytes_allocated: now.bytes - self.start.bytes,
+                peak_live_bytes: (now.peak - self.start.live).max(0) as u64,
+            }
+        }
+        #[cfg(not(feature = "alloc-stats"))]
+        {
+            AllocStats::default()
+        }
+    }
+
+    /// End the scope and return its counters.
+    pub fn finish(self) -> AllocStats {
+        self.stats()
+    }
+}
+
+impl Drop for AllocScope {
+    fn drop(&mut self) {
+        // Hand the running peak back to an enclosing scope.
+        #[cfg(feature = "alloc-stats")]
+        let _ = counting::THREAD.try_with(|c| {
+            let mut v = c.get();
+            v.peak = v.peak.max(self.outer_peak);
+            c.set(v);
+        });
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tests
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(all(test, feature = "alloc-stats"))]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_scope_counts_allocations() {
+        let scope = AllocScope::begin();
+        let v: Vec<u8> = Vec::with_capacity(4096);
+        drop(v);
+        let stats = scope.finish();
+        assert!(stats.allocations >= 1);
+        assert!(stats.bytes_allocated >= 4096);
+        assert!(stats.peak_live_bytes >= 4096);
+    }
+
+    #[test]
+    fn test_peak_survives_free() {
+        let scope = AllocScope::begin();
+        drop(vec![0u8; 1 << 20]);
+        let small = vec![0u8; 16];
+        let stats = scope.finish();
+        drop(small);
+        assert!(stats.peak_live_bytes >= 1 << 20, "peak: {}", stats.peak_live_bytes);
+    }
+
+    #[test]
+    fn test_nested_scopes() {
+        let outer = AllocScope::begin();
+        let inner = AllocScope::begin();
+        drop(vec![0u8; 1 << 16]);
+        let inner_stats = inner.finish();
+        let outer_stats = outer.finish();
+        assert!(inner_stats.peak_live_bytes >= 1 << 16);
+        assert!(outer_stats.peak_live_bytes >= inner_stats.peak_live_bytes);
+        assert!(outer_stats.allocations >= inner_stats.allocations);
+    }
+
+    #[test]
+    fn test_scope_is_per_thread() {
+        let scope = AllocScope::begin();
+        std::thread::spawn(|| drop(vec![0u8; 1 << 20])).join().unwrap();
+        let stats = scope.finish();
+        assert!(stats.bytes_allocated < 1 << 20, "other thread leaked in: {stats:?}");
+    }
+}
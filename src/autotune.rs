@@ -0,0 +1,402 @@
+//! Pick the session pool size and intra-op thread count by measuring them.
+//!
+//! The right split between parallel sessions and threads per session
+//! depends on the machine: one session on every core gives the lowest
+//! single-request latency on some CPUs, while several narrower sessions
+//! serve more audio per second under load.  [`tune`] loads the model once
+//! per candidate [`Topology`] — by default every power-of-two pool size up
+//! to the logical CPUs (at most 8), each given `cpus / sessions` threads
+//! rounded down: 1×16, 2×8, 4×4 and 8×2 on 16 CPUs, 1×6, 2×3 and 4×1 on
+//! 6 — and measures both:
+//!
+//! * **latency** — median time of one request on an idle model;
+//! * **throughput** — seconds of audio produced per wall-clock second with
+//!   every session busy.
+//!
+//! The [`Objective`] decides which wins.  Decisions are cached in a JSON
+//! file keyed by CPU model, model, execution provider, objective and
+//! candidate list, so only the first start with a given setup pays for the
+//! measurement.
+//!
+//! ```no_run
+//! use kittentts::{autotune::{self, AutotuneOptions, Objective}, download, model::LoadOptions};
+//!
+//! let tune = AutotuneOptions {
+//!     objective: Objective::Throughput,
+//!     model_id: "KittenML/kitten-tts-mini-0.8".into(),
+//!     cache_path: autotune::default_cache_path(),
+//!     ..Default::default()
+//! };
+//! let load = |o: &LoadOptions| download::load_from_hub_with("KittenML/kitten-tts-mini-0.8", o);
+//! let tuning = autotune::tune(load, &LoadOptions::default(), &tune)?;
+//! let tts = load(&tuning.chosen.apply(LoadOptions::default()))?;
+//! # anyhow::Ok(())
+//! ```
+
+use std::{
+    collections::HashMap,
+    path::{Path, PathBuf},
+    time::{Duration, Instant},
+};
+
+use anyhow::{Context, Result};
+use serde::{Deserialize, Serialize};
+
+use crate::model::{KittenTtsOnnx, LoadOptions, SAMPLE_RATE};
+
+/// IPA measured by every candidate: one ordinary sentence.
+const PROBE_IPA: &str = "ðə kwɪk bɹaʊn fɑːks dʒʌmps oʊvɚ ðə leɪzi dɑːɡ.";
+
+/// Largest pool [`candidates`] proposes; every session holds its own
+/// copy of the weights.
+const MAX_SESSIONS: usize = 8;
+
+/// What [`tune`] optimises for.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Hash, Serialize, Deserialize)]
+#[serde(rename_all = "lowercase")]
+pub enum Objective {
+    /// Fastest single request on an idle model.
+    #[default]
+    Latency,
+    /// Most audio per second with every session busy.
+    Throughput,
+}
+
+impl Objective {
+    pub fn name(self) -> &'static str {
+        match self {
+            Self::Latency => "latency",
+            Self::Throughput => "throughput",
+        }
+    }
+}
+
+impl std::str::FromStr for Objective {
+    type Err = anyhow::Error;
+
+    fn from_str(s: &str) -> Result<Self> {
+        [Self::Latency, Self::Throughput]
+            .into_iter()
+            .find(|o| o.name().eq_ignore_ascii_case(s))
+            .with_context(|| format!("Unknown objective '{s}' (expected latency or throughput)"))
+    }
+}
+
+/// A session pool of `sessions`, each with `intra_threads` ORT threads.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize, Deserialize)]
+pub struct Topology {
+    pub sessions: usize,
+    pub intra_threads: usize,
+}
+
+impl Topology {
+    /// `options` set up for this topology.  Per-session thread pools are
+    /// switched back on, since shared pools would ignore `intra_threads`.
+    pub fn apply(self, options: LoadOptions) -> LoadOptions {
+        LoadOptions {
+            session_pool_size: self.sessions,
+            intra_threads: Some(self.intra_threads),
+            shared_threads: false,
+            ..options
+        }
+    }
+}
+
+impl std::fmt::Display for Topology {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "{}×{}", self.sessions, self.intra_threads)
+    }
+}
+
+/// Power-of-two pool sizes up to `cpus` (and at most 8), each with
+/// `cpus / sessions` threads, rounded down; CPUs that don't divide evenly
+/// are left idle rather than oversubscribed.
+pub fn candidates(cpus: usize) -> Vec<Topology> {
+    let cpus = cpus.max(1);
+    std::iter::successors(Some(1usize), |s| Some(s * 2))
+        .take_while(|&s| s <= cpus.min(MAX_SESSIONS))
+        .map(|sessions| Topology { sessions, intra_threads: cpus / sessions })
+        .collect()
+}
+
+/// Settings for [`tune`].
+#[derive(Debug, Clone)]
+pub struct AutotuneOptions {
+    pub objective: Objective,
+    /// Names the model `load` builds, e.g. its hub repo, so decisions for
+    /// different models are cached apart.
+    pub model_id: String,
+    /// Configurations to try; empty means [`candidates`] for this machine.
+    pub candidates: Vec<Topology>,
+    /// Timed single requests per candidate; the throughput run issues this
+    /// many requests per session.
+    pub iterations: usize,
+    /// Decision cache.  `None` measures on every call.
+    pub cache_path: Option<PathBuf>,
+}
+
+impl Default for AutotuneOptions {
+    fn default() -> Self {
+        Self {
+            objective: Objective::default(),
+            model_id: String::new(),
+            candidates: Vec::new(),
+            iterations: 5,
+            cache_path: None,
+        }
+    }
+}
+
+/// `$XDG_CACHE_HOME/kittentts/autotune.json`, else under `~/.cache`.
+pub fn default_cache_path() -> Option<PathBuf> {
+    let base = std::env::var_os("XDG_CACHE_HOME")
+        .map(PathBuf::from)
+        .or_else(|| std::env::var_os("HOME").map(|home| PathBuf::from(home).join(".cache")))?;
+    Some(base.join("kittentts").join("autotune.json"))
+}
+
+/// One candidate's scores.
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct Measurement {
+    pub topology: Topology,
+    /// Median single-request time on an idle model.
+    pub latency_ms: f64,
+    /// Audio seconds per wall-clock second with every session busy.
+    pub audio_sec_per_sec: f64,
+}
+
+/// The outcome of [`tune`].
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct Tuning {
+    /// CPU model and logical CPU count the decision was made on.
+    pub cpu: String,
+    pub objective: Objective,
+    pub chosen: Topology,
+    pub measurements: Vec<Measurement>,
+    /// `true` when read from the cache instead of measured.
+    #[serde(skip)]
+    pub cached: bool,
+}
+
+/// Measure every candidate and pick the best for `options.objective`, or
+/// return the cached decision for the same CPU, model, execution provider
+/// and candidates.
+///
+/// `load` builds the model for one candidate; it receives `base` with the
+/// candidate [applied](Topology::apply), `warm_up` set and profiling off.
+/// Each model is dropped before the next is loaded.
+pub fn tune(
+    load: impl Fn(&LoadOptions) -> Result<KittenTtsOnnx>,
+    base: &LoadOptions,
+    options: &AutotuneOptions,
+) -> Result<Tuning> {
+    let cpu = cpu_key();
+    let cpus = std::thread::available_parallelism().map_or(1, |n| n.get());
+    let topologies =
+        if options.candidates.is_empty() { candidates(cpus) } else { options.candidates.clone() };
+    let key = cache_key(&cpu, base, options, &topologies);
+    let mut cache = match &options.cache_path {
+        Some(path) => read_cache(path)?,
+        None => HashMap::new(),
+    };
+    // The key covers the candidates; the check guards hand-edited files.
+    if let Some(tuning) = cache.get(&key).filter(|t| topologies.contains(&t.chosen)) {
+        return Ok(Tuning { cached: true, ..tuning.clone() });
+    }
+
+    let mut measurements = Vec::with_capacity(topologies.len());
+    for topology in topologies {
+        let tts = load(&LoadOptions { warm_up: true, profiling: None, ..topology.apply(base.clone()) })
+            .with_context(|| format!("Cannot load model for topology {topology}"))?;
+        measurements.push(measure(&tts, topology, options.iterations.max(1))?);
+    }
+    let chosen = choose(&measurements, options.objective).context("No candidate topologies")?;
+    let tuning = Tuning { cpu, objective: options.objective, chosen, measurements, cached: false };
+
+    if let Some(path) = &options.cache_path {
+        cache.insert(key, tuning.clone());
+        write_cache(path, &cache)?;
+    }
+    Ok(tuning)
+}
+
+fn measure(tts: &KittenTtsOnnx, topology: Topology, iterations: usize) -> Result<Measurement> {
+    let voice = tts.available_voices.first().context("Model has no voices")?;
+
+    let mut times: Vec<Duration> = (0..iterations)
+        .map(|_| {
+            let start = Instant::now();
+            tts.generate_from_ipa(PROBE_IPA, voice, 1.0, PROBE_IPA.len())?;
+            Ok(start.elapsed())
+        })
+        .collect::<Result<_>>()?;
+    times.sort();
+
+    // The batch runs one worker per session, keeping the whole pool busy.
+    let items = vec![PROBE_IPA; topology.sessions * iterations];
+    let start = Instant::now();
+    let audio = tts.generate_from_ipa_batch(&items, voice, 1.0)?;
+    let wall = start.elapsed().as_secs_f64();
+    let samples: usize = audio.iter().map(Vec::len).sum();
+
+    Ok(Measurement {
+        topology,
+        latency_ms: times[times.len() / 2].as_secs_f64() * 1e3,
+        audio_sec_per_sec: samples as f64 / SAMPLE_RATE as f64 / wall,
+    })
+}
+
+/// The best-scoring topology for `objective`.
+fn choose(measurements: &[Measurement], objective: Objective) -> Option<Topology> {
+    let best = match objective {
+        Objective::Latency => measurements.iter().min_by(|a, b| a.latency_ms.total_cmp(&b.latency_ms)),
+        Objective::Throughput => {
+            measurements.iter().max_by(|a, b| a.audio_sec_per_sec.total_cmp(&b.audio_sec_per_sec))
+        }
+    };
+    best.map(|m| m.topology)
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Decision cache
+// ─────────────────────────────────────────────────────────────────────────────
+
+fn read_cache(path: &Path) -> Result<HashMap<String, Tuning>> {
+    match std::fs::read_to_string(path) {
+        Ok(json) => serde_json::from_str(&json)
+            .with_context(|| format!("Invalid autotune cache {}", path.display())),
+        Err(e) if e.kind() == std::io::ErrorKind::NotFound => Ok(HashMap::new()),
+        Err(e) => Err(e).with_context(|| format!("Cannot read autotune cache {}", path.display())),
+    }
+}
+
+fn write_cache(path: &Path, cache: &HashMap<String, Tuning>) -> Result<()> {
+    if let Some(dir) = path.parent() {
+        std::fs::create_dir_all(dir)
+            .with_context(|| format!("Cannot create {}", dir.display()))?;
+    }
+    // Write-then-rename so a concurrent reader never sees half a file.
+    let tmp = path.with_extension("json.tmp");
+    std::fs::write(&tmp, serde_json::to_string_pretty(cache)?)
+        .and_then(|()| std::fs::rename(&tmp, path))
+        .with_context(|| format!("Cannot write autotune cache {}", path.display()))
+}
+
+/// Cache key for one decision: anything that changes which topology wins.
+fn cache_key(cpu: &str, base: &LoadOptions, options: &AutotuneOptions, topologies: &[Topology]) -> String {
+    let topologies: Vec<String> = topologies.iter().map(Topology::to_string).collect();
+    format!(
+        "{cpu}/{}/{}/{}/{}",
+        options.model_id,
+        base.execution_provider.name(),
+        options.objective.name(),
+        topologies.join(",")
+    )
+}
+
+/// CPU model and logical CPU count.
+fn cpu_key() -> String {
+    let cpus = std::thread::available_parallelism().map_or(1, |n| n.get());
+    format!("{} ({cpus} CPUs)", cpu_model().unwrap_or_else(|| std::env::consts::ARCH.to_string()))
+}
+
+/// The CPU's marketing name, where the OS reports one.
+#[cfg(any(target_os = "linux", target_os = "android"))]
+fn cpu_model() -> Option<String> {
+    let info = std::fs::read_to_string("/proc/cpuinfo").ok()?;
+    // x86 reports "model name"; many ARM kernels only "Hardware".
+    ["model name", "Hardware"].iter().find_map(|field| {
+        info.lines().find_map(|line| {
+            let (key, value) = line.split_once(':')?;
+            (key.trim() == *field).then(|| value.trim().to_string())
+        })
+    })
+}
+
+#[cfg(target_vendor = "apple")]
+fn cpu_model() -> Option<String> {
+    let mut buf = [0u8; 256];
+    let mut len = buf.len();
+    // SAFETY: `buf` and `len` describe a writable buffer; the name is a C string.
+    let rc = unsafe {
+        libc::sysctlbyname(
+            c"machdep.cpu.brand_string".as_ptr(),
+            buf.as_mut_ptr().cast(),
+            &mut len,
+            std::ptr::null_mut(),
+            0,
+        )
+    };
+    (rc == 0).then(|| String::from_utf8_lossy(&buf[..len]).trim_end_matches('\0').to_string())
+}
+
+#[cfg(not(any(target_os = "linux", target_os = "android", target_vendor = "apple")))]
+fn cpu_model() -> Option<String> {
+    None
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tests
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn t(sessions: usize, intra_threads: usize) -> Topology {
+        Topology { sessions, intra_threads }
+    }
+
+    #[test]
+    fn test_candidates() {
+        assert_eq!(candidates(16), vec![t(1, 16), t(2, 8), t(4, 4), t(8, 2)]);
+        assert_eq!(candidates(6), vec![t(1, 6), t(2, 3), t(4, 1)]);
+        assert_eq!(candidates(0), vec![t(1, 1)]);
+    }
+
+    #[test]
+    fn test_choose_by_objective() {
+        let m = |topology, latency_ms, audio_sec_per_sec| Measurement { topology, latency_ms, audio_sec_per_sec };
+        let results = [m(t(1, 8), 90.0, 20.0), m(t(4, 2), 150.0, 45.0), m(t(8, 1), 260.0, 40.0)];
+        assert_eq!(choose(&results, Objective::Latency), Some(t(1, 8)));
+        assert_eq!(choose(&results, Objective::Throughput), Some(t(4, 2)));
+        assert_eq!(choose(&[], Objective::Latency), None);
+    }
+
+    #[test]
+    fn test_cache_key_separates_setups() {
+        use crate::model::ExecutionProvider;
+
+        let base = LoadOptions::default();
+        let options = AutotuneOptions { model_id: "a".into(), ..Default::default() };
+        let key = cache_key("cpu", &base, &options, &[t(1, 4), t(2, 2)]);
+        assert_eq!(key, cache_key("cpu", &base, &options, &[t(1, 4), t(2, 2)]));
+        assert_ne!(key, cache_key("cpu", &base, &options, &[t(1, 4)]));
+        let other_model = AutotuneOptions { model_id: "b".into(), ..options.clone() };
+        assert_ne!(key, cache_key("cpu", &base, &other_model, &[t(1, 4), t(2, 2)]));
+        let xnnpack = LoadOptions { execution_provider: ExecutionProvider::Xnnpack, ..base.clone() };
+        assert_ne!(key, cache_key("cpu", &xnnpack, &options, &[t(1, 4), t(2, 2)]));
+    }
+
+    #[test]
+    fn test_cache_round_trip() {
+        let path = std::env::temp_dir().join(format!("kittentts-autotune-{}/cache.json", std::process::id()));
+        assert!(read_cache(&path).unwrap().is_empty());
+        let tuning = Tuning {
+            cpu: cpu_key(),
+            objective: Objective::Throughput,
+            chosen: t(2, 4),
+            measurements: Vec::new(),
+            cached: false,
+        };
+        write_cache(&path, &HashMap::from([("k".to_string(), tuning.clone())])).unwrap();
+        assert_eq!(read_cache(&path).unwrap()["k"], tuning);
+        std::fs::remove_dir_all(path.parent().unwrap()).unwrap();
+    }
+
+    #[test]
+    fn test_objective_from_str() {
+        assert_eq!("Throughput".parse::<Objective>().unwrap(), Objective::Throughput);
+        assert!("fast".parse::<Objective>().is_err());
+    }
+}
@@ -0,0 +1,237 @@
+//! Pluggable inference engines behind [`KittenTtsOnnx`].
+//!
+//! Everything around the network — voice lookup, chunking, phonemisation,
+//! tokenisation, tail trimming, batching and statistics — is shared; only
+//! the step that turns `(input_ids, style, speed)` into a waveform goes
+//! through [`InferenceBackend`].  Three engines implement it:
+//!
+//! | Backend          | Selected by                          | Notes |
+//! |------------------|--------------------------------------|-------|
+//! | ONNX Runtime     | [`BackendKind::Ort`] (default)       | Session pool, profiling, arena control |
+//! | [`TractBackend`] | [`BackendKind::Tract`], `tract` feature | Pure Rust, no native library |
+//! | [`MockBackend`]  | [`KittenTtsOnnx::from_backend`]      | Synthetic audio, no model file |
+//!
+//! The mock isolates pipeline overhead: with it, any time a benchmark
+//! spends outside [`GenerationStats::inference`] is the crate's own.
+//!
+//! ```no_run
+//! use kittentts::{backend::{self, MockBackend}, model::{KittenTtsOnnx, LoadOptions}};
+//!
+//! let tts = KittenTtsOnnx::from_backend(
+//!     Box::new(MockBackend::default()),
+//!     backend::synthetic_voices(&["Jasper"]),
+//!     Default::default(),
+//!     Default::default(),
+//!     &LoadOptions::default(),
+//! )?;
+//! let audio = tts.generate_from_ipa("həloʊ", "Jasper", 1.0, 5)?;
+//! # anyhow::Ok(())
+//! ```
+//!
+//! [`KittenTtsOnnx`]: crate::model::KittenTtsOnnx
+//! [`KittenTtsOnnx::from_backend`]: crate::model::KittenTtsOnnx::from_backend
+//! [`BackendKind::Ort`]: crate::model::BackendKind::Ort
+//! [`BackendKind::Tract`]: crate::model::BackendKind::Tract
+//! [`GenerationStats::inference`]: crate::stats::GenerationStats::inference
+
+use std::{collections::HashMap, time::Duration};
+
+use anyhow::Result;
+
+use crate::{
+    model::{SAMPLE_RATE, TAIL_TRIM},
+    npz::NpyArray,
+    tokenize::ipa_to_ids,
+};
+
+/// One inference engine for the KittenTTS graph.
+///
+/// Implementations must be usable from several threads at once; the model
+/// runs up to [`concurrency`](Self::concurrency) calls in parallel from
+/// `generate_*_batch`.
+pub trait InferenceBackend: Send + Sync {
+    /// Short name for logs and benchmark tables, e.g. `"ort"`.
+    fn name(&self) -> &'static str;
+
+    /// Run the graph once: `input_ids` is `[0, tok…, 0]`, `style` one row of
+    /// the voice matrix.  Returns the raw waveform at [`SAMPLE_RATE`],
+    /// before the tail trim.
+    fn infer(&self, input_ids: Vec<i64>, style: &[f32], speed: f32) -> Result<Vec<f32>>;
+
+    /// Inferences that can usefully run at once.
+    fn concurrency(&self) -> usize {
+        1
+    }
+
+    /// Times a call had to wait for the engine to become free.
+    fn waits(&self) -> u64 {
+        0
+    }
+
+    /// Pay any lazy initialisation now, before the first real request.
+    fn warm_up(&self, style: &[f32]) -> Result<()> {
+        self.infer(ipa_to_ids("həlˈoʊ"), style, 1.0).map(drop)
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Mock backend
+// ─────────────────────────────────────────────────────────────────────────────
+
+/// Backend that returns a quiet sine tone instead of speech.
+///
+/// Output length scales like the real model's — `samples_per_token / speed`
+/// samples per input token, after the tail trim — so chunking, encoding and
+/// streaming see realistic buffer sizes.
+#[derive(Debug, Clone)]
+pub struct MockBackend {
+    /// Trimmed output samples per input token at speed 1.0.
+    pub samples_per_token: usize,
+    /// Sleep per call, to model inference cost.  Zero by default.
+    pub latency: Duration,
+    /// Value reported as [`InferenceBackend::concurrency`].
+    pub concurrency: usize,
+}
+
+impl Default for MockBackend {
+    fn default() -> Self {
+        // ~25 ms of audio per token, close to the mini model at speed 1.0.
+        Self { samples_per_token: 600, latency: Duration::ZERO, concurrency: 1 }
+    }
+}
+
+impl InferenceBackend for MockBackend {
+    fn name(&self) -> &'static str {
+        "mock"
+    }
+
+    fn infer(&self, input_ids: Vec<i64>, _style: &[f32], speed: f32) -> Result<Vec<f32>> {
+        if !self.latency.is_zero() {
+            std::thread::sleep(self.latency);
+        }
+        let speech = (input_ids.len() * self.samples_per_token) as f32 / speed.max(f32::EPSILON);
+        let len = speech as usize + TAIL_TRIM;
+        let step = 2.0 * std::f32::consts::PI * 220.0 / SAMPLE_RATE as f32;
+        Ok((0..len).map(|i| 0.1 * (i as f32 * step).sin()).collect())
+    }
+
+    fn concurrency(&self) -> usize {
+        self.concurrency.max(1)
+    }
+}
+
+/// Voice matrices shaped like the bundled ones (400 × 256) for use with
+/// [`MockBackend`].  Each voice's rows hold a distinct constant.
+pub fn synthetic_voices(names: &[&str]) -> HashMap<String, NpyArray> {
+    const ROWS: usize = 400;
+    const STYLE_DIM: usize = 256;
+    names
+        .iter()
+        .enumerate()
+        .map(|(i, name)| {
+            let value = (i + 1) as f32 / names.len() as f32;
+            let voice = NpyArray { shape: vec![ROWS, STYLE_DIM], data: vec![value; ROWS * STYLE_DIM] };
+            (name.to_string(), voice)
+        })
+        .collect()
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// tract backend (requires `tract` feature)
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(feature = "tract")]
+pub use self::tract::TractBackend;
+
+#[cfg(feature = "tract")]
+mod tract {
+    use std::path::Path;
+
+    use anyhow::{Context, Result};
+    use tract_onnx::prelude::*;
+
+    use super::InferenceBackend;
+
+    /// Pure-Rust backend on [tract](https://github.com/sonos/tract).
+    ///
+    /// Needs no native ONNX Runtime, at the cost of speed.  The optimised
+    /// plan is immutable, so every thread runs on it at once.
+    pub struct TractBackend {
+        plan: TypedRunnableModel<TypedModel>,
+    }
+
+    impl TractBackend {
+        /// Load and optimise the ONNX graph at `path`.
+        pub fn load(path: &Path) -> Result<Self> {
+            let model = tract_onnx::onnx()
+                .model_for_path(path)
+                .with_context(|| format!("Cannot load ONNX model: {}", path.display()))?;
+            Self::optimise(model)
+        }
+
+        /// [`load`](Self::load) from serialized model bytes.
+        pub fn from_bytes(mut bytes: &[u8]) -> Result<Self> {
+            let model = tract_onnx::onnx()
+                .model_for_read(&mut bytes)
+                .context("Cannot load ONNX model from memory")?;
+            Self::optimise(model)
+        }
+
+        fn optimise(model: InferenceModel) -> Result<Self> {
+            let plan = model
+                .into_optimized()
+                .and_then(|m| m.into_runnable())
+                .context("tract failed to optimise the model")?;
+            Ok(Self { plan })
+        }
+    }
+
+    impl InferenceBackend for TractBackend {
+        fn name(&self) -> &'static str {
+            "tract"
+        }
+
+        fn infer(&self, input_ids: Vec<i64>, style: &[f32], speed: f32) -> Result<Vec<f32>> {
+            let _run = tracing::info_span!("tract_run", seq_len = input_ids.len()).entered();
+            // Positional, as for ORT: input_ids [1, seq_len], style [1, style_d], speed [1].
+            let inputs = tvec!(
+                Tensor::from_shape(&[1, input_ids.len()], &input_ids)?.into(),
+                Tensor::from_shape(&[1, style.len()], style)?.into(),
+                Tensor::from_shape(&[1], &[speed])?.into(),
+            );
+            let outputs = self.plan.run(inputs).context("tract inference failed")?;
+            Ok(outputs[0].as_slice::<f32>().context("Failed to extract audio tensor")?.to_vec())
+        }
+
+        fn concurrency(&self) -> usize {
+            std::thread::available_parallelism().map_or(1, |n| n.get())
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tests
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_mock_output_scales_with_tokens_and_speed() {
+        let mock = MockBackend::default();
+        let trimmed = |ids: usize, speed| mock.infer(vec![0; ids], &[], speed).unwrap().len() - TAIL_TRIM;
+        assert_eq!(trimmed(10, 1.0), 6_000);
+        assert_eq!(trimmed(20, 1.0), 12_000);
+        assert_eq!(trimmed(10, 2.0), 3_000);
+        assert!(mock.infer(vec![0; 4], &[], 1.0).unwrap().iter().all(|s| s.abs() <= 0.1));
+    }
+
+    #[test]
+    fn test_synthetic_voices_shape() {
+        let voices = synthetic_voices(&["a", "b"]);
+        assert_eq!(voices.len(), 2);
+        assert_eq!(voices["a"].shape, vec![400, 256]);
+        assert_ne!(voices["a"].data[0], voices["b"].data[0]);
+    }
+}
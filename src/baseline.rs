@@ -0,0 +1,606 @@
+//! Performance baselines: record, store as JSON, compare.
+//!
+//! A [`Baseline`] captures one run of the synthesis pipeline over a fixed
+//! corpus: throughput, per-utterance latency percentiles, real-time factor,
+//! peak RSS and mean per-stage times (from [`GenerationStats`]).  Two
+//! baselines are compared with [`compare`], which flags a metric only when
+//! the change exceeds both a relative threshold and the measured run-to-run
+//! noise, and renders the result as a table.
+//!
+//! The `kittentts-perf` binary (`perf` feature) wraps this:
+//!
+//! ```bash
+//! kittentts-perf record --out base.json
+//! # … change code …
+//! kittentts-perf compare base.json          # exits 1 on regression
+//! ```
+
+use std::{fmt, path::Path, time::Duration};
+
+use anyhow::{Context, Result};
+use serde::{Deserialize, Serialize};
+
+use crate::stats::{peak_rss_bytes, GenerationStats};
+
+/// Schema version written into every baseline file.
+pub const BASELINE_VERSION: u32 = 1;
+
+/// Reference corpus: short, medium and multi-chunk inputs covering the
+/// preprocessor rules (numbers, currency, times, URLs, abbreviations).
+pub const REFERENCE_CORPUS: &[&str] = &[
+    "Hello world.",
+    "The quick brown fox jumps over the lazy dog.",
+    "She finished 1st, he came 2nd, and I was 3rd in the 100 km race.",
+    "The price dropped 15% from $1,299.99 to $1.1K over the 1990s.",
+    "Meet me at 10:30 pm on pages 12-18; call 555-123-4567 if you are late.",
+    "Dr. Smith's lab measured 2.4 GHz interference at 40 °C on March 3rd, 2021.",
+    "Speech synthesis turns written text into natural sounding audio. \
+     This paragraph is long enough to be split into several chunks, so the \
+     baseline also covers chunking and the concatenation of the chunk outputs. \
+     Each chunk runs through preprocessing, phonemisation, tokenisation and \
+     inference in turn, and the per-stage times are summed across chunks.",
+];
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Baseline types
+// ─────────────────────────────────────────────────────────────────────────────
+
+/// Distribution of one per-utterance metric.
+#[derive(Debug, Clone, Default, PartialEq, Serialize, Deserialize)]
+pub struct Distribution {
+    pub samples: usize,
+    pub mean: f64,
+    pub stddev: f64,
+    pub min: f64,
+    pub p50: f64,
+    pub p90: f64,
+    pub p99: f64,
+    pub max: f64,
+}
+
+impl Distribution {
+    /// Summarise `values` (any order).  Percentiles use the nearest-rank method.
+    pub fn from_values(values: &[f64]) -> Self {
+        if values.is_empty() {
+            return Self::default();
+        }
+        let mut sorted = values.to_vec();
+        sorted.sort_by(|a, b| a.total_cmp(b));
+        let n = sorted.len();
+        let mean = sorted.iter().sum::<f64>() / n as f64;
+        let var = if n > 1 {
+            sorted.iter().map(|v| (v - mean).powi(2)).sum::<f64>() / (n - 1) as f64
+        } else {
+            0.0
+        };
+        let pct = |p: f64| sorted[((p / 100.0 * n as f64).ceil() as usize).clamp(1, n) - 1];
+        Self {
+            samples: n,
+            mean,
+            stddev: var.sqrt(),
+            min: sorted[0],
+            p50: pct(50.0),
+            p90: pct(90.0),
+            p99: pct(99.0),
+            max: sorted[n - 1],
+        }
+    }
+
+    /// Standard error of the mean.
+    fn std_error(&self) -> f64 {
+        if self.samples > 0 {
+            self.stddev / (self.samples as f64).sqrt()
+        } else {
+            0.0
+        }
+    }
+}
+
+/// Mean time per utterance spent in each pipeline stage, in milliseconds.
+#[derive(Debug, Clone, Default, PartialEq, Serialize, Deserialize)]
+pub struct StageTimes {
+    pub preprocess_ms: f64,
+    pub phonemize_ms: f64,
+    pub tokenize_ms: f64,
+    pub inference_ms: f64,
+}
+
+impl StageTimes {
+    fn named(&self) -> [(&'static str, f64); 4] {
+        [
+            ("preprocess", self.preprocess_ms),
+            ("phonemize", self.phonemize_ms),
+            ("tokenize", self.tokenize_ms),
+            ("inference", self.inference_ms),
+        ]
+    }
+}
+
+/// One recorded performance run.
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct Baseline {
+    pub version: u32,
+    /// Free-form label, e.g. the git revision or model name.
+    pub label: String,
+    /// Seconds since the Unix epoch when the run finished.
+    pub created_unix: u64,
+    pub os: String,
+    pub arch: String,
+    pub cpus: usize,
+    /// Utterances synthesised (corpus size × iterations, excluding warm-up).
+    pub utterances: usize,
+    /// Input characters synthesised per wall-clock second.
+    pub chars_per_sec: f64,
+    /// Seconds of audio produced per wall-clock second.
+    pub audio_sec_per_sec: f64,
+    /// Per-utterance end-to-end latency, in milliseconds.
+    pub latency_ms: Distribution,
+    /// Per-utterance real-time factor (wall time ÷ audio duration).
+    pub rtf: Distribution,
+    /// Process peak RSS at the end of the run; `None` off Linux.
+    pub peak_rss_bytes: Option<u64>,
+    pub stages: StageTimes,
+}
+
+impl Baseline {
+    pub fn load(path: &Path) -> Result<Self> {
+        let json = std::fs::read_to_string(path)
+            .with_context(|| format!("Cannot read baseline {}", path.display()))?;
+        let baseline: Self = serde_json::from_str(&json)
+            .with_context(|| format!("Invalid baseline file {}", path.display()))?;
+        anyhow::ensure!(
+            baseline.version == BASELINE_VERSION,
+            "Baseline {} has version {}, expected {}",
+            path.display(),
+            baseline.version,
+            BASELINE_VERSION
+        );
+        Ok(baseline)
+    }
+
+    pub fn save(&self, path: &Path) -> Result<()> {
+        let json = serde_json::to_string_pretty(self)?;
+        std::fs::write(path, json)
+            .with_context(|| format!("Cannot write baseline {}", path.display()))
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Recording
+// ─────────────────────────────────────────────────────────────────────────────
+
+/// Accumulates per-utterance [`GenerationStats`] into a [`Baseline`].
+#[derive(Debug, Default)]
+pub struct Recorder {
+    latency_ms: Vec<f64>,
+    rtf: Vec<f64>,
+    chars: usize,
+    totals: GenerationStats,
+}
+
+impl Recorder {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Add one synthesised utterance of `text_len` input bytes.
+    pub fn record(&mut self, text_len: usize, stats: &GenerationStats) {
+        self.latency_ms.push(ms(stats.total.time));
+        self.rtf.push(stats.real_time_factor());
+        self.chars += text_len;
+        self.totals.merge(stats);
+    }
+
+    pub fn finish(self, label: impl Into<String>) -> Baseline {
+        let n = self.latency_ms.len().max(1) as f64;
+        let busy = self.totals.total.time.as_secs_f64();
+        let per_sec = |x: f64| if busy > 0.0 { x / busy } else { 0.0 };
+        Baseline {
+            version: BASELINE_VERSION,
+            label: label.into(),
+            created_unix: std::time::SystemTime::now()
+                .duration_since(std::time::UNIX_EPOCH)
+                .map(|d| d.as_secs())
+                .unwrap_or(0),
+            os: std::env::consts::OS.to_string(),
+            arch: std::env::consts::ARCH.to_string(),
+            cpus: std::thread::available_parallelism()
+                .map(|n| n.get())
+                .unwrap_or(1),
+            utterances: self.latency_ms.len(),
+            chars_per_sec: per_sec(self.chars as f64),
+            audio_sec_per_sec: per_sec(self.totals.audio_seconds()),
+            latency_ms: Distribution::from_values(&self.latency_ms),
+            rtf: Distribution::from_values(&self.rtf),
+            peak_rss_bytes: peak_rss_bytes(),
+            stages: StageTimes {
+                preprocess_ms: ms(self.totals.preprocess.time) / n,
+                phonemize_ms: ms(self.totals.phonemize.time) / n,
+                tokenize_ms: ms(self.totals.tokenize.time) / n,
+                inference_ms: ms(self.totals.inference.time) / n,
+            },
+        }
+    }
+}
+
+fn ms(d: Duration) -> f64 {
+    d.as_secs_f64() * 1_000.0
+}
+
+/// Synthesise `corpus` `iterations` times with `voice` and record a baseline.
+///
+/// Each sentence is synthesised `warmup` times first and not recorded, so
+/// ORT's first-run allocations and lazy initialisation don't skew latency.
+///
+/// **Requires the `espeak` Cargo feature.**
+#[cfg(feature = "espeak")]
+pub fn record_corpus(
+    tts: &crate::model::KittenTtsOnnx,
+    corpus: &[&str],
+    voice: &str,
+    iterations: usize,
+    warmup: usize,
+    label: impl Into<String>,
+) -> Result<Baseline> {
+    for _ in 0..warmup {
+        for text in corpus {
+            tts.generate(text, voice, 1.0, true)?;
+        }
+    }
+    let mut recorder = Recorder::new();
+    for _ in 0..iterations.max(1) {
+        for text in corpus {
+            let (_, stats) = tts.generate_with_stats(text, voice, 1.0, true)?;
+            recorder.record(text.len(), &stats);
+        }
+    }
+    Ok(recorder.finish(label))
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Comparison
+// ─────────────────────────────────────────────────────────────────────────────
+
+/// When a change counts as significant.
+#[derive(Debug, Clone, Copy)]
+pub struct Thresholds {
+    /// Minimum relative change, as a fraction (0.05 = 5 %).
+    pub relative: f64,
+    /// Change must also exceed this many combined standard errors, for
+    /// metrics that carry a distribution.
+    pub noise_sigmas: f64,
+    /// Relative threshold for peak RSS, which has no noise estimate.
+    pub rss_relative: f64,
+}
+
+impl Default for Thresholds {
+    fn default() -> Self {
+        Self {
+            relative: 0.05,
+            noise_sigmas: 3.0,
+            rss_relative: 0.10,
+        }
+    }
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize, Deserialize)]
+#[serde(rename_all = "lowercase")]
+pub enum Verdict {
+    Improved,
+    Unchanged,
+    Regressed,
+}
+
+/// One row of a comparison.
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct MetricDiff {
+    pub name: String,
+    pub unit: String,
+    pub baseline: f64,
+    pub current: f64,
+    /// Relative change in percent (positive = larger value).
+    pub change_pct: f64,
+    /// Smallest change in percent that would have been flagged.
+    pub threshold_pct: f64,
+    pub verdict: Verdict,
+}
+
+/// Result of [`compare`].
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct Comparison {
+    pub baseline_label: String,
+    pub current_label: String,
+    pub metrics: Vec<MetricDiff>,
+}
+
+impl Comparison {
+    pub fn has_regressions(&self) -> bool {
+        self.metrics.iter().any(|m| m.verdict == Verdict::Regressed)
+    }
+}
+
+/// Compare `current` against `base`.
+///
+/// A metric changes when `|Δ| / base` exceeds the larger of
+/// [`Thresholds::relative`] and `noise_sigmas` × the combined standard error
+/// of both runs (relative to the baseline).  Whether a change is an
+/// improvement depends on the metric's direction.
+pub fn compare(base: &Baseline, current: &Baseline, t: &Thresholds) -> Comparison {
+    let mut metrics = Vec::new();
+    let mut push =
+        |name: &str, unit: &str, b: f64, c: f64, noise: f64, rel: f64, higher_better: bool| {
+            let change = if b != 0.0 { (c - b) / b.abs() } else { 0.0 };
+            let threshold = rel.max(if b != 0.0 {
+                t.noise_sigmas * noise / b.abs()
+            } else {
+                0.0
+            });
+            let verdict = if change.abs() <= threshold {
+                Verdict::Unchanged
+            } else if (change > 0.0) == higher_better {
+                Verdict::Improved
+            } else {
+                Verdict::Regressed
+            };
+            metrics.push(MetricDiff {
+                name: name.to_string(),
+                unit: unit.to_string(),
+                baseline: b,
+                current: c,
+                change_pct: change * 100.0,
+                threshold_pct: threshold * 100.0,
+                verdict,
+            });
+        };
+
+    let lat_noise = combined_error(&base.latency_ms, &current.latency_ms);
+    // Throughput is inversely proportional to mean latency, so it inherits
+    // latency's relative noise.
+    let rel_noise = if base.latency_ms.mean > 0.0 {
+        lat_noise / base.latency_ms.mean
+    } else {
+        0.0
+    };
+
+    push(
+        "throughput",
+        "chars/s",
+        base.chars_per_sec,
+        current.chars_per_sec,
+        rel_noise * base.chars_per_sec,
+        t.relative,
+        true,
+    );
+    push(
+        "audio throughput",
+        "s/s",
+        base.audio_sec_per_sec,
+        current.audio_sec_per_sec,
+        rel_noise * base.audio_sec_per_sec,
+        t.relative,
+        true,
+    );
+    push(
+        "latency mean",
+        "ms",
+        base.latency_ms.mean,
+        current.latency_ms.mean,
+        lat_noise,
+        t.relative,
+        false,
+    );
+    // Tail percentiles rest on few samples, so their noise band is widened.
+    push(
+        "latency p50",
+        "ms",
+        base.latency_ms.p50,
+        current.latency_ms.p50,
+        lat_noise,
+        t.relative,
+        false,
+    );
+    push(
+        "latency p90",
+        "ms",
+        base.latency_ms.p90,
+        current.latency_ms.p90,
+        lat_noise * 2.0,
+        t.relative,
+        false,
+    );
+    push(
+        "latency p99",
+        "ms",
+        base.latency_ms.p99,
+        current.latency_ms.p99,
+        lat_noise * 4.0,
+        t.relative,
+        false,
+    );
+    push(
+        "rtf mean",
+        "",
+        base.rtf.mean,
+        current.rtf.mean,
+        combined_error(&base.rtf, &current.rtf),
+        t.relative,
+        false,
+    );
+
+    // Stage means have no stored spread; use latency's relative noise.
+    for ((name, b), (_, c)) in base.stages.named().into_iter().zip(current.stages.named()) {
+        push(
+            &format!("stage {name}"),
+            "ms",
+            b,
+            c,
+            rel_noise * b,
+            t.relative,
+            false,
+        );
+    }
+
+    if let (Some(b), Some(c)) = (base.peak_rss_bytes, current.peak_rss_bytes) {
+        let mib = |x: u64| x as f64 / (1024.0 * 1024.0);
+        push(
+            "peak rss",
+            "MiB",
+            mib(b),
+            mib(c),
+            0.0,
+            t.rss_relative,
+            false,
+        );
+    }
+
+    Comparison {
+        baseline_label: base.label.clone(),
+        current_label: current.label.clone(),
+        metrics,
+    }
+}
+
+fn combined_error(a: &Distribution, b: &Distribution) -> f64 {
+    (a.std_error().powi(2) + b.std_error().powi(2)).sqrt()
+}
+
+impl fmt::Display for Comparison {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        writeln!(
+            f,
+            "baseline: {}   current: {}",
+            self.baseline_label, self.current_label
+        )?;
+        writeln!(
+            f,
+            "{:<18} {:>12} {:>12} {:>9} {:>8}  {}",
+            "metric", "baseline", "current", "change", "±thresh", "verdict"
+        )?;
+        for m in &self.metrics {
+            let verdict = match m.verdict {
+                Verdict::Improved => "improved",
+                Verdict::Unchanged => "",
+                Verdict::Regressed => "REGRESSED",
+            };
+            writeln!(
+                f,
+                "{:<18} {:>12} {:>12} {:>+8.1}% {:>7.1}%  {}",
+                m.name,
+                format!("{:.3} {}", m.baseline, m.unit).trim_end(),
+                format!("{:.3} {}", m.current, m.unit).trim_end(),
+                m.change_pct,
+                m.threshold_pct,
+                verdict
+            )?;
+        }
+        let regressed = self
+            .metrics
+            .iter()
+            .filter(|m| m.verdict == Verdict::Regressed)
+            .count();
+        let improved = self
+            .metrics
+            .iter()
+            .filter(|m| m.verdict == Verdict::Improved)
+            .count();
+        write!(
+            f,
+            "{regressed} regressed, {improved} improved, {} unchanged",
+            self.metrics.len() - regressed - improved
+        )
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tests
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn baseline(latencies: &[f64]) -> Baseline {
+        let mut r = Recorder::new();
+        for &ms in latencies {
+            let mut stats = GenerationStats {
+                chunks: 1,
+                samples: crate::model::SAMPLE_RATE as usize,
+                ..Default::default()
+            };
+            stats.total.time = Duration::from_secs_f64(ms / 1_000.0);
+            stats.inference.time = Duration::from_secs_f64(ms / 2_000.0);
+            r.record(40, &stats);
+        }
+        let mut b = r.finish("test");
+        b.peak_rss_bytes = Some(100 << 20);
+        b
+    }
+
+    #[test]
+    fn test_distribution_percentiles() {
+        let values: Vec<f64> = (1..=100).map(f64::from).collect();
+        let d = Distribution::from_values(&values);
+        assert_eq!(d.samples, 100);
+        assert_eq!(
+            (d.min, d.p50, d.p90, d.p99, d.max),
+            (1.0, 50.0, 90.0, 99.0, 100.0)
+        );
+        assert!((d.mean - 50.5).abs() < 1e-9);
+        assert_eq!(Distribution::from_values(&[]), Distribution::default());
+    }
+
+    #[test]
+    fn test_identical_runs_unchanged() {
+        let b = baseline(&[100.0, 102.0, 98.0, 101.0, 99.0]);
+        let cmp = compare(&b, &b, &Thresholds::default());
+        assert!(!cmp.has_regressions());
+        assert!(
+            cmp.metrics.iter().all(|m| m.verdict == Verdict::Unchanged),
+            "{cmp}"
+        );
+    }
+
+    #[test]
+    fn test_slowdown_is_regression() {
+        let b = baseline(&[100.0, 102.0, 98.0, 101.0, 99.0]);
+        let c = baseline(&[150.0, 152.0, 148.0, 151.0, 149.0]);
+        let cmp = compare(&b, &c, &Thresholds::default());
+        assert!(cmp.has_regressions());
+        let mean = cmp
+            .metrics
+            .iter()
+            .find(|m| m.name == "latency mean")
+            .unwrap();
+        assert_eq!(mean.verdict, Verdict::Regressed);
+        let tput = cmp.metrics.iter().find(|m| m.name == "throughput").unwrap();
+        assert_eq!(tput.verdict, Verdict::Regressed);
+        // The reverse direction is an improvement.
+        assert!(!compare(&c, &b, &Thresholds::default()).has_regressions());
+    }
+
+    #[test]
+    fn test_noisy_runs_widen_threshold() {
+        // 8 % slower on average, but the spread is far larger than that.
+        let b = baseline(&[50.0, 150.0, 60.0, 140.0]);
+        let c = baseline(&[54.0, 162.0, 65.0, 151.0]);
+        let cmp = compare(&b, &c, &Thresholds::default());
+        let mean = cmp
+            .metrics
+            .iter()
+            .find(|m| m.name == "latency mean")
+            .unwrap();
+        assert_eq!(mean.verdict, Verdict::Unchanged, "{cmp}");
+        assert!(mean.threshold_pct > 8.0);
+    }
+
+    #[test]
+    fn test_json_round_trip() {
+        let b = baseline(&[10.0, 11.0]);
+        let path = std::env::temp_dir().join("kittentts_baseline_round_trip.json");
+        b.save(&path).unwrap();
+        let loaded = Baseline::load(&path).unwrap();
+        assert_eq!((loaded.label.as_str(), loaded.utterances), ("test", 2));
+        assert!((loaded.latency_ms.mean - b.latency_ms.mean).abs() < 1e-9);
+        let _ = std::fs::remove_file(&path);
+    }
+}
@@ -0,0 +1,104 @@
+//! Pack, unpack and inspect `.kitten` single-file model bundles.
+//!
+//! # Usage
+//!
+//! ```bash
+//! cargo run --release --bin kittentts-bundle --features bundle-cli -- \
+//!     pack --model kitten_tts_mini_v0_8.onnx --voices voices.npz \
+//!          --config config.json -o mini.kitten
+//! cargo run --release --bin kittentts-bundle --features bundle-cli -- info mini.kitten
+//! cargo run --release --bin kittentts-bundle --features bundle-cli -- unpack mini.kitten -o out/
+//! ```
+//!
+//! `unpack` writes `model.onnx`, `voices.npz` and `config.json`, which load
+//! again with [`kittentts::model::KittenTtsOnnx::load`].  See `src/bundle.rs`
+//! for the file layout.
+
+use std::path::PathBuf;
+
+use anyhow::Result;
+use clap::{Parser, Subcommand};
+
+use kittentts::bundle::{self, Bundle};
+
+// ─── CLI ────────────────────────────────────────────────────────────────────
+
+#[derive(Parser)]
+#[command(name = "kittentts-bundle")]
+#[command(about = "Pack and unpack KittenTTS .kitten model bundles")]
+struct Cli {
+    #[command(subcommand)]
+    command: Command,
+}
+
+#[derive(Subcommand)]
+enum Command {
+    /// Pack an ONNX model, a voices .npz and config.json into one bundle.
+    Pack {
+        /// ONNX model file.
+        #[arg(long)]
+        model: PathBuf,
+        /// Voice embeddings (.npz).
+        #[arg(long)]
+        voices: PathBuf,
+        /// HuggingFace-style config.json (speed priors, voice aliases).
+        #[arg(long)]
+        config: Option<PathBuf>,
+        /// Output bundle.
+        #[arg(short, long)]
+        out: PathBuf,
+    },
+    /// Write a bundle back out as model.onnx, voices.npz and config.json.
+    Unpack {
+        bundle: PathBuf,
+        /// Output directory (created if missing).
+        #[arg(short, long)]
+        out: PathBuf,
+    },
+    /// Print a bundle's header and section table.
+    Info { bundle: PathBuf },
+}
+
+// ─── Main ───────────────────────────────────────────────────────────────────
+
+fn main() -> Result<()> {
+    match Cli::parse().command {
+        Command::Pack { model, voices, config, out } => {
+            bundle::pack(&model, &voices, config.as_deref(), &out)?;
+            let b = Bundle::open(&out)?;
+            eprintln!(
+                "Packed {} voice(s), {} model bytes into {}",
+                b.voices().len(),
+                b.model_bytes().len(),
+                out.display()
+            );
+        }
+        Command::Unpack { bundle: path, out } => {
+            bundle::unpack(&path, &out)?;
+            eprintln!("Unpacked {} into {}", path.display(), out.display());
+        }
+        Command::Info { bundle: path } => {
+            let b = Bundle::open(&path)?;
+            println!("model_type    {}", b.model_type());
+            println!("model bytes   {}", b.model_bytes().len());
+            let mut priors: Vec<_> = b.speed_priors().iter().collect();
+            priors.sort_by(|a, b| a.0.cmp(b.0));
+            for (voice, prior) in priors {
+                println!("speed prior   {voice} = {prior}");
+            }
+            let mut aliases: Vec<_> = b.voice_aliases().iter().collect();
+            aliases.sort();
+            for (alias, voice) in aliases {
+                println!("alias         {alias} -> {voice}");
+            }
+            println!("{:<24} {:>10} {:>6} {:>6} {:>8}", "voice", "offset", "rows", "cols", "stride");
+            for v in b.voices() {
+                println!(
+                    "{:<24} {:>10} {:>6} {:>6} {:>8}",
+                    v.name, v.offset, v.rows, v.cols, v.row_stride
+                );
+            }
+        }
+    }
+    Ok(())
+}
@@ -0,0 +1,203 @@
+//! Performance baseline capture and comparison.
+//!
+//! Records throughput, latency percentiles, RTF, peak RSS and per-stage
+//! times over the reference corpus into a JSON file, and compares a later
+//! run against it with noise-aware thresholds (see `src/baseline.rs`).
+//!
+//! # Usage
+//!
+//! ```bash
+//! cargo run --release --bin kittentts-perf --features perf -- record --out base.json
+//! # … change code …
+//! cargo run --release --bin kittentts-perf --features perf -- compare base.json
+//! ```
+//!
+//! `compare` runs the corpus again (or reads `--current FILE`), prints a
+//! per-metric diff and exits with status 1 when any metric regressed.
+//!
+//! Model files are found the same way as the integration tests:
+//! `--model-dir`, then `$KITTENTTS_MODEL_DIR`, then the iOS / Android bundled
+//! model directories.  `--hub REPO` downloads from HuggingFace instead.
+
+use std::path::PathBuf;
+
+use anyhow::{Context, Result};
+use clap::{Args, Parser, Subcommand};
+
+use kittentts::{
+    baseline::{self, Baseline, Thresholds},
+    download, KittenTTS,
+};
+
+#[path = "../../benches/common/mod.rs"]
+mod common;
+
+// ─── CLI ────────────────────────────────────────────────────────────────────
+
+#[derive(Parser)]
+#[command(name = "kittentts-perf")]
+#[command(about = "Record and compare KittenTTS performance baselines")]
+struct Cli {
+    #[command(subcommand)]
+    command: Command,
+}
+
+#[derive(Subcommand)]
+enum Command {
+    /// Run the corpus and write a baseline JSON file.
+    Record {
+        /// Output file.
+        #[arg(long)]
+        out: PathBuf,
+        #[command(flatten)]
+        run: RunArgs,
+    },
+    /// Compare a run against a saved baseline.
+    Compare {
+        /// Baseline file written by `record`.
+        baseline: PathBuf,
+        /// Compare this saved run instead of running the corpus again.
+        #[arg(long)]
+        current: Option<PathBuf>,
+        /// Also save the fresh run here.
+        #[arg(long)]
+        save: Option<PathBuf>,
+        /// Minimum relative change to report, in percent.
+        #[arg(long, default_value_t = 5.0)]
+        threshold: f64,
+        /// Change must also exceed this many standard errors of the noise.
+        #[arg(long, default_value_t = 3.0)]
+        sigmas: f64,
+        /// Relative threshold for peak RSS, in percent.
+        #[arg(long, default_value_t = 10.0)]
+        rss_threshold: f64,
+        /// Print the comparison as JSON instead of a table.
+        #[arg(long)]
+        json: bool,
+        #[command(flatten)]
+        run: RunArgs,
+    },
+}
+
+#[derive(Args)]
+struct RunArgs {
+    /// Directory containing kitten_tts_mini_v0_8.onnx and voices.npz.
+    #[arg(long)]
+    model_dir: Option<PathBuf>,
+    /// HuggingFace repository to download the model from instead.
+    #[arg(long, conflicts_with = "model_dir")]
+    hub: Option<String>,
+    /// Voice to synthesise with (default: the model's first voice).
+    #[arg(long)]
+    voice: Option<String>,
+    /// Text file with one utterance per line (default: built-in corpus).
+    #[arg(long)]
+    corpus: Option<PathBuf>,
+    /// Timed passes over the corpus.
+    #[arg(long, default_value_t = 5)]
+    iterations: usize,
+    /// Untimed passes before measuring.
+    #[arg(long, default_value_t = 1)]
+    warmup: usize,
+    /// Label stored in the baseline (default: model source).
+    #[arg(long)]
+    label: Option<String>,
+}
+
+// ─── Running ────────────────────────────────────────────────────────────────
+
+fn run(args: &RunArgs) -> Result<Baseline> {
+    let (tts, source) = if let Some(repo) = &args.hub {
+        (download::load_from_hub(repo)?, repo.clone())
+    } else {
+        let dir = args.model_dir.clone().or_else(common::model_dir).context(
+            "Model directory not found; pass --model-dir, set KITTENTTS_MODEL_DIR or use --hub",
+        )?;
+        let tts = KittenTTS::load(
+            &dir.join("kitten_tts_mini_v0_8.onnx"),
+            &dir.join("voices.npz"),
+            Default::default(),
+            Default::default(),
+        )?;
+        (tts, dir.display().to_string())
+    };
+
+    let voice = match &args.voice {
+        Some(v) => v.clone(),
+        None => tts.available_voices.first().context("Model has no voices")?.clone(),
+    };
+
+    let owned: Vec<String>;
+    let corpus: Vec<&str> = match &args.corpus {
+        Some(path) => {
+            let text = std::fs::read_to_string(path)
+                .with_context(|| format!("Cannot read corpus {}", path.display()))?;
+            owned = text.lines().filter(|l| !l.trim().is_empty()).map(str::to_owned).collect();
+            owned.iter().map(String::as_str).collect()
+        }
+        None => baseline::REFERENCE_CORPUS.to_vec(),
+    };
+
+    eprintln!(
+        "Running {} utterances × {} iterations (voice {voice}, {} warm-up)...",
+        corpus.len(),
+        args.iterations,
+        args.warmup
+    );
+    let label = args.label.clone().unwrap_or(source);
+    baseline::record_corpus(&tts, &corpus, &voice, args.iterations, args.warmup, label)
+}
+
+fn summary(b: &Baseline) -> String {
+    format!(
+        "{} utterances: {:.0} chars/s, latency p50 {:.1} ms / p99 {:.1} ms, RTF {:.3}",
+        b.utterances, b.chars_per_sec, b.latency_ms.p50, b.latency_ms.p99, b.rtf.mean
+    )
+}
+
+// ─── Main ───────────────────────────────────────────────────────────────────
+
+fn main() -> Result<()> {
+    match Cli::parse().command {
+        Command::Record { out, run: args } => {
+            let b = run(&args)?;
+            b.save(&out)?;
+            eprintln!("{}", summary(&b));
+            eprintln!("Baseline written to {}", out.display());
+        }
+        Command::Compare {
+            baseline: base_path,
+            current,
+            save,
+            threshold,
+            sigmas,
+            rss_threshold,
+            json,
+            run: args,
+        } => {
+            let base = Baseline::load(&base_path)?;
+            let cur = match current {
+                Some(path) => Baseline::load(&path)?,
+                None => run(&args)?,
+            };
+            if let Some(path) = save {
+                cur.save(&path)?;
+            }
+            let thresholds = Thresholds {
+                relative: threshold / 100.0,
+                noise_sigmas: sigmas,
+                rss_relative: rss_threshold / 100.0,
+            };
+            let cmp = baseline::compare(&base, &cur, &thresholds);
+            if json {
+                println!("{}", serde_json::to_string_pretty(&cmp)?);
+            } else {
+                println!("{cmp}");
+            }
+            if cmp.has_regressions() {
+                std::process::exit(1);
+            }
+        }
+    }
+    Ok(())
+}
@@ -18,6 +18,27 @@
 //!   -d '{"model":"tts-1","input":"Hello!","voice":"alloy"}' \
 //!   --output output.mp3
 //! ```
+//!
+//! # Profiling
+//!
+//! Set `KITTENTTS_TRACE=/path/to/trace.json` to record every request as a
+//! Chrome trace (open in `chrome://tracing` or <https://ui.perfetto.dev>).
+//! The file is flushed on shutdown.
+//!
+//! With the `pprof` feature and `--pprof-token` (or `$KITTENTTS_PPROF_TOKEN`)
+//! set, `GET /debug/pprof/profile?seconds=N` samples every thread of the
+//! process — HTTP workers, inference threads and ORT's intra-op pool — for
+//! `N` seconds and returns a pprof protobuf (`go tool pprof`) or, with
+//! `&format=svg`, a flamegraph:
+//!
+//! ```bash
+//! curl -H "Authorization: Bearer $TOKEN" \
+//!   'http://localhost:8080/debug/pprof/profile?seconds=10' -o cpu.pb
+//! go tool pprof -http=:0 cpu.pb
+//! ```
+//!
+//! Without a token the route is not mounted, and no sampler runs outside a
+//! profiling request.
 
 use std::sync::Arc;
 
@@ -32,7 +53,11 @@ use clap::Parser;
 use serde::{Deserialize, Serialize};
 use tower_http::cors::CorsLayer;
 
-use kittentts::{download, AudioFormat, EncoderFactory, KittenTTS, SAMPLE_RATE};
+use kittentts::{
+    autotune::{self, AutotuneOptions},
+    download, model::LoadOptions, profiling::ProfilingOptions, AudioFormat, EncoderFactory,
+    KittenTTS, SAMPLE_RATE,
+};
 
 // ─── CLI ────────────────────────────────────────────────────────────────────
 
@@ -55,6 +80,37 @@ struct Args {
     /// Default audio output format (mp3, wav, opus, flac, pcm)
     #[arg(long, default_value = "mp3")]
     default_format: String,
+
+    /// Enable ONNX Runtime's per-operator profiler; the trace is written to
+    /// `<PREFIX>_<timestamp>.json` with a per-op summary next to it.
+    #[arg(long, value_name = "PREFIX")]
+    ort_profile: Option<std::path::PathBuf>,
+
+    /// Number of inference runs to profile before the profiler stops.
+    #[arg(long, default_value_t = 20, requires = "ort_profile")]
+    ort_profile_runs: usize,
+
+    /// ONNX Runtime execution provider: cpu, or xnnpack (requires the
+    /// `xnnpack` feature).  Nodes XNNPACK cannot run fall back to cpu.
+    #[arg(long, default_value = "cpu")]
+    execution_provider: String,
+
+    /// Inference threads (ORT intra-op, or XNNPACK's pool); default: one
+    /// per core.
+    #[arg(long)]
+    threads: Option<usize>,
+
+    /// Measure session-pool / thread splits at startup and keep the best
+    /// for `latency` or `throughput`.  The choice is cached per CPU, model
+    /// and execution provider in `~/.cache/kittentts/autotune.json`.
+    #[arg(long, value_name = "OBJECTIVE", conflicts_with = "threads")]
+    autotune: Option<String>,
+
+    /// Bearer token that enables `/debug/pprof/profile` (requires the
+    /// `pprof` feature).  The endpoint is not mounted when unset; an empty
+    /// or blank token is rejected.
+    #[arg(long, env = "KITTENTTS_PPROF_TOKEN", hide_env_values = true)]
+    pprof_token: Option<String>,
 }
 
 // ─── Shared state ───────────────────────────────────────────────────────────
@@ -63,6 +119,8 @@ struct AppState {
     tts: KittenTTS,
     model_id: String,
     default_format: String,
+    #[cfg(feature = "pprof")]
+    pprof: pprof_endpoint::PprofState,
 }
 
 // ─── OpenAI API types ───────────────────────────────────────────────────────
@@ -290,6 +348,154 @@ async fn health() -> &'static str {
     "ok"
 }
 
+// ─── CPU profiling (pprof feature) ──────────────────────────────────────────
+
+#[cfg(feature = "pprof")]
+mod pprof_endpoint {
+    use std::{
+        sync::{
+            atomic::{AtomicBool, Ordering},
+            Arc,
+        },
+        time::Duration,
+    };
+
+    use axum::{
+        extract::{Query, State},
+        http::{header, HeaderMap, StatusCode},
+        response::IntoResponse,
+        Json,
+    };
+    use serde::Deserialize;
+
+    use super::{bad_request, server_error, AppState, ErrorDetail, ErrorResponse};
+
+    /// Sampling frequency in Hz.  99 rather than 100 avoids lock-step with
+    /// periodic work.
+    const FREQUENCY_HZ: i32 = 99;
+    const MAX_SECONDS: u64 = 120;
+
+    pub struct PprofState {
+        token: String,
+        /// Only one profile can run at a time (the sampler is process-wide).
+        busy: AtomicBool,
+    }
+
+    impl PprofState {
+        pub fn new(token: String) -> Self {
+            Self { token, busy: AtomicBool::new(false) }
+        }
+    }
+
+    #[derive(Deserialize)]
+    pub struct ProfileQuery {
+        seconds: Option<u64>,
+        /// `pb` (default) or `svg`.
+        format: Option<String>,
+    }
+
+    type ApiError = (StatusCode, Json<ErrorResponse>);
+
+    fn error(status: StatusCode, kind: &str, msg: &str) -> ApiError {
+        (
+            status,
+            Json(ErrorResponse {
+                error: ErrorDetail {
+                    message: msg.to_string(),
+                    error_type: kind.to_string(),
+                    code: None,
+                },
+            }),
+        )
+    }
+
+    /// Constant-time comparison so the token cannot be guessed byte by byte.
+    fn token_matches(given: &str, expected: &str) -> bool {
+        given.len() == expected.len()
+            && given.bytes().zip(expected.bytes()).fold(0u8, |acc, (a, b)| acc | (a ^ b)) == 0
+    }
+
+    /// Clears the busy flag when the profile finishes or the task panics.
+    struct BusyGuard<'a>(&'a AtomicBool);
+
+    impl Drop for BusyGuard<'_> {
+        fn drop(&mut self) {
+            self.0.store(false, Ordering::Release);
+        }
+    }
+
+    pub async fn profile_handler(
+        State(state): State<Arc<AppState>>,
+        headers: HeaderMap,
+        Query(q): Query<ProfileQuery>,
+    ) -> Result<impl IntoResponse, ApiError> {
+        let pprof = &state.pprof;
+        let authorized = headers
+            .get(header::AUTHORIZATION)
+            .and_then(|v| v.to_str().ok())
+            .and_then(|v| v.strip_prefix("Bearer "))
+            .is_some_and(|t| token_matches(t, &pprof.token));
+        if !authorized {
+            return Err(error(
+                StatusCode::UNAUTHORIZED,
+                "authentication_error",
+                "Missing or invalid bearer token.",
+            ));
+        }
+
+        let seconds = q.seconds.unwrap_or(30);
+        if !(1..=MAX_SECONDS).contains(&seconds) {
+            return Err(bad_request(format!("seconds must be between 1 and {MAX_SECONDS}.")));
+        }
+        let svg = match q.format.as_deref() {
+            None | Some("pb") | Some("proto") => false,
+            Some("svg") | Some("flamegraph") => true,
+            Some(other) => {
+                return Err(bad_request(format!("Unsupported format '{other}'. Supported: pb, svg.")))
+            }
+        };
+
+        if pprof.busy.swap(true, Ordering::AcqRel) {
+            return Err(error(
+                StatusCode::CONFLICT,
+                "conflict_error",
+                "A profile is already being taken.",
+            ));
+        }
+        eprintln!("GET /debug/pprof/profile seconds={seconds} format={}", if svg { "svg" } else { "pb" });
+
+        // The sampler uses SIGPROF, which the kernel delivers to whichever
+        // thread is running — inference and ORT threads included.  Run it
+        // on a blocking thread so the async workers stay free to be sampled.
+        let state = Arc::clone(&state);
+        let bytes = tokio::task::spawn_blocking(move || -> anyhow::Result<Vec<u8>> {
+            let _busy = BusyGuard(&state.pprof.busy);
+            let guard = pprof::ProfilerGuardBuilder::default()
+                .frequency(FREQUENCY_HZ)
+                .blocklist(&["libc", "libgcc", "pthread", "vdso"])
+                .build()?;
+            std::thread::sleep(Duration::from_secs(seconds));
+            let report = guard.report().build()?;
+            drop(guard);
+
+            let mut body = Vec::new();
+            if svg {
+                report.flamegraph(&mut body)?;
+            } else {
+                use pprof::protos::Message;
+                report.pprof()?.encode(&mut body)?;
+            }
+            Ok(body)
+        })
+        .await
+        .map_err(|e| server_error(format!("Profiler task panicked: {e}")))?
+        .map_err(|e| server_error(format!("Profiling failed: {e}")))?;
+
+        let content_type = if svg { "image/svg+xml" } else { "application/octet-stream" };
+        Ok(([(header::CONTENT_TYPE, content_type)], bytes))
+    }
+}
+
 // ─── Main ───────────────────────────────────────────────────────────────────
 
 async fn shutdown_signal() {
@@ -301,6 +507,12 @@ async fn shutdown_signal() {
 async fn main() -> anyhow::Result<()> {
     let args = Args::parse();
 
+    // Keep the guard alive for the whole run; dropping it flushes the trace.
+    let _trace = kittentts::trace::init_from_env()?;
+    if let (Some(_), Some(path)) = (&_trace, std::env::var_os(kittentts::trace::TRACE_ENV)) {
+        eprintln!("Chrome trace enabled: {}", path.to_string_lossy());
+    }
+
     // Validate default format
     if AudioFormat::from_str_openai(&args.default_format).is_none() {
         anyhow::bail!(
@@ -309,26 +521,79 @@ async fn main() -> anyhow::Result<()> {
         );
     }
 
-    eprintln!("Loading model {}...", args.model);
-    let tts = download::load_from_hub(&args.model)?;
+    // An empty token would mount the profiler behind `Bearer ` alone.
+    if args.pprof_token.as_deref().is_some_and(|t| t.trim().is_empty()) {
+        anyhow::bail!("--pprof-token / KITTENTTS_PPROF_TOKEN must not be empty.");
+    }
+    #[cfg(not(feature = "pprof"))]
+    if args.pprof_token.is_some() {
+        anyhow::bail!("--pprof-token requires the `pprof` Cargo feature.");
+    }
+
+    let mut options = LoadOptions {
+        profiling: args
+            .ort_profile
+            .as_ref()
+            .map(|prefix| ProfilingOptions::new(prefix, args.ort_profile_runs)),
+        execution_provider: args.execution_provider.parse()?,
+        intra_threads: args.threads,
+        ..Default::default()
+    };
+    if let Some(objective) = &args.autotune {
+        let tune = AutotuneOptions {
+            objective: objective.parse()?,
+            model_id: args.model.clone(),
+            cache_path: autotune::default_cache_path(),
+            ..Default::default()
+        };
+        eprintln!("Auto-tuning sessions × threads for {}...", tune.objective.name());
+        let tuning = autotune::tune(|o| download::load_from_hub_with(&args.model, o), &options, &tune)?;
+        eprintln!(
+            "Using {} sessions × {} threads{}",
+            tuning.chosen.sessions,
+            tuning.chosen.intra_threads,
+            if tuning.cached { " (cached)" } else { "" }
+        );
+        options = tuning.chosen.apply(options);
+    }
+
+    eprintln!(
+        "Loading model {} ({} execution provider)...",
+        args.model,
+        options.execution_provider.name()
+    );
+    let tts = download::load_from_hub_with(&args.model, &options)?;
     eprintln!(
         "Model loaded. Available voices: {:?}",
         tts.available_voices
     );
 
+    #[cfg(feature = "pprof")]
+    let pprof_enabled = args.pprof_token.is_some();
+
     let state = Arc::new(AppState {
         tts,
         model_id: args.model,
         default_format: args.default_format,
+        #[cfg(feature = "pprof")]
+        pprof: pprof_endpoint::PprofState::new(args.pprof_token.clone().unwrap_or_default()),
     });
 
     let app = Router::new()
         .route("/v1/audio/speech", post(speech_handler))
         .route("/v1/models", get(list_models))
         .route("/v1/voices", get(list_voices))
-        .route("/health", get(health))
+        .route("/health", get(health));
+    #[cfg(feature = "pprof")]
+    let app = if pprof_enabled {
+        eprintln!("CPU profiling enabled at /debug/pprof/profile");
+        app.route("/debug/pprof/profile", get(pprof_endpoint::profile_handler))
+    } else {
+        app
+    };
+    let app = app
         .layer(CorsLayer::permissive())
-        .with_state(state);
+        .with_state(Arc::clone(&state));
 
     let addr = format!("{}:{}", args.host, args.port);
     let listener = tokio::net::TcpListener::bind(&addr).await?;
@@ -338,5 +603,10 @@ async fn main() -> anyhow::Result<()> {
         .with_graceful_shutdown(shutdown_signal())
         .await?;
 
+    // Flush a profiling window that did not reach its run budget.
+    if args.ort_profile.is_some() && state.tts.profile_report().is_none() {
+        state.tts.finish_profiling();
+    }
+
     Ok(())
 }
@@ -0,0 +1,400 @@
+//! `.kitten` single-file model bundles.
+//!
+//! A bundle carries everything [`KittenTtsOnnx::load_bundle`] needs — model
+//! type, speed priors, voice aliases, the ONNX graph and every voice matrix —
+//! in one file that is opened with a single `mmap`.  The ONNX bytes are handed
+//! to ORT straight from the mapping and voice rows are read in place, so
+//! startup parses no separate JSON files and inflates no ZIP, and processes
+//! loading the same bundle share its pages.
+//!
+//! ## Layout (all integers little-endian)
+//!
+//! ```text
+//! 0      magic  b"KITTEN\0\x01"
+//! 8      u64    header length H
+//! 16     H bytes of JSON header (config, section table)
+//! …      zero padding to a 64-byte boundary  ← data area start
+//!        ONNX model                           (data offset 0)
+//!        voice matrices, each 64-byte aligned, f32 rows `row_stride` apart
+//! ```
+//!
+//! Section offsets in the header are relative to the data area, so the
+//! header never depends on its own length.
+//!
+//! [`KittenTtsOnnx::load_bundle`]: crate::model::KittenTtsOnnx::load_bundle
+
+use std::{
+    collections::HashMap,
+    fs::File,
+    io::{BufWriter, Write},
+    path::Path,
+    sync::Arc,
+};
+
+use anyhow::{bail, ensure, Context, Result};
+use serde::{Deserialize, Serialize};
+
+use crate::{
+    mmap::Mmap,
+    npz::{load_npz, NpyArray},
+};
+
+/// First eight bytes of every bundle; the last byte is the format version.
+pub const MAGIC: &[u8; 8] = b"KITTEN\0\x01";
+
+/// Alignment of the data area, the model and every voice matrix.
+const ALIGN: usize = 64;
+
+fn align_up(n: usize) -> usize {
+    n.div_ceil(ALIGN) * ALIGN
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Header
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[derive(Debug, Clone, Copy, Serialize, Deserialize)]
+struct Section {
+    offset: u64,
+    len: u64,
+}
+
+/// One voice matrix in the data area.
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct VoiceSection {
+    pub name: String,
+    pub offset: u64,
+    pub rows: u64,
+    pub cols: u64,
+    /// Bytes from one row to the next (≥ `cols * 4`).
+    pub row_stride: u64,
+}
+
+#[derive(Debug, Serialize, Deserialize)]
+struct Header {
+    model_type: String,
+    #[serde(default)]
+    speed_priors: HashMap<String, f32>,
+    #[serde(default)]
+    voice_aliases: HashMap<String, String>,
+    model: Section,
+    voices: Vec<VoiceSection>,
+}
+
+/// The parts of a repository `config.json` a bundle keeps.
+#[derive(Debug, Deserialize)]
+struct PackConfig {
+    #[serde(rename = "type", default = "default_model_type")]
+    model_type: String,
+    #[serde(default)]
+    speed_priors: HashMap<String, f32>,
+    #[serde(default)]
+    voice_aliases: HashMap<String, String>,
+}
+
+fn default_model_type() -> String {
+    "ONNX1".into()
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Reading
+// ─────────────────────────────────────────────────────────────────────────────
+
+/// A validated, memory-mapped bundle.
+pub struct Bundle {
+    map: Arc<Mmap>,
+    header: Header,
+    data_start: usize,
+}
+
+impl Bundle {
+    /// Map `path` and validate its header and section table.
+    pub fn open(path: &Path) -> Result<Self> {
+        let file = File::open(path)
+            .with_context(|| format!("Cannot open bundle: {}", path.display()))?;
+        let map = Mmap::map_file(&file)
+            .with_context(|| format!("Cannot map bundle: {}", path.display()))?;
+        Self::from_map(Arc::new(map))
+            .with_context(|| format!("Invalid bundle: {}", path.display()))
+    }
+
+    fn from_map(map: Arc<Mmap>) -> Result<Self> {
+        ensure!(map.len() >= 16 && &map[..8] == MAGIC, "not a .kitten bundle (bad magic)");
+        let header_len = usize::try_from(u64::from_le_bytes(map[8..16].try_into().unwrap()))?;
+        let header_end = 16usize.checked_add(header_len).filter(|&e| e <= map.len());
+        let Some(header_end) = header_end else { bail!("header runs past end of file") };
+        let header: Header =
+            serde_json::from_slice(&map[16..header_end]).context("Failed to parse bundle header")?;
+        let data_start = align_up(header_end);
+
+        let in_bounds = |offset: u64, len: u64| {
+            (data_start as u64)
+                .checked_add(offset)
+                .and_then(|start| start.checked_add(len))
+                .is_some_and(|end| end <= map.len() as u64)
+        };
+        ensure!(in_bounds(header.model.offset, header.model.len), "model section out of bounds");
+        for v in &header.voices {
+            ensure!(
+                v.offset % ALIGN as u64 == 0
+                    && v.rows > 0
+                    && v.cols > 0
+                    && v.row_stride % 4 == 0
+                    && v.row_stride >= v.cols * 4,
+                "bad layout for voice '{}'",
+                v.name
+            );
+            let len = v.rows.checked_mul(v.row_stride);
+            ensure!(len.is_some_and(|len| in_bounds(v.offset, len)), "voice '{}' out of bounds", v.name);
+        }
+        Ok(Self { map, header, data_start })
+    }
+
+    /// The serialized ONNX model, borrowed from the mapping.
+    pub fn model_bytes(&self) -> &[u8] {
+        let start = self.data_start + self.header.model.offset as usize;
+        &self.map[start..start + self.header.model.len as usize]
+    }
+
+    pub fn model_type(&self) -> &str {
+        &self.header.model_type
+    }
+
+    pub fn speed_priors(&self) -> &HashMap<String, f32> {
+        &self.header.speed_priors
+    }
+
+    pub fn voice_aliases(&self) -> &HashMap<String, String> {
+        &self.header.voice_aliases
+    }
+
+    pub fn voices(&self) -> &[VoiceSection] {
+        &self.header.voices
+    }
+
+    /// The whole mapping, shared with voices that read rows in place.
+    pub(crate) fn map(&self) -> &Arc<Mmap> {
+        &self.map
+    }
+
+    /// Offset of `voice`'s first row within [`map`](Self::map).
+    pub(crate) fn voice_start(&self, voice: &VoiceSection) -> usize {
+        self.data_start + voice.offset as usize
+    }
+
+    /// Copy `voice`'s matrix out as flat row-major `f32`s.
+    pub fn read_voice(&self, voice: &VoiceSection) -> Vec<f32> {
+        let (cols, stride) = (voice.cols as usize, voice.row_stride as usize);
+        let start = self.voice_start(voice);
+        (0..voice.rows as usize)
+            .flat_map(|r| self.map[start + r * stride..][..cols * 4].chunks_exact(4))
+            .map(|b| f32::from_le_bytes(b.try_into().unwrap()))
+            .collect()
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Writing
+// ─────────────────────────────────────────────────────────────────────────────
+
+/// Pack an ONNX model, a `voices.npz` and an optional repository
+/// `config.json` into a bundle at `out`.
+pub fn pack(model: &Path, voices: &Path, config: Option<&Path>, out: &Path) -> Result<()> {
+    let model_bytes =
+        std::fs::read(model).with_context(|| format!("Cannot read model: {}", model.display()))?;
+    let voices = load_npz(voices)
+        .with_context(|| format!("Cannot load voices: {}", voices.display()))?;
+    let config = match config {
+        Some(path) => {
+            let json = std::fs::read(path)
+                .with_context(|| format!("Cannot read config: {}", path.display()))?;
+            serde_json::from_slice(&json).context("Failed to parse config.json")?
+        }
+        None => PackConfig {
+            model_type: default_model_type(),
+            speed_priors: HashMap::new(),
+            voice_aliases: HashMap::new(),
+        },
+    };
+
+    let file = File::create(out)
+        .with_context(|| format!("Cannot create bundle: {}", out.display()))?;
+    let mut w = BufWriter::new(file);
+    write_bundle(&mut w, &model_bytes, voices, config)?;
+    w.flush()?;
+    Ok(())
+}
+
+fn write_bundle(
+    w: &mut impl Write,
+    model: &[u8],
+    voices: HashMap<String, NpyArray>,
+    config: PackConfig,
+) -> Result<()> {
+    let mut voices: Vec<_> = voices.into_iter().collect();
+    voices.sort_by(|a, b| a.0.cmp(&b.0));
+
+    // ── Layout ───────────────────────────────────────────────────────────────
+    let mut offset = align_up(model.len());
+    let sections = voices
+        .iter()
+        .map(|(name, arr)| {
+            let section = VoiceSection {
+                name: name.clone(),
+                offset: offset as u64,
+                rows: arr.nrows() as u64,
+                cols: arr.ncols() as u64,
+                row_stride: align_up(arr.ncols() * 4) as u64,
+            };
+            offset = align_up(offset + arr.nrows() * section.row_stride as usize);
+            section
+        })
+        .collect();
+    let header = serde_json::to_vec(&Header {
+        model_type: config.model_type,
+        speed_priors: config.speed_priors,
+        voice_aliases: config.voice_aliases,
+        model: Section { offset: 0, len: model.len() as u64 },
+        voices: sections,
+    })?;
+
+    // ── Bytes ────────────────────────────────────────────────────────────────
+    let pad = |len: usize| vec![0u8; align_up(len) - len];
+    w.write_all(MAGIC)?;
+    w.write_all(&(header.len() as u64).to_le_bytes())?;
+    w.write_all(&header)?;
+    w.write_all(&pad(16 + header.len()))?;
+    w.write_all(model)?;
+    w.write_all(&pad(model.len()))?;
+    for (_, arr) in &voices {
+        // Each row is padded to a multiple of ALIGN, so voices stay aligned.
+        let row_pad = pad(arr.ncols() * 4);
+        for r in 0..arr.nrows() {
+            let row: Vec<u8> = arr.row(r).iter().flat_map(|x| x.to_le_bytes()).collect();
+            w.write_all(&row)?;
+            w.write_all(&row_pad)?;
+        }
+    }
+    Ok(())
+}
+
+/// Write the bundle's contents back out as `model.onnx`, `voices.npz` and
+/// `config.json` in `out_dir`.
+pub fn unpack(bundle: &Path, out_dir: &Path) -> Result<()> {
+    let bundle = Bundle::open(bundle)?;
+    std::fs::create_dir_all(out_dir)
+        .with_context(|| format!("Cannot create {}", out_dir.display()))?;
+
+    std::fs::write(out_dir.join("model.onnx"), bundle.model_bytes())?;
+
+    let npz = File::create(out_dir.join("voices.npz"))?;
+    let mut zip = zip::ZipWriter::new(npz);
+    let stored =
+        zip::write::SimpleFileOptions::default().compression_method(zip::CompressionMethod::Stored);
+    for v in bundle.voices() {
+        zip.start_file(format!("{}.npy", v.name), stored)?;
+        zip.write_all(&npy_bytes(v.rows as usize, v.cols as usize, &bundle.read_voice(v)))?;
+    }
+    zip.finish()?;
+
+    let config = serde_json::json!({
+        "type": bundle.model_type(),
+        "model_file": "model.onnx",
+        "voices": "voices.npz",
+        "speed_priors": bundle.speed_priors(),
+        "voice_aliases": bundle.voice_aliases(),
+    });
+    std::fs::write(out_dir.join("config.json"), serde_json::to_vec_pretty(&config)?)?;
+    Ok(())
+}
+
+/// A v1.0 `.npy` file holding a little-endian `f32` matrix.
+fn npy_bytes(rows: usize, cols: usize, data: &[f32]) -> Vec<u8> {
+    let mut header =
+        format!("{{'descr': '<f4', 'fortran_order': False, 'shape': ({rows}, {cols}), }}");
+    // Magic (6) + version (2) + length (2) + header + '\n', padded to 64.
+    let total = (10 + header.len() + 1).div_ceil(64) * 64;
+    header.push_str(&" ".repeat(total - 10 - header.len() - 1));
+    header.push('\n');
+
+    let mut out = Vec::with_capacity(total + data.len() * 4);
+    out.extend_from_slice(b"\x93NUMPY\x01\x00");
+    out.extend_from_slice(&(header.len() as u16).to_le_bytes());
+    out.extend_from_slice(header.as_bytes());
+    out.extend(data.iter().flat_map(|x| x.to_le_bytes()));
+    out
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tests
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::npz::parse_npy;
+
+    fn sample_voices() -> HashMap<String, NpyArray> {
+        let arr = |rows: usize, cols: usize, base: f32| NpyArray {
+            shape: vec![rows, cols],
+            data: (0..rows * cols).map(|i| base + i as f32).collect(),
+        };
+        HashMap::from([("b".to_string(), arr(3, 5, 100.0)), ("a".to_string(), arr(2, 256, 0.5))])
+    }
+
+    fn write_sample(path: &Path) {
+        let config = PackConfig {
+            model_type: "ONNX2".into(),
+            speed_priors: HashMap::from([("a".into(), 1.25)]),
+            voice_aliases: HashMap::from([("Alice".into(), "a".into())]),
+        };
+        let mut buf = Vec::new();
+        write_bundle(&mut buf, b"not really onnx", sample_voices(), config).unwrap();
+        std::fs::write(path, buf).unwrap();
+    }
+
+    #[test]
+    fn test_bundle_round_trip() {
+        let path = std::env::temp_dir().join("kittentts_bundle_test.kitten");
+        write_sample(&path);
+
+        let bundle = Bundle::open(&path).unwrap();
+        assert_eq!(bundle.model_bytes(), b"not really onnx");
+        assert_eq!(bundle.model_type(), "ONNX2");
+        assert_eq!(bundle.speed_priors()["a"], 1.25);
+        assert_eq!(bundle.voice_aliases()["Alice"], "a");
+
+        let expected = sample_voices();
+        let names: Vec<_> = bundle.voices().iter().map(|v| v.name.as_str()).collect();
+        assert_eq!(names, ["a", "b"]);
+        for v in bundle.voices() {
+            assert_eq!(bundle.voice_start(v) % ALIGN, 0);
+            assert_eq!(bundle.read_voice(v), expected[&v.name].data);
+        }
+        let _ = std::fs::remove_file(&path);
+    }
+
+    #[test]
+    fn test_rejects_bad_magic_and_truncation() {
+        let path = std::env::temp_dir().join("kittentts_bundle_bad.kitten");
+        write_sample(&path);
+        let mut bytes = std::fs::read(&path).unwrap();
+
+        bytes.truncate(bytes.len() - 8);
+        std::fs::write(&path, &bytes).unwrap();
+        assert!(Bundle::open(&path).is_err(), "truncated voice section must fail");
+
+        bytes[0] = b'X';
+        std::fs::write(&path, &bytes).unwrap();
+        assert!(Bundle::open(&path).is_err());
+        let _ = std::fs::remove_file(&path);
+    }
+
+    #[test]
+    fn test_npy_bytes_parse_back() {
+        let data = [1.0, -2.0, 3.5, 0.0, 5.0, 6.0];
+        let (shape, parsed) = parse_npy(&npy_bytes(2, 3, &data)).unwrap();
+        assert_eq!(shape, [2, 3]);
+        assert_eq!(parsed, data);
+    }
+}
@@ -2,14 +2,18 @@
 //!
 //! Downloads `config.json`, the ONNX model, and the voices NPZ file from a
 //! HuggingFace repository, then constructs and returns a [`KittenTtsOnnx`].
+//!
+//! Once `config.json` is known the model and voices are fetched
+//! concurrently, and the ONNX session is built while the voices are still
+//! downloading or decoding.  Any [`RepoFetcher`] can stand in for the Hub.
 
 use std::{collections::HashMap, path::PathBuf};
 
 use anyhow::{bail, Context, Result};
-use hf_hub::api::sync::Api;
+use hf_hub::api::sync::{Api, ApiRepo};
 use serde::Deserialize;
 
-use crate::model::KittenTtsOnnx;
+use crate::model::{KittenTtsOnnx, LoadOptions};
 
 // ─────────────────────────────────────────────────────────────────────────────
 // config.json schema
@@ -48,6 +52,33 @@ fn hf_download(api: &Api, repo_id: &str, filename: &str) -> Result<PathBuf> {
         .with_context(|| format!("Failed to download '{}' from '{}'", filename, repo_id))
 }
 
+/// Resolves a repository file to a local path, downloading it if needed.
+///
+/// Called from two threads at once by [`load_from_fetcher`].
+pub trait RepoFetcher: Sync {
+    fn fetch(&self, filename: &str) -> Result<PathBuf>;
+}
+
+impl RepoFetcher for ApiRepo {
+    fn fetch(&self, filename: &str) -> Result<PathBuf> {
+        self.get(filename).with_context(|| format!("Failed to download '{}'", filename))
+    }
+}
+
+fn hub_repo_id(repo_id: &str) -> String {
+    if repo_id.contains('/') {
+        repo_id.to_string()
+    } else {
+        format!("KittenML/{}", repo_id)
+    }
+}
+
+fn read_config(path: &std::path::Path) -> Result<ModelConfig> {
+    let bytes = std::fs::read(path)
+        .with_context(|| format!("Cannot read config: {}", path.display()))?;
+    serde_json::from_slice(&bytes).context("Failed to parse config.json")
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 // Progress reporting
 // ─────────────────────────────────────────────────────────────────────────────
@@ -62,6 +93,10 @@ fn hf_download(api: &Api, repo_id: &str, filename: &str) -> Result<PathBuf> {
 /// | 2/4  | `Fetching { file: "<model>.onnx", … }`    | Fetching / cache-checking model  |
 /// | 3/4  | `Fetching { file: "<voices>.npz", … }`    | Fetching / cache-checking voices |
 /// | 4/4  | `Loading`                                 | Building the ONNX session        |
+///
+/// Steps 2 and 3 are reported together and then run concurrently; `Loading`
+/// follows as soon as the model is available, possibly while the voices are
+/// still downloading.  Events are always delivered on the calling thread.
 #[derive(Debug, Clone)]
 pub enum LoadProgress {
     /// About to fetch (or retrieve from cache) one of the three model files.
@@ -92,27 +127,45 @@ pub enum LoadProgress {
 ///     |p| println!("{p:?}"),
 /// ).unwrap();
 /// ```
-pub fn load_from_hub_cb<F>(repo_id: &str, mut on_progress: F) -> Result<KittenTtsOnnx>
+pub fn load_from_hub_cb<F>(repo_id: &str, on_progress: F) -> Result<KittenTtsOnnx>
 where
     F: FnMut(LoadProgress),
 {
-    let repo_id = if repo_id.contains('/') {
-        repo_id.to_string()
-    } else {
-        format!("KittenML/{}", repo_id)
-    };
+    load_from_hub_cb_with(repo_id, &LoadOptions::default(), on_progress)
+}
 
+/// [`load_from_hub_cb`] with explicit [`LoadOptions`] for the ONNX session.
+pub fn load_from_hub_cb_with<F>(
+    repo_id: &str,
+    options: &LoadOptions,
+    mut on_progress: F,
+) -> Result<KittenTtsOnnx>
+where
+    F: FnMut(LoadProgress),
+{
     let api = Api::new().context("Failed to initialise HuggingFace Hub client")?;
+    let repo_id = hub_repo_id(repo_id);
+    let repo = api.model(repo_id.clone());
+    load_from_fetcher(&repo, options, on_progress)
+        .with_context(|| format!("Failed to load model from '{}'", repo_id))
+}
 
+/// [`load_from_hub_cb_with`] with the files resolved by `fetcher` instead
+/// of the HuggingFace Hub — a mirror, a local directory, or a test double.
+pub fn load_from_fetcher<R, F>(
+    fetcher: &R,
+    options: &LoadOptions,
+    mut on_progress: F,
+) -> Result<KittenTtsOnnx>
+where
+    R: RepoFetcher + ?Sized,
+    F: FnMut(LoadProgress),
+{
     // ── config.json ──────────────────────────────────────────────────────────
     on_progress(LoadProgress::Fetching {
         step: 1, total: 4, file: "config.json".into(),
     });
-    let config_path = hf_download(&api, &repo_id, "config.json")?;
-    let config_bytes = std::fs::read(&config_path)
-        .with_context(|| format!("Cannot read config: {}", config_path.display()))?;
-    let config: ModelConfig = serde_json::from_slice(&config_bytes)
-        .context("Failed to parse config.json")?;
+    let config = read_config(&fetcher.fetch("config.json")?)?;
     if !matches!(config.model_type.as_str(), "ONNX1" | "ONNX2") {
         bail!(
             "Unsupported model type '{}' — expected ONNX1 or ONNX2",
@@ -120,25 +173,26 @@ where
         );
     }
 
-    // ── ONNX model ───────────────────────────────────────────────────────────
+    let ModelConfig { model_file, voices, speed_priors, voice_aliases, .. } = config;
+
+    // ── ONNX model ‖ voices NPZ ─────────────────────────────────────────────
     on_progress(LoadProgress::Fetching {
-        step: 2, total: 4, file: config.model_file.clone(),
+        step: 2, total: 4, file: model_file.clone(),
     });
-    let model_path = hf_download(&api, &repo_id, &config.model_file)?;
-
-    // ── Voices NPZ ───────────────────────────────────────────────────────────
     on_progress(LoadProgress::Fetching {
-        step: 3, total: 4, file: config.voices.clone(),
+        step: 3, total: 4, file: voices.clone(),
     });
-    let voices_path = hf_download(&api, &repo_id, &config.voices)?;
-
-    // ── Build ONNX session ───────────────────────────────────────────────────
-    on_progress(LoadProgress::Loading);
-    KittenTtsOnnx::load(
-        &model_path,
-        &voices_path,
-        config.speed_priors,
-        config.voice_aliases,
+    KittenTtsOnnx::load_concurrent(
+        || {
+            let path = fetcher.fetch(&model_file)?;
+            // ── Build ONNX session (voices may still be in flight) ──────────
+            on_progress(LoadProgress::Loading);
+            Ok(path)
+        },
+        || fetcher.fetch(&voices),
+        speed_priors,
+        voice_aliases,
+        options,
     )
 }
 
@@ -150,6 +204,11 @@ pub fn load_from_hub(repo_id: &str) -> Result<KittenTtsOnnx> {
     load_from_hub_cb(repo_id, |_| {})
 }
 
+/// [`load_from_hub`] with explicit [`LoadOptions`] for the ONNX session.
+pub fn load_from_hub_with(repo_id: &str, options: &LoadOptions) -> Result<KittenTtsOnnx> {
+    load_from_hub_cb_with(repo_id, options, |_| {})
+}
+
 /// Convenience alias using the default nano model.
 pub fn load_default() -> Result<KittenTtsOnnx> {
     load_from_hub("KittenML/kitten-tts-nano-0.8-int8")
@@ -174,20 +233,11 @@ pub fn load_default() -> Result<KittenTtsOnnx> {
 /// the files are not already in the local HuggingFace cache.  Once cached,
 /// this function never makes a network request.
 pub fn list_voices_from_hub(repo_id: &str) -> Result<Vec<String>> {
-    let repo_id = if repo_id.contains('/') {
-        repo_id.to_string()
-    } else {
-        format!("KittenML/{}", repo_id)
-    };
-
+    let repo_id = hub_repo_id(repo_id);
     let api = Api::new().context("Failed to initialise HuggingFace Hub client")?;
 
     // ── config.json ──────────────────────────────────────────────────────────
-    let config_path = hf_download(&api, &repo_id, "config.json")?;
-    let config_bytes = std::fs::read(&config_path)
-        .with_context(|| format!("Cannot read config: {}", config_path.display()))?;
-    let config: ModelConfig = serde_json::from_slice(&config_bytes)
-        .context("Failed to parse config.json")?;
+    let config = read_config(&hf_download(&api, &repo_id, "config.json")?)?;
 
     // ── Voices NPZ (keys only — data arrays not used) ────────────────────────
     let voices_path = hf_download(&api, &repo_id, &config.voices)?;
@@ -94,8 +94,13 @@ impl EncoderFactory {
 
 // ─── Helpers ────────────────────────────────────────────────────────────────
 
+/// Tracing span covering one `encode` call (see [`crate::trace`]).
+fn encode_span(format: AudioFormat, samples: usize) -> tracing::span::EnteredSpan {
+    tracing::info_span!("encode", format = format.extension(), samples).entered()
+}
+
 /// Convert f32 [-1.0, 1.0] to i16 [-32768, 32767], matching model.rs logic.
-fn f32_to_i16(s: f32) -> i16 {
+pub(crate) fn f32_to_i16(s: f32) -> i16 {
     (s * i16::MAX as f32).clamp(i16::MIN as f32, i16::MAX as f32) as i16
 }
 
@@ -105,6 +110,7 @@ pub struct WavEncoder;
 
 impl AudioEncoder for WavEncoder {
     fn encode(&self, samples: &[f32], sample_rate: u32) -> Result<Vec<u8>> {
+        let _span = encode_span(AudioFormat::Wav, samples.len());
         let mut buf = std::io::Cursor::new(Vec::new());
         let spec = hound::WavSpec {
             channels: 1,
@@ -133,6 +139,7 @@ pub struct PcmEncoder;
 
 impl AudioEncoder for PcmEncoder {
     fn encode(&self, samples: &[f32], _sample_rate: u32) -> Result<Vec<u8>> {
+        let _span = encode_span(AudioFormat::Pcm, samples.len());
         let mut buf = Vec::with_capacity(samples.len() * 2);
         for &s in samples {
             buf.extend_from_slice(&f32_to_i16(s).to_le_bytes());
@@ -153,6 +160,7 @@ pub struct Mp3Encoder;
 #[cfg(feature = "mp3")]
 impl AudioEncoder for Mp3Encoder {
     fn encode(&self, samples: &[f32], sample_rate: u32) -> Result<Vec<u8>> {
+        let _span = encode_span(AudioFormat::Mp3, samples.len());
         use mp3lame_encoder::{Builder, FlushNoGap, InterleavedPcm};
 
         let mut builder = Builder::new().ok_or_else(|| anyhow::anyhow!("Failed to create MP3 encoder"))?;
@@ -201,6 +209,7 @@ pub struct OpusEncoder;
 #[cfg(feature = "opus")]
 impl AudioEncoder for OpusEncoder {
     fn encode(&self, samples: &[f32], sample_rate: u32) -> Result<Vec<u8>> {
+        let _span = encode_span(AudioFormat::Opus, samples.len());
         use audiopus::coder::Encoder;
         use audiopus::{Application, Channels, SampleRate as OpusSampleRate};
         use ogg::writing::PacketWriteEndInfo;
@@ -309,6 +318,7 @@ pub struct FlacEncoder;
 #[cfg(feature = "flac")]
 impl AudioEncoder for FlacEncoder {
     fn encode(&self, samples: &[f32], sample_rate: u32) -> Result<Vec<u8>> {
+        let _span = encode_span(AudioFormat::Flac, samples.len());
         use flacenc::bitsink::MemSink;
         use flacenc::component::BitRepr;
         use flacenc::error::Verify;
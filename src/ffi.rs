@@ -8,21 +8,56 @@
 //! | Function                          | Caller frees with          |
 //! |-----------------------------------|----------------------------|
 //! | [`kittentts_model_load`]          | [`kittentts_model_free`]   |
+//! | [`kittentts_model_load_ex`]       | [`kittentts_model_free`]   |
+//! | [`kittentts_model_load_from_memory`], [`kittentts_model_load_from_fd`] | [`kittentts_model_free`] |
+//! | [`kittentts_model_load_bundle`]   | [`kittentts_model_free`]   |
 //! | [`kittentts_model_voices`]        | [`kittentts_free_string`]  |
 //! | [`kittentts_synthesize_to_file`]  | [`kittentts_free_error`]   |
+//! | [`kittentts_synthesize_to_buffer`]| [`kittentts_audio_free`] (samples), [`kittentts_free_error`] |
+//! | [`kittentts_synthesize_ipa_to_buffer`] | [`kittentts_audio_free`] (samples), [`kittentts_free_error`] |
+//! | [`kittentts_synthesize_ipa_batch`], [`kittentts_synthesize_batch`] | [`kittentts_audio_free`] (each item), [`kittentts_free_error`] |
+//! | [`kittentts_synthesize_into`]     | [`kittentts_free_error`] (samples are caller-owned) |
+//! | [`kittentts_synthesize_stream`]   | [`kittentts_free_error`] (samples are borrowed for the callback) |
+//! | [`kittentts_submit`]              | [`kittentts_job_free`]     |
+//! | [`kittentts_job_result`]          | [`kittentts_audio_free`] (samples), [`kittentts_free_error`] |
+//! | [`kittentts_model_stats`], [`kittentts_last_stats`] | [`kittentts_free_error`] (stats are caller-owned) |
+//! | [`kittentts_init_shared_threads`] | [`kittentts_free_error`] |
 
 use std::collections::HashMap;
-use std::ffi::{CStr, CString, c_char};
-use std::path::Path;
+use std::ffi::{CStr, CString, c_char, c_void};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
 
-use crate::model::KittenTtsOnnx;
+use serde::Deserialize;
+
+use crate::encoding::f32_to_i16;
+#[cfg(feature = "espeak")]
+use crate::jobs::JobStatus;
+#[cfg(unix)]
+use crate::mmap::Mmap;
+use crate::model::{ExecutionProvider, GraphOptimization, KittenTtsOnnx, LoadOptions};
 use crate::phonemize;
+#[cfg(feature = "onnxruntime")]
+use crate::runtime::{self, ThreadPoolOptions};
+use crate::stats::{EngineStats, GenerationStats};
 
 // ─────────────────────────────────────────────────────────────────────────────
 
 /// Opaque handle to a loaded KittenTTS model.
 pub struct KittenTtsHandle {
-    model: KittenTtsOnnx,
+    // Shared with background jobs, which may outlive the handle.
+    model: Arc<KittenTtsOnnx>,
+    /// Unique for the life of the process, unlike the handle's address,
+    /// which a later load may reuse.
+    id: u64,
+}
+
+impl KittenTtsHandle {
+    fn new(model: KittenTtsOnnx) -> Box<Self> {
+        static NEXT_ID: AtomicU64 = AtomicU64::new(0);
+        Box::new(Self { model: Arc::new(model), id: NEXT_ID.fetch_add(1, Ordering::Relaxed) })
+    }
 }
 
 // ─── Helpers ─────────────────────────────────────────────────────────────────
@@ -44,6 +79,108 @@ fn to_c_str(s: &str) -> *const c_char {
     }
 }
 
+/// Early-return a heap-allocated error string from an FFI function.
+#[allow(unused_macros)]
+macro_rules! bail {
+    ($msg:literal) => {
+        return to_c_str($msg)
+    };
+    ($fmt:expr, $($arg:tt)*) => {
+        return to_c_str(&format!($fmt, $($arg)*))
+    };
+}
+
+// ─── PCM buffers ─────────────────────────────────────────────────────────────
+
+/// `KittenTtsAudio::format` value: 32-bit float samples in [-1.0, 1.0].
+pub const KITTENTTS_SAMPLE_F32: i32 = 0;
+/// `KittenTtsAudio::format` value: signed 16-bit integer samples.
+pub const KITTENTTS_SAMPLE_I16: i32 = 1;
+
+/// Synthesised mono PCM audio, filled in by the buffer synthesis functions.
+#[repr(C)]
+pub struct KittenTtsAudio {
+    /// `float*` or `int16_t*` depending on `format`.  Library-owned after
+    /// [`kittentts_synthesize_to_buffer`]; the caller's buffer (or null)
+    /// after [`kittentts_synthesize_into`].
+    pub samples: *mut c_void,
+    /// Number of samples (one channel, so also the number of frames).
+    pub num_samples: usize,
+    pub sample_rate: u32,
+    /// Always 1.
+    pub channels: u32,
+    /// [`KITTENTTS_SAMPLE_F32`] or [`KITTENTTS_SAMPLE_I16`].
+    pub format: i32,
+}
+
+impl KittenTtsAudio {
+    fn empty(format: i32) -> Self {
+        Self {
+            samples: std::ptr::null_mut(),
+            num_samples: 0,
+            sample_rate: crate::model::SAMPLE_RATE,
+            channels: 1,
+            format,
+        }
+    }
+}
+
+fn check_format(format: i32) -> Result<(), String> {
+    match format {
+        KITTENTTS_SAMPLE_F32 | KITTENTTS_SAMPLE_I16 => Ok(()),
+        f => Err(format!("unknown sample format {f}")),
+    }
+}
+
+/// Move `samples` into a library-owned buffer of `format`.
+fn into_c_buffer(samples: Vec<f32>, format: i32) -> KittenTtsAudio {
+    let mut audio = KittenTtsAudio::empty(format);
+    audio.num_samples = samples.len();
+    audio.samples = if format == KITTENTTS_SAMPLE_I16 {
+        let pcm: Box<[i16]> = samples.iter().map(|&s| f32_to_i16(s)).collect();
+        Box::into_raw(pcm) as *mut c_void
+    } else {
+        Box::into_raw(samples.into_boxed_slice()) as *mut c_void
+    };
+    audio
+}
+
+/// Write `samples` as `format` into `buffer`, which holds at least
+/// `samples.len()` samples.
+#[cfg(feature = "espeak")]
+unsafe fn copy_to_caller(samples: &[f32], format: i32, buffer: *mut c_void) {
+    if format == KITTENTTS_SAMPLE_I16 {
+        let dst = unsafe { std::slice::from_raw_parts_mut(buffer as *mut i16, samples.len()) };
+        for (d, &s) in dst.iter_mut().zip(samples) {
+            *d = f32_to_i16(s);
+        }
+    } else {
+        let dst = unsafe { std::slice::from_raw_parts_mut(buffer as *mut f32, samples.len()) };
+        dst.copy_from_slice(samples);
+    }
+}
+
+/// One synthesis result waiting for [`kittentts_synthesize_into`]'s second
+/// call, with the arguments that produced it.
+#[cfg(feature = "espeak")]
+struct PendingAudio {
+    /// [`KittenTtsHandle::id`] of the model that produced it.
+    model: u64,
+    text: String,
+    voice: String,
+    speed: u32,
+    samples: Vec<f32>,
+}
+
+#[cfg(feature = "espeak")]
+use std::cell::RefCell;
+
+#[cfg(feature = "espeak")]
+thread_local! {
+    // Per thread so concurrent callers never see each other's results.
+    static PENDING: RefCell<Option<PendingAudio>> = const { RefCell::new(None) };
+}
+
 // ─── Public API ──────────────────────────────────────────────────────────────
 
 /// Set the espeak-ng data directory path.
@@ -86,7 +223,291 @@ pub unsafe extern "C" fn kittentts_model_load(
         HashMap::new(), // speed_priors  — use model defaults
         HashMap::new(), // voice_aliases — no aliasing
     ) {
-        Ok(model) => Box::into_raw(Box::new(KittenTtsHandle { model })),
+        Ok(model) => Box::into_raw(KittenTtsHandle::new(model)),
+        Err(e) => {
+            eprintln!("[kittentts] load error: {e:#}");
+            std::ptr::null_mut()
+        }
+    }
+}
+
+/// Newest [`KittenTtsLoadOptions`] layout this library understands.  Every
+/// version appends fields to the previous one.
+pub const KITTENTTS_LOAD_OPTIONS_VERSION: u32 = 4;
+
+/// Load-time tuning for [`kittentts_model_load_ex`].
+///
+/// Always initialise with [`kittentts_load_options_init`] and then override
+/// individual fields, so fields added in later versions keep their defaults.
+/// The library reads only the fields of the caller's `version`, so a
+/// struct from an older header is never read past its end.
+#[repr(C)]
+pub struct KittenTtsLoadOptions {
+    /// Layout version the caller was compiled against; set by
+    /// [`kittentts_load_options_init`].
+    pub version: u32,
+    /// ORT intra-op threads; 0 = ORT default.
+    pub intra_op_threads: u32,
+    /// ORT inter-op threads; 0 or 1 = sequential execution.
+    pub inter_op_threads: u32,
+    /// Independent ORT sessions for concurrent synthesis; 0 = 1.
+    pub session_pool_size: u32,
+    /// -1 = ORT default, 0 = disable, 1 = basic, 2 = extended, 3 = all.
+    pub graph_optimization_level: i32,
+    /// Non-zero: run one inference per session before returning.
+    pub warm_up: i32,
+    /// Non-zero: decompress each voice on first use.
+    pub lazy_voices: i32,
+    /// Optimised-graph cache file, or NULL.
+    pub optimized_model_path: *const c_char,
+    /// `config.json` to read `speed_priors` / `voice_aliases` from, or NULL.
+    pub config_path: *const c_char,
+    /// Non-zero: run on the process-wide thread pools from
+    /// [`kittentts_init_shared_threads`].  Since version 2.
+    pub shared_threads: i32,
+    /// Non-zero: pooled sessions share prepacked weights.  Since version 3.
+    pub share_prepacked_weights: i32,
+    /// [`KITTENTTS_EP_CPU`] or [`KITTENTTS_EP_XNNPACK`].  Since version 4.
+    pub execution_provider: i32,
+}
+
+impl Default for KittenTtsLoadOptions {
+    /// The current version's defaults, which reproduce [`kittentts_model_load`].
+    fn default() -> Self {
+        Self {
+            version: KITTENTTS_LOAD_OPTIONS_VERSION,
+            intra_op_threads: 0,
+            inter_op_threads: 0,
+            session_pool_size: 1,
+            graph_optimization_level: -1,
+            warm_up: 0,
+            lazy_voices: 0,
+            optimized_model_path: std::ptr::null(),
+            config_path: std::ptr::null(),
+            shared_threads: 0,
+            share_prepacked_weights: 0,
+            execution_provider: KITTENTTS_EP_CPU,
+        }
+    }
+}
+
+/// Bytes of [`KittenTtsLoadOptions`] a caller of layout `version` owns:
+/// up to the end of the last field that version has.
+fn load_options_size(version: u32) -> Option<usize> {
+    use std::mem::{offset_of, size_of};
+    type O = KittenTtsLoadOptions;
+    Some(match version {
+        1 => offset_of!(O, config_path) + size_of::<*const c_char>(),
+        2 => offset_of!(O, shared_threads) + size_of::<i32>(),
+        3 => offset_of!(O, share_prepacked_weights) + size_of::<i32>(),
+        4 => offset_of!(O, execution_provider) + size_of::<i32>(),
+        _ => return None,
+    })
+}
+
+/// Copy the caller's options over the defaults, reading only the bytes its
+/// `version` has.
+unsafe fn read_load_options(
+    opts: *const KittenTtsLoadOptions,
+) -> Result<KittenTtsLoadOptions, String> {
+    // `version` is the first field of every layout.
+    let version = unsafe { opts.cast::<u32>().read() };
+    let size = load_options_size(version).ok_or_else(|| {
+        format!("unsupported options version {version} (library supports 1-{KITTENTTS_LOAD_OPTIONS_VERSION})")
+    })?;
+    let mut local = KittenTtsLoadOptions::default();
+    unsafe {
+        std::ptr::copy_nonoverlapping(
+            opts.cast::<u8>(),
+            (&mut local as *mut KittenTtsLoadOptions).cast::<u8>(),
+            size,
+        )
+    };
+    Ok(local)
+}
+
+/// [`KittenTtsLoadOptions::execution_provider`]: ORT's CPU kernels.
+pub const KITTENTTS_EP_CPU: i32 = 0;
+/// [`KittenTtsLoadOptions::execution_provider`]: XNNPACK, with CPU fallback.
+pub const KITTENTTS_EP_XNNPACK: i32 = 1;
+
+/// The subset of a model `config.json` that affects synthesis.
+#[derive(Default, Deserialize)]
+struct VoiceConfig {
+    #[serde(default)]
+    speed_priors: HashMap<String, f32>,
+    #[serde(default)]
+    voice_aliases: HashMap<String, String>,
+}
+
+/// Convert C options to [`LoadOptions`] plus the voice config.
+///
+/// `opts` must be a full struct, as returned by [`read_load_options`]:
+/// fields past the caller's version already hold their defaults.
+unsafe fn parse_load_options(
+    opts: &KittenTtsLoadOptions,
+) -> Result<(LoadOptions, VoiceConfig), String> {
+    let optimization_level = match opts.graph_optimization_level {
+        -1 => None,
+        0 => Some(GraphOptimization::Disable),
+        1 => Some(GraphOptimization::Basic),
+        2 => Some(GraphOptimization::Extended),
+        3 => Some(GraphOptimization::All),
+        n => return Err(format!("invalid graph_optimization_level {n}")),
+    };
+    let execution_provider = match opts.execution_provider {
+        KITTENTTS_EP_CPU => ExecutionProvider::Cpu,
+        KITTENTTS_EP_XNNPACK => ExecutionProvider::Xnnpack,
+        n => return Err(format!("invalid execution_provider {n}")),
+    };
+    let threads = |n: u32| (n > 0).then_some(n as usize);
+    let options = LoadOptions {
+        intra_threads: threads(opts.intra_op_threads),
+        inter_threads: threads(opts.inter_op_threads),
+        session_pool_size: opts.session_pool_size as usize,
+        optimization_level,
+        optimized_model_path: unsafe { cstr_to_string(opts.optimized_model_path) }
+            .map(PathBuf::from),
+        warm_up: opts.warm_up != 0,
+        lazy_voices: opts.lazy_voices != 0,
+        shared_threads: opts.shared_threads != 0,
+        share_prepacked_weights: opts.share_prepacked_weights != 0,
+        execution_provider,
+        ..Default::default()
+    };
+
+    let config = match unsafe { cstr_to_string(opts.config_path) } {
+        Some(path) => {
+            let json = std::fs::read_to_string(&path)
+                .map_err(|e| format!("cannot read config {path}: {e}"))?;
+            serde_json::from_str(&json).map_err(|e| format!("invalid config {path}: {e}"))?
+        }
+        None => VoiceConfig::default(),
+    };
+    Ok((options, config))
+}
+
+/// Fill `opts` with the defaults, which reproduce [`kittentts_model_load`].
+///
+/// `version` is the `KITTENTTS_LOAD_OPTIONS_VERSION` of the caller's header;
+/// only that layout's fields are written.  A version newer than this
+/// library is initialised as the newest one it knows; 0 writes nothing.
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_load_options_init(opts: *mut KittenTtsLoadOptions, version: u32) {
+    let version = version.min(KITTENTTS_LOAD_OPTIONS_VERSION);
+    let (false, Some(size)) = (opts.is_null(), load_options_size(version)) else {
+        return;
+    };
+    let defaults = KittenTtsLoadOptions { version, ..Default::default() };
+    unsafe {
+        std::ptr::copy_nonoverlapping(
+            (&defaults as *const KittenTtsLoadOptions).cast::<u8>(),
+            opts.cast::<u8>(),
+            size,
+        )
+    };
+}
+
+/// Create the process-wide ORT thread pools used by models loaded with
+/// `shared_threads` (see [`crate::runtime`]).
+///
+/// Call once, before loading any model.  Fails in builds without the
+/// `onnxruntime` feature.
+///
+/// @param intra_op_threads  Threads per operator, shared by all sessions; 0 = ORT default.
+/// @param inter_op_threads  Threads for parallel graph branches; 0 = ORT default.
+/// @param spin              -1 = ORT default, 0 = idle threads sleep, 1 = they spin.
+/// @param intra_affinity    ORT `intra_op_thread_affinities` string, or `NULL`.
+/// @return  `NULL` on success, or an error string freed with [`kittentts_free_error`].
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_init_shared_threads(
+    intra_op_threads: u32,
+    inter_op_threads: u32,
+    spin: i32,
+    intra_affinity: *const c_char,
+) -> *const c_char {
+    let threads = |n: u32| (n > 0).then_some(n as usize);
+    let spin = match spin {
+        -1 => None,
+        0 => Some(false),
+        1 => Some(true),
+        n => bail!("invalid spin {}", n),
+    };
+    #[cfg(feature = "onnxruntime")]
+    {
+        let options = ThreadPoolOptions {
+            intra_threads: threads(intra_op_threads),
+            inter_threads: threads(inter_op_threads),
+            spin,
+            intra_affinity: unsafe { cstr_to_string(intra_affinity) },
+        };
+        match runtime::init(options) {
+            Ok(()) => std::ptr::null(),
+            Err(e) => to_c_str(&format!("{e:#}")),
+        }
+    }
+    #[cfg(not(feature = "onnxruntime"))]
+    {
+        let _ = (threads, spin, intra_affinity);
+        bail!("shared thread pools require the `onnxruntime` feature")
+    }
+}
+
+/// [`kittentts_model_load`] with tuning options.
+///
+/// @param onnx_path    UTF-8 path to `kitten_tts_mini_v0_8.onnx`.
+/// @param voices_path  UTF-8 path to `voices.npz`.
+/// @param opts         Options from [`kittentts_load_options_init`], or `NULL`
+///                     for the defaults.
+/// @return             Opaque model handle, or `NULL` on failure (details to stderr).
+///                     Free with [`kittentts_model_free`].
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_model_load_ex(
+    onnx_path: *const c_char,
+    voices_path: *const c_char,
+    opts: *const KittenTtsLoadOptions,
+) -> *mut KittenTtsHandle {
+    let (Some(onnx), Some(voices)) = (
+        unsafe { cstr_to_string(onnx_path) },
+        unsafe { cstr_to_string(voices_path) },
+    ) else {
+        eprintln!("[kittentts] kittentts_model_load_ex: null argument");
+        return std::ptr::null_mut();
+    };
+    let Some((options, config)) = (unsafe { options_or_default(opts, "kittentts_model_load_ex") })
+    else {
+        return std::ptr::null_mut();
+    };
+
+    into_handle(KittenTtsOnnx::load_with_options(
+        Path::new(&onnx),
+        Path::new(&voices),
+        config.speed_priors,
+        config.voice_aliases,
+        &options,
+    ))
+}
+
+/// Parse nullable C options, logging failures under `func`.
+unsafe fn options_or_default(
+    opts: *const KittenTtsLoadOptions,
+    func: &str,
+) -> Option<(LoadOptions, VoiceConfig)> {
+    if opts.is_null() {
+        return Some((LoadOptions::default(), VoiceConfig::default()));
+    }
+    match unsafe { read_load_options(opts) }.and_then(|opts| unsafe { parse_load_options(&opts) }) {
+        Ok(parsed) => Some(parsed),
+        Err(e) => {
+            eprintln!("[kittentts] {func}: {e}");
+            None
+        }
+    }
+}
+
+fn into_handle(result: anyhow::Result<KittenTtsOnnx>) -> *mut KittenTtsHandle {
+    match result {
+        Ok(model) => Box::into_raw(KittenTtsHandle::new(model)),
         Err(e) => {
             eprintln!("[kittentts] load error: {e:#}");
             std::ptr::null_mut()
@@ -94,6 +515,123 @@ pub unsafe extern "C" fn kittentts_model_load(
     }
 }
 
+/// Load a model from serialized ONNX and `voices.npz` bytes in memory.
+///
+/// Neither buffer is referenced after this returns, so an mmap'd region or
+/// `AAsset_getBuffer` result may be released straight away.  Voices are
+/// parsed eagerly regardless of `opts->lazy_voices`.
+///
+/// @param onnx_data / onnx_len      The ONNX model.
+/// @param voices_data / voices_len  The `voices.npz` archive.
+/// @param opts                      Options, or `NULL` for the defaults.
+/// @return  Opaque model handle, or `NULL` on failure (details to stderr).
+///          Free with [`kittentts_model_free`].
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_model_load_from_memory(
+    onnx_data: *const u8,
+    onnx_len: usize,
+    voices_data: *const u8,
+    voices_len: usize,
+    opts: *const KittenTtsLoadOptions,
+) -> *mut KittenTtsHandle {
+    if onnx_data.is_null() || voices_data.is_null() {
+        eprintln!("[kittentts] kittentts_model_load_from_memory: null argument");
+        return std::ptr::null_mut();
+    }
+    let Some((options, config)) =
+        (unsafe { options_or_default(opts, "kittentts_model_load_from_memory") })
+    else {
+        return std::ptr::null_mut();
+    };
+    let onnx = unsafe { std::slice::from_raw_parts(onnx_data, onnx_len) };
+    let voices = unsafe { std::slice::from_raw_parts(voices_data, voices_len) };
+
+    into_handle(KittenTtsOnnx::load_from_memory(
+        onnx,
+        voices,
+        config.speed_priors,
+        config.voice_aliases,
+        &options,
+    ))
+}
+
+/// Load a model from regions of open files, e.g. uncompressed APK assets
+/// opened with `AAsset_openFileDescriptor64`.  Each region is mmap'd for
+/// the duration of the call.  The descriptors are not closed.  A region
+/// that is empty or runs past the end of its file fails the load.
+///
+/// @param onnx_fd / onnx_offset / onnx_len        Region holding the ONNX model.
+/// @param voices_fd / voices_offset / voices_len  Region holding `voices.npz`.
+/// @param opts                                    Options, or `NULL` for the defaults.
+/// @return  Opaque model handle, or `NULL` on failure (details to stderr).
+///          Free with [`kittentts_model_free`].
+#[cfg(unix)]
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_model_load_from_fd(
+    onnx_fd: i32,
+    onnx_offset: i64,
+    onnx_len: usize,
+    voices_fd: i32,
+    voices_offset: i64,
+    voices_len: usize,
+    opts: *const KittenTtsLoadOptions,
+) -> *mut KittenTtsHandle {
+    use std::os::unix::io::FromRawFd;
+
+    let map = |fd: i32, offset: i64, len: usize| -> anyhow::Result<Mmap> {
+        anyhow::ensure!(fd >= 0 && offset >= 0, "invalid descriptor {fd} or offset {offset}");
+        anyhow::ensure!(len > 0, "empty region at offset {offset} of descriptor {fd}");
+        // Borrow the caller's descriptor without taking ownership.
+        let file = std::mem::ManuallyDrop::new(unsafe { std::fs::File::from_raw_fd(fd) });
+        Ok(Mmap::map(&file, offset as u64, len)?)
+    };
+    let Some((options, config)) =
+        (unsafe { options_or_default(opts, "kittentts_model_load_from_fd") })
+    else {
+        return std::ptr::null_mut();
+    };
+
+    into_handle((|| {
+        let onnx = map(onnx_fd, onnx_offset, onnx_len)?;
+        let voices = map(voices_fd, voices_offset, voices_len)?;
+        KittenTtsOnnx::load_from_memory(
+            &onnx,
+            &voices,
+            config.speed_priors,
+            config.voice_aliases,
+            &options,
+        )
+    })())
+}
+
+/// Load a `.kitten` single-file bundle (see [`crate::bundle`]).
+///
+/// The bundle is mmap'd for the lifetime of the model: the ONNX graph is
+/// read from the mapping and voice rows are used in place.  Speed priors and
+/// voice aliases come from the bundle, so `opts->config_path` is ignored.
+///
+/// @param path  Path to the `.kitten` file.
+/// @param opts  Options, or `NULL` for the defaults.
+/// @return  Opaque model handle, or `NULL` on failure (details to stderr).
+///          Free with [`kittentts_model_free`].
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_model_load_bundle(
+    path: *const c_char,
+    opts: *const KittenTtsLoadOptions,
+) -> *mut KittenTtsHandle {
+    let Some(path) = (unsafe { cstr_to_string(path) }) else {
+        eprintln!("[kittentts] kittentts_model_load_bundle: null argument");
+        return std::ptr::null_mut();
+    };
+    let Some((options, _config)) =
+        (unsafe { options_or_default(opts, "kittentts_model_load_bundle") })
+    else {
+        return std::ptr::null_mut();
+    };
+
+    into_handle(KittenTtsOnnx::load_bundle(Path::new(&path), &options))
+}
+
 /// Return a JSON array of available voice names.
 ///
 /// Example return value: `["expr-voice-2-f","expr-voice-3-m",…]`
@@ -142,15 +680,6 @@ pub unsafe extern "C" fn kittentts_synthesize_to_file(
     speed: f32,
     output_path: *const c_char,
 ) -> *const c_char {
-    macro_rules! bail {
-        ($msg:literal) => {
-            return to_c_str($msg);
-        };
-        ($fmt:expr, $($arg:tt)*) => {
-            return to_c_str(&format!($fmt, $($arg)*));
-        };
-    }
-
     if model.is_null() {
         bail!("null model handle");
     }
@@ -175,6 +704,679 @@ pub unsafe extern "C" fn kittentts_synthesize_to_file(
     }
 }
 
+/// Synthesise `text` into a library-allocated PCM buffer.
+///
+/// No file is written.  On success `out` holds the samples, their count and
+/// the sample rate; release the samples with [`kittentts_audio_free`].  On
+/// failure `out->samples` is null.
+///
+/// **Requires the `espeak` Cargo feature.**
+///
+/// @param format  [`KITTENTTS_SAMPLE_F32`] or [`KITTENTTS_SAMPLE_I16`].
+/// @return        `NULL` on success, otherwise an error message to release
+///                with [`kittentts_free_error`].
+#[cfg(feature = "espeak")]
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_synthesize_to_buffer(
+    model: *const KittenTtsHandle,
+    text: *const c_char,
+    voice: *const c_char,
+    speed: f32,
+    format: i32,
+    out: *mut KittenTtsAudio,
+) -> *const c_char {
+    if model.is_null() || out.is_null() {
+        bail!("null model handle or out pointer");
+    }
+    let out = unsafe { &mut *out };
+    *out = KittenTtsAudio::empty(format);
+    if let Err(e) = check_format(format) {
+        bail!("{}", e);
+    }
+    let (Some(txt), Some(vox)) = (
+        unsafe { cstr_to_string(text) },
+        unsafe { cstr_to_string(voice) },
+    ) else {
+        bail!("null argument (text or voice)");
+    };
+
+    let h = unsafe { &*model };
+    match h.model.generate(&txt, &vox, speed, /*clean_text=*/ true) {
+        Ok(samples) => {
+            *out = into_c_buffer(samples, format);
+            std::ptr::null()
+        }
+        Err(e) => to_c_str(&format!("{e:#}")),
+    }
+}
+
+/// Synthesise `text` into a caller-owned buffer, using a two-call protocol:
+///
+/// 1. Call with `buffer = NULL` (or too small).  The audio is synthesised,
+///    `out->num_samples` is set to the size needed and `out->samples` is
+///    left null.
+/// 2. Allocate `num_samples` samples of `format` and call again with the
+///    **same arguments on the same thread**.  The result from step 1 is
+///    copied in without synthesising again, and `out->samples` points at
+///    `buffer`.
+///
+/// A buffer that is already large enough makes step 1 copy directly.  The
+/// pending result is per thread and is dropped by the next call on that
+/// thread with different arguments.
+///
+/// **Requires the `espeak` Cargo feature.**
+///
+/// @param buffer    Caller memory for `capacity` samples, or `NULL`.
+/// @param capacity  Size of `buffer` in samples (not bytes).
+/// @return          `NULL` on success (including the size query), otherwise
+///                  an error message to release with [`kittentts_free_error`].
+#[cfg(feature = "espeak")]
+#[allow(clippy::too_many_arguments)]
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_synthesize_into(
+    model: *const KittenTtsHandle,
+    text: *const c_char,
+    voice: *const c_char,
+    speed: f32,
+    format: i32,
+    buffer: *mut c_void,
+    capacity: usize,
+    out: *mut KittenTtsAudio,
+) -> *const c_char {
+    if model.is_null() || out.is_null() {
+        bail!("null model handle or out pointer");
+    }
+    let out = unsafe { &mut *out };
+    *out = KittenTtsAudio::empty(format);
+    if let Err(e) = check_format(format) {
+        bail!("{}", e);
+    }
+    let (Some(txt), Some(vox)) = (
+        unsafe { cstr_to_string(text) },
+        unsafe { cstr_to_string(voice) },
+    ) else {
+        bail!("null argument (text or voice)");
+    };
+
+    let h = unsafe { &*model };
+    let key = (h.id, speed.to_bits());
+    let cached = PENDING.with(|p| {
+        p.borrow_mut().take().filter(|a| {
+            (a.model, a.speed) == key && a.text == txt && a.voice == vox
+        })
+    });
+    let samples = match cached {
+        Some(pending) => pending.samples,
+        None => {
+            match h.model.generate(&txt, &vox, speed, /*clean_text=*/ true) {
+                Ok(samples) => samples,
+                Err(e) => return to_c_str(&format!("{e:#}")),
+            }
+        }
+    };
+
+    out.num_samples = samples.len();
+    if !buffer.is_null() && capacity >= samples.len() {
+        unsafe { copy_to_caller(&samples, format, buffer) };
+        out.samples = buffer;
+    } else {
+        PENDING.with(|p| {
+            *p.borrow_mut() = Some(PendingAudio {
+                model: key.0,
+                text: txt,
+                voice: vox,
+                speed: key.1,
+                samples,
+            })
+        });
+    }
+    std::ptr::null()
+}
+
+/// Per-chunk callback for [`kittentts_synthesize_stream`].
+///
+/// Receives the chunk's f32 samples (valid only until the callback returns),
+/// their count, the sample rate, the zero-based chunk index and the caller's
+/// `user_data`.  Return `0` to continue or non-zero to stop.
+pub type KittenTtsChunkCallback = Option<
+    unsafe extern "C" fn(
+        samples: *const f32,
+        num_samples: usize,
+        sample_rate: u32,
+        chunk_index: usize,
+        user_data: *mut c_void,
+    ) -> i32,
+>;
+
+/// Synthesise `text` chunk by chunk, passing each chunk's PCM to `callback`
+/// as soon as its inference finishes.
+///
+/// The callback runs synchronously on the calling thread, in chunk order,
+/// before this function returns.  No library lock is held while it runs.
+/// Returning non-zero stops synthesis; the call then still returns `NULL`.
+///
+/// **Requires the `espeak` Cargo feature.**
+///
+/// @return `NULL` on success or early stop, otherwise an error message to
+///         release with [`kittentts_free_error`].
+#[cfg(feature = "espeak")]
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_synthesize_stream(
+    model: *const KittenTtsHandle,
+    text: *const c_char,
+    voice: *const c_char,
+    speed: f32,
+    callback: KittenTtsChunkCallback,
+    user_data: *mut c_void,
+) -> *const c_char {
+    if model.is_null() {
+        bail!("null model handle");
+    }
+    let Some(callback) = callback else {
+        bail!("null callback");
+    };
+    let (Some(txt), Some(vox)) = (
+        unsafe { cstr_to_string(text) },
+        unsafe { cstr_to_string(voice) },
+    ) else {
+        bail!("null argument (text or voice)");
+    };
+
+    let h = unsafe { &*model };
+    let result = h.model.generate_streaming(&txt, &vox, speed, /*clean_text=*/ true, |i, chunk| {
+        let stop = unsafe {
+            callback(chunk.as_ptr(), chunk.len(), crate::model::SAMPLE_RATE, i, user_data)
+        };
+        stop == 0
+    });
+    match result {
+        Ok(_) => std::ptr::null(),
+        Err(e) => to_c_str(&format!("{e:#}")),
+    }
+}
+
+// ─── IPA input and batches ───────────────────────────────────────────────────
+
+/// Synthesise a pre-computed IPA string into a library-allocated PCM buffer.
+///
+/// Works without the `espeak` feature.  The IPA must use espeak-ng's
+/// `en-us` symbol set; unknown characters are skipped.  Otherwise behaves
+/// like [`kittentts_synthesize_to_buffer`].
+///
+/// @param format  [`KITTENTTS_SAMPLE_F32`] or [`KITTENTTS_SAMPLE_I16`].
+/// @return        `NULL` on success, otherwise an error message to release
+///                with [`kittentts_free_error`].
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_synthesize_ipa_to_buffer(
+    model: *const KittenTtsHandle,
+    ipa: *const c_char,
+    voice: *const c_char,
+    speed: f32,
+    format: i32,
+    out: *mut KittenTtsAudio,
+) -> *const c_char {
+    if model.is_null() || out.is_null() {
+        bail!("null model handle or out pointer");
+    }
+    let out = unsafe { &mut *out };
+    *out = KittenTtsAudio::empty(format);
+    if let Err(e) = check_format(format) {
+        bail!("{}", e);
+    }
+    let (Some(ipa), Some(vox)) = (
+        unsafe { cstr_to_string(ipa) },
+        unsafe { cstr_to_string(voice) },
+    ) else {
+        bail!("null argument (ipa or voice)");
+    };
+
+    let h = unsafe { &*model };
+    match h.model.generate_from_ipa(&ipa, &vox, speed, ipa.len()) {
+        Ok(samples) => {
+            *out = into_c_buffer(samples, format);
+            std::ptr::null()
+        }
+        Err(e) => to_c_str(&format!("{e:#}")),
+    }
+}
+
+/// Shared body of the batch functions: validate arguments, run `synth` on
+/// the decoded items and fill `out[0..count]`.
+unsafe fn synthesize_batch(
+    model: *const KittenTtsHandle,
+    items: *const *const c_char,
+    count: usize,
+    voice: *const c_char,
+    format: i32,
+    out: *mut KittenTtsAudio,
+    synth: impl FnOnce(&KittenTtsOnnx, &[&str], &str) -> anyhow::Result<Vec<Vec<f32>>>,
+) -> *const c_char {
+    if model.is_null() {
+        bail!("null model handle");
+    }
+    let Some(vox) = (unsafe { cstr_to_string(voice) }) else {
+        bail!("null voice");
+    };
+    if let Err(e) = check_format(format) {
+        bail!("{}", e);
+    }
+    // An empty batch needs no arrays; `items` / `out` may be NULL.
+    if count == 0 {
+        return std::ptr::null();
+    }
+    if items.is_null() || out.is_null() {
+        bail!("null items or out pointer");
+    }
+    let out = unsafe { std::slice::from_raw_parts_mut(out, count) };
+    out.iter_mut().for_each(|a| *a = KittenTtsAudio::empty(format));
+    let ptrs = unsafe { std::slice::from_raw_parts(items, count) };
+    let Some(owned) = ptrs.iter().map(|&p| unsafe { cstr_to_string(p) }).collect::<Option<Vec<_>>>()
+    else {
+        bail!("null item in batch");
+    };
+    let refs: Vec<&str> = owned.iter().map(String::as_str).collect();
+
+    let h = unsafe { &*model };
+    match synth(&h.model, &refs, &vox) {
+        Ok(all) => {
+            for (slot, samples) in out.iter_mut().zip(all) {
+                *slot = into_c_buffer(samples, format);
+            }
+            std::ptr::null()
+        }
+        Err(e) => to_c_str(&format!("{e:#}")),
+    }
+}
+
+/// Synthesise `count` IPA strings, one buffer per item.
+///
+/// Items run in parallel across the model's session pool (see
+/// `session_pool_size` in [`KittenTtsLoadOptions`]); with the default pool
+/// of one they run in order on the calling thread.  Works without the
+/// `espeak` feature.
+///
+/// On success `out[i]` holds item `i`; release each with
+/// [`kittentts_audio_free`].  If any item fails, no buffers are returned
+/// (every `out[i].samples` is null) and the error names the failing index.
+///
+/// @param ipa     Array of `count` NUL-terminated IPA strings; may be `NULL`
+///                when `count` is 0, which succeeds without synthesising.
+/// @param out     Array of `count` structs to fill; may be `NULL` when
+///                `count` is 0.
+/// @return        `NULL` on success, otherwise an error message to release
+///                with [`kittentts_free_error`].
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_synthesize_ipa_batch(
+    model: *const KittenTtsHandle,
+    ipa: *const *const c_char,
+    count: usize,
+    voice: *const c_char,
+    speed: f32,
+    format: i32,
+    out: *mut KittenTtsAudio,
+) -> *const c_char {
+    unsafe {
+        synthesize_batch(model, ipa, count, voice, format, out, |m, items, vox| {
+            m.generate_from_ipa_batch(items, vox, speed)
+        })
+    }
+}
+
+/// [`kittentts_synthesize_ipa_batch`] for text utterances.
+///
+/// **Requires the `espeak` Cargo feature.**
+#[cfg(feature = "espeak")]
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_synthesize_batch(
+    model: *const KittenTtsHandle,
+    texts: *const *const c_char,
+    count: usize,
+    voice: *const c_char,
+    speed: f32,
+    format: i32,
+    out: *mut KittenTtsAudio,
+) -> *const c_char {
+    unsafe {
+        synthesize_batch(model, texts, count, voice, format, out, |m, items, vox| {
+            m.generate_batch(items, vox, speed, /*clean_text=*/ true)
+        })
+    }
+}
+
+/// Release the samples of a [`KittenTtsAudio`] filled by
+/// [`kittentts_synthesize_to_buffer`] (or the IPA / batch variants) and
+/// reset it to empty.
+///
+/// Safe to call on an already-freed or empty struct.  Do **not** call it on
+/// a struct filled by [`kittentts_synthesize_into`] — those samples belong to
+/// the caller.
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_audio_free(audio: *mut KittenTtsAudio) {
+    if audio.is_null() {
+        return;
+    }
+    let a = unsafe { &mut *audio };
+    if !a.samples.is_null() {
+        let len = a.num_samples;
+        if a.format == KITTENTTS_SAMPLE_I16 {
+            let slice = std::ptr::slice_from_raw_parts_mut(a.samples as *mut i16, len);
+            drop(unsafe { Box::from_raw(slice) });
+        } else {
+            let slice = std::ptr::slice_from_raw_parts_mut(a.samples as *mut f32, len);
+            drop(unsafe { Box::from_raw(slice) });
+        }
+    }
+    a.samples = std::ptr::null_mut();
+    a.num_samples = 0;
+}
+
+// ─── Statistics ──────────────────────────────────────────────────────────────
+
+/// Current layout of [`KittenTtsStats`].
+pub const KITTENTTS_STATS_VERSION: u32 = 1;
+
+/// Counters filled in by [`kittentts_model_stats`] and
+/// [`kittentts_last_stats`].  Times are wall-clock milliseconds.
+#[repr(C)]
+pub struct KittenTtsStats {
+    /// Set to [`KITTENTTS_STATS_VERSION`] before the call.
+    pub version: u32,
+    /// Completed synthesis calls (a batch counts one per item).
+    pub requests: u64,
+    pub chunks: u64,
+    pub tokens: u64,
+    pub samples: u64,
+    pub audio_seconds: f64,
+    pub preprocess_ms: f64,
+    pub phonemize_ms: f64,
+    pub tokenize_ms: f64,
+    pub inference_ms: f64,
+    pub total_ms: f64,
+    /// Wall time ÷ audio duration; below 1 is faster than real time.
+    pub real_time_factor: f64,
+    /// Inferences that waited for a pooled session.  Model stats only.
+    pub session_waits: u64,
+    /// Voice lookups served from memory / decompressed first.  Model stats only.
+    pub voice_cache_hits: u64,
+    pub voice_cache_misses: u64,
+    /// `1.0` before any lookup.
+    pub voice_cache_hit_rate: f64,
+    /// Non-zero if the optimised-graph cache was used at load.  Model stats only.
+    pub optimized_model_cache_hit: i32,
+    /// Largest Rust heap growth of one request on its calling thread; ORT's
+    /// own allocations are not counted.  Zero unless built with `alloc-stats`.
+    pub peak_rust_heap_bytes: u64,
+}
+
+impl KittenTtsStats {
+    fn from_call(stats: &GenerationStats) -> Self {
+        let ms = |s: crate::stats::StageStats| s.time.as_secs_f64() * 1e3;
+        Self {
+            version: KITTENTTS_STATS_VERSION,
+            requests: 1,
+            chunks: stats.chunks as u64,
+            tokens: stats.tokens as u64,
+            samples: stats.samples as u64,
+            audio_seconds: stats.audio_seconds(),
+            preprocess_ms: ms(stats.preprocess),
+            phonemize_ms: ms(stats.phonemize),
+            tokenize_ms: ms(stats.tokenize),
+            inference_ms: ms(stats.inference),
+            total_ms: ms(stats.total),
+            real_time_factor: stats.real_time_factor(),
+            session_waits: 0,
+            voice_cache_hits: 0,
+            voice_cache_misses: 0,
+            voice_cache_hit_rate: 1.0,
+            optimized_model_cache_hit: 0,
+            peak_rust_heap_bytes: stats.total.alloc.peak_live_bytes,
+        }
+    }
+
+    fn from_engine(engine: &EngineStats) -> Self {
+        Self {
+            requests: engine.requests,
+            session_waits: engine.session_waits,
+            voice_cache_hits: engine.voice_cache_hits,
+            voice_cache_misses: engine.voice_cache_misses,
+            voice_cache_hit_rate: engine.voice_cache_hit_rate(),
+            optimized_model_cache_hit: engine.optimized_model_cache_hit as i32,
+            peak_rust_heap_bytes: engine.peak_rust_heap_bytes,
+            ..Self::from_call(&engine.totals)
+        }
+    }
+}
+
+/// Check `out` and its version before writing stats into it.
+unsafe fn check_stats_out(out: *mut KittenTtsStats) -> Result<(), String> {
+    match unsafe { out.as_ref() } {
+        None => Err("null stats pointer".into()),
+        Some(s) if s.version != KITTENTTS_STATS_VERSION => Err(format!(
+            "unsupported stats version {} (library is {KITTENTTS_STATS_VERSION})",
+            s.version
+        )),
+        Some(_) => Ok(()),
+    }
+}
+
+/// Cumulative statistics of `model` since it was loaded.
+///
+/// Cheap enough to poll: it copies a few counters under one short lock.
+///
+/// @param out  Set `out->version` to `KITTENTTS_STATS_VERSION` first.
+/// @return     `NULL` on success, otherwise an error message to release
+///             with [`kittentts_free_error`].
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_model_stats(
+    model: *const KittenTtsHandle,
+    out: *mut KittenTtsStats,
+) -> *const c_char {
+    if model.is_null() {
+        bail!("null model handle");
+    }
+    if let Err(e) = unsafe { check_stats_out(out) } {
+        return to_c_str(&e);
+    }
+    let engine = unsafe { &*model }.model.engine_stats();
+    unsafe { out.write(KittenTtsStats::from_engine(&engine)) };
+    std::ptr::null()
+}
+
+/// Statistics of the last synthesis call made on the calling thread (any
+/// model).  A batch call reports all of its items together.  The
+/// model-only fields are zero.
+///
+/// @param out  Set `out->version` to `KITTENTTS_STATS_VERSION` first.
+/// @return     `NULL` on success, otherwise an error message to release
+///             with [`kittentts_free_error`] — including when this thread
+///             has not synthesised anything yet.
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_last_stats(out: *mut KittenTtsStats) -> *const c_char {
+    if let Err(e) = unsafe { check_stats_out(out) } {
+        return to_c_str(&e);
+    }
+    let Some(stats) = crate::stats::last_call_stats() else {
+        bail!("no synthesis call on this thread yet");
+    };
+    unsafe { out.write(KittenTtsStats::from_call(&stats)) };
+    std::ptr::null()
+}
+
+// ─── Background jobs ─────────────────────────────────────────────────────────
+
+#[cfg(feature = "espeak")]
+mod job_pool {
+    use std::sync::{
+        atomic::{AtomicUsize, Ordering},
+        OnceLock,
+    };
+
+    use crate::jobs::JobPool;
+
+    static POOL: OnceLock<JobPool> = OnceLock::new();
+    /// Worker count for the pool, read once when the first job is submitted.
+    pub(super) static WORKERS: AtomicUsize = AtomicUsize::new(1);
+
+    pub(super) fn get() -> &'static JobPool {
+        POOL.get_or_init(|| JobPool::new(WORKERS.load(Ordering::Relaxed)))
+    }
+
+    pub(super) fn started() -> bool {
+        POOL.get().is_some()
+    }
+}
+
+/// Opaque handle to a background synthesis job.
+#[cfg(feature = "espeak")]
+pub struct KittenTtsJob {
+    job: Arc<crate::jobs::Job>,
+    format: i32,
+}
+
+/// Set the number of worker threads that run submitted jobs (default 1).
+///
+/// Each worker runs one inference at a time and ORT already parallelises
+/// within an inference, so more workers mainly help throughput when many
+/// short utterances are queued.  Must be called before the first
+/// [`kittentts_submit`].
+///
+/// @return `NULL` on success, otherwise an error message to release with
+///         [`kittentts_free_error`].
+#[cfg(feature = "espeak")]
+#[no_mangle]
+pub extern "C" fn kittentts_set_job_workers(workers: usize) -> *const c_char {
+    if workers == 0 {
+        bail!("worker count must be at least 1");
+    }
+    if job_pool::started() {
+        bail!("job workers already started; set the count before the first kittentts_submit");
+    }
+    job_pool::WORKERS.store(workers, std::sync::atomic::Ordering::Relaxed);
+    std::ptr::null()
+}
+
+/// Queue `text` for synthesis on the library's worker pool and return at
+/// once.
+///
+/// The job keeps the model alive, so [`kittentts_model_free`] may be called
+/// while jobs are still pending.
+///
+/// @param format  Sample format of the result: [`KITTENTTS_SAMPLE_F32`] or
+///                [`KITTENTTS_SAMPLE_I16`].
+/// @return        Job handle, or `NULL` on invalid arguments (details to
+///                stderr).  Free with [`kittentts_job_free`].
+#[cfg(feature = "espeak")]
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_submit(
+    model: *const KittenTtsHandle,
+    text: *const c_char,
+    voice: *const c_char,
+    speed: f32,
+    format: i32,
+) -> *mut KittenTtsJob {
+    let (false, Some(txt), Some(vox)) = (
+        model.is_null(),
+        unsafe { cstr_to_string(text) },
+        unsafe { cstr_to_string(voice) },
+    ) else {
+        eprintln!("[kittentts] kittentts_submit: null argument");
+        return std::ptr::null_mut();
+    };
+    if let Err(e) = check_format(format) {
+        eprintln!("[kittentts] kittentts_submit: {e}");
+        return std::ptr::null_mut();
+    }
+
+    let tts = Arc::clone(&unsafe { &*model }.model);
+    let job = job_pool::get().submit(move |cancel| {
+        let mut audio = Vec::new();
+        tts.generate_streaming(&txt, &vox, speed, /*clean_text=*/ true, |_, chunk| {
+            audio.extend_from_slice(chunk);
+            !cancel.is_cancelled()
+        })?;
+        Ok(audio)
+    });
+    Box::into_raw(Box::new(KittenTtsJob { job, format }))
+}
+
+/// Current job status without blocking: one of the `KITTENTTS_JOB_*`
+/// values (`QUEUED` 0, `RUNNING` 1, `DONE` 2, `FAILED` 3, `CANCELLED` 4),
+/// or -1 for a null handle.
+#[cfg(feature = "espeak")]
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_job_poll(job: *const KittenTtsJob) -> i32 {
+    match unsafe { job.as_ref() } {
+        Some(j) => j.job.status() as i32,
+        None => -1,
+    }
+}
+
+/// Block until the job finishes or `timeout_ms` elapses (negative waits
+/// forever).  Returns the status at that point, as [`kittentts_job_poll`].
+#[cfg(feature = "espeak")]
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_job_wait(job: *const KittenTtsJob, timeout_ms: i64) -> i32 {
+    let Some(j) = (unsafe { job.as_ref() }) else {
+        return -1;
+    };
+    let timeout = u64::try_from(timeout_ms).ok().map(std::time::Duration::from_millis);
+    j.job.wait(timeout) as i32
+}
+
+/// Request cancellation.  A queued job never runs; a running job stops at
+/// the next chunk boundary.  Use [`kittentts_job_wait`] to wait for it.
+#[cfg(feature = "espeak")]
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_job_cancel(job: *const KittenTtsJob) {
+    if let Some(j) = unsafe { job.as_ref() } {
+        j.job.cancel();
+    }
+}
+
+/// Move a finished job's audio into `out` (release with
+/// [`kittentts_audio_free`]).  The audio can be taken only once.
+///
+/// @return `NULL` on success.  Otherwise an error message to release with
+///         [`kittentts_free_error`]: the synthesis error for a failed job,
+///         or a note that the job is unfinished, cancelled or already taken.
+#[cfg(feature = "espeak")]
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_job_result(
+    job: *const KittenTtsJob,
+    out: *mut KittenTtsAudio,
+) -> *const c_char {
+    let (Some(j), Some(out)) = (unsafe { job.as_ref() }, unsafe { out.as_mut() }) else {
+        bail!("null job handle or out pointer");
+    };
+    *out = KittenTtsAudio::empty(j.format);
+    match j.job.status() {
+        JobStatus::Queued | JobStatus::Running => bail!("job has not finished"),
+        JobStatus::Cancelled => bail!("job was cancelled"),
+        JobStatus::Done | JobStatus::Failed => {}
+    }
+    match j.job.take_result() {
+        Some(Ok(samples)) => {
+            *out = into_c_buffer(samples, j.format);
+            std::ptr::null()
+        }
+        Some(Err(e)) => to_c_str(&e),
+        None => bail!("job result was already taken"),
+    }
+}
+
+/// Release a job handle.  An unfinished job is cancelled first; this does
+/// not wait for it to stop.
+#[cfg(feature = "espeak")]
+#[no_mangle]
+pub unsafe extern "C" fn kittentts_job_free(job: *mut KittenTtsJob) {
+    if !job.is_null() {
+        let j = unsafe { Box::from_raw(job) };
+        if !j.job.status().is_finished() {
+            j.job.cancel();
+        }
+    }
+}
+
 /// Free a string returned by [`kittentts_model_voices`].
 #[no_mangle]
 pub unsafe extern "C" fn kittentts_free_string(s: *const c_char) {
@@ -196,3 +1398,163 @@ pub unsafe extern "C" fn kittentts_model_free(model: *mut KittenTtsHandle) {
         drop(unsafe { Box::from_raw(model) });
     }
 }
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tests
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(all(test, feature = "espeak"))]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_buffer_round_trip_f32() {
+        let mut audio = into_c_buffer(vec![0.0, 0.5, -1.0], KITTENTTS_SAMPLE_F32);
+        assert_eq!((audio.num_samples, audio.sample_rate, audio.channels), (3, 24_000, 1));
+        let s = unsafe { std::slice::from_raw_parts(audio.samples as *const f32, 3) };
+        assert_eq!(s, &[0.0, 0.5, -1.0]);
+        unsafe { kittentts_audio_free(&mut audio) };
+        assert!(audio.samples.is_null());
+        unsafe { kittentts_audio_free(&mut audio) }; // double free is a no-op
+    }
+
+    #[test]
+    fn test_buffer_round_trip_i16() {
+        let mut audio = into_c_buffer(vec![0.0, 1.0, -1.0, 2.0], KITTENTTS_SAMPLE_I16);
+        let s = unsafe { std::slice::from_raw_parts(audio.samples as *const i16, 4) };
+        assert_eq!(s, &[0, i16::MAX, -i16::MAX, i16::MAX]);
+        unsafe { kittentts_audio_free(&mut audio) };
+    }
+
+    #[test]
+    fn test_copy_to_caller_converts() {
+        let mut buf = [0i16; 2];
+        unsafe { copy_to_caller(&[0.5, -0.5], KITTENTTS_SAMPLE_I16, buf.as_mut_ptr().cast()) };
+        assert_eq!(buf, [16383, -16383]);
+        assert!(check_format(7).is_err());
+    }
+
+    #[test]
+    fn test_load_options_parse_and_validate() {
+        let mut opts = std::mem::MaybeUninit::<KittenTtsLoadOptions>::uninit();
+        unsafe { kittentts_load_options_init(opts.as_mut_ptr(), KITTENTTS_LOAD_OPTIONS_VERSION) };
+        let mut opts = unsafe { opts.assume_init() };
+        opts.intra_op_threads = 2;
+        opts.session_pool_size = 3;
+        opts.graph_optimization_level = 1;
+        opts.lazy_voices = 1;
+
+        let (parsed, config) = unsafe { parse_load_options(&opts) }.unwrap();
+        assert_eq!(parsed.intra_threads, Some(2));
+        assert_eq!(parsed.inter_threads, None);
+        assert_eq!(parsed.session_pool_size, 3);
+        assert_eq!(parsed.optimization_level, Some(GraphOptimization::Basic));
+        assert!(parsed.lazy_voices && !parsed.warm_up);
+        assert!(config.speed_priors.is_empty());
+
+        assert!(!parsed.shared_threads);
+
+        opts.execution_provider = KITTENTTS_EP_XNNPACK;
+        let parsed = unsafe { parse_load_options(&opts) }.unwrap().0;
+        assert_eq!(parsed.execution_provider, ExecutionProvider::Xnnpack);
+        opts.execution_provider = 5;
+        assert!(unsafe { parse_load_options(&opts) }.is_err());
+        opts.execution_provider = KITTENTTS_EP_CPU;
+
+        opts.graph_optimization_level = 9;
+        assert!(unsafe { parse_load_options(&opts) }.is_err());
+        opts.graph_optimization_level = -1;
+        opts.version = KITTENTTS_LOAD_OPTIONS_VERSION + 1;
+        assert!(unsafe { read_load_options(&opts) }.is_err());
+        opts.version = 0;
+        assert!(unsafe { read_load_options(&opts) }.is_err());
+    }
+
+    #[test]
+    fn test_older_option_layouts_stay_in_bounds() {
+        // A version-1 caller owns only the bytes up to `config_path`; the
+        // rest of this buffer stands for whatever follows its struct.
+        let v1 = load_options_size(1).unwrap();
+        let mut buf = [0xAAu8; std::mem::size_of::<KittenTtsLoadOptions>()];
+        let opts = buf.as_mut_ptr().cast::<KittenTtsLoadOptions>();
+        unsafe { kittentts_load_options_init(opts, 1) };
+        assert!(buf[v1..].iter().all(|&b| b == 0xAA), "init wrote past the v1 layout");
+
+        // Garbage after the v1 fields must not be read as shared_threads or
+        // an invalid execution_provider.
+        let read = unsafe { read_load_options(opts) }.unwrap();
+        assert_eq!((read.version, read.shared_threads, read.execution_provider), (1, 0, KITTENTTS_EP_CPU));
+        let (parsed, _) = unsafe { parse_load_options(&read) }.unwrap();
+        assert!(!parsed.shared_threads && !parsed.share_prepacked_weights);
+
+        // Every version's layout is a prefix of the next.
+        let sizes: Vec<_> = (1..=KITTENTTS_LOAD_OPTIONS_VERSION).map(|v| load_options_size(v).unwrap()).collect();
+        assert!(sizes.windows(2).all(|w| w[0] < w[1]));
+        assert!(load_options_size(KITTENTTS_LOAD_OPTIONS_VERSION + 1).is_none());
+    }
+
+    #[test]
+    fn test_empty_batch_needs_no_arrays() {
+        use crate::backend::{self, MockBackend};
+        let tts = KittenTtsOnnx::from_backend(
+            Box::new(MockBackend::default()),
+            backend::synthetic_voices(&["Jasper"]),
+            Default::default(),
+            Default::default(),
+            &LoadOptions::default(),
+        )
+        .unwrap();
+        let model = into_handle(Ok(tts));
+        let voice = c"Jasper".as_ptr();
+        let batch = |items, count, voice, out| unsafe {
+            kittentts_synthesize_ipa_batch(model, items, count, voice, 1.0, KITTENTTS_SAMPLE_F32, out)
+        };
+
+        assert!(batch(std::ptr::null(), 0, voice, std::ptr::null_mut()).is_null());
+        // The model and voice are still checked for an empty batch.
+        let err = batch(std::ptr::null(), 0, std::ptr::null(), std::ptr::null_mut());
+        assert!(!err.is_null());
+        unsafe { kittentts_free_error(err) };
+        let err = batch(std::ptr::null(), 1, voice, std::ptr::null_mut());
+        assert!(!err.is_null());
+        unsafe { kittentts_free_error(err) };
+        unsafe { kittentts_model_free(model) };
+    }
+
+    #[test]
+    fn test_handles_never_share_an_id() {
+        use crate::backend::{self, MockBackend};
+        let load = || {
+            let tts = KittenTtsOnnx::from_backend(
+                Box::new(MockBackend::default()),
+                backend::synthetic_voices(&["Jasper"]),
+                Default::default(),
+                Default::default(),
+                &LoadOptions::default(),
+            );
+            into_handle(tts)
+        };
+        // A freed handle's address may be reused; its id must not be.
+        let first = load();
+        let first_id = unsafe { (*first).id };
+        unsafe { kittentts_model_free(first) };
+        let second = load();
+        assert_ne!(unsafe { (*second).id }, first_id);
+        unsafe { kittentts_model_free(second) };
+    }
+
+    #[test]
+    fn test_stats_conversion_and_version() {
+        let mut engine = EngineStats { voice_cache_hits: 3, voice_cache_misses: 1, ..Default::default() };
+        engine.record(&GenerationStats { chunks: 2, samples: 48_000, ..Default::default() });
+        let c = KittenTtsStats::from_engine(&engine);
+        assert_eq!((c.requests, c.chunks, c.samples), (1, 2, 48_000));
+        assert_eq!((c.audio_seconds, c.voice_cache_hit_rate), (2.0, 0.75));
+
+        let mut out: KittenTtsStats = unsafe { std::mem::zeroed() };
+        assert!(unsafe { check_stats_out(&mut out) }.is_err());
+        out.version = KITTENTTS_STATS_VERSION;
+        assert!(unsafe { check_stats_out(&mut out) }.is_ok());
+        assert!(unsafe { check_stats_out(std::ptr::null_mut()) }.is_err());
+    }
+}
@@ -0,0 +1,398 @@
+//! Background synthesis jobs on a fixed worker pool.
+//!
+//! [`JobPool`] owns a set of worker threads and a FIFO queue.  Submitting
+//! work returns an `Arc<`[`Job`]`>` that can be polled, waited on with a
+//! timeout, or cancelled.  A queued job that is cancelled never runs.  A
+//! running job sees the request through its [`CancelToken`] and stops at
+//! the next chunk boundary.
+//!
+//! The C API's `kittentts_submit` / `kittentts_job_*` functions are thin
+//! wrappers over this module (see `ffi.rs`).
+//!
+//! ```no_run
+//! # fn demo(tts: std::sync::Arc<kittentts::KittenTTS>) {
+//! use kittentts::jobs::{JobPool, JobStatus};
+//!
+//! let pool = JobPool::new(2);
+//! let job = pool.submit(move |cancel| {
+//!     let mut audio = Vec::new();
+//!     tts.generate_streaming("Hello there.", "Bella", 1.0, true, |_, chunk| {
+//!         audio.extend_from_slice(chunk);
+//!         !cancel.is_cancelled()
+//!     })?;
+//!     Ok(audio)
+//! });
+//! assert_eq!(job.wait(None), JobStatus::Done);
+//! let audio = job.take_result().unwrap().unwrap();
+//! # }
+//! ```
+
+use std::{
+    collections::VecDeque,
+    panic::AssertUnwindSafe,
+    sync::{
+        atomic::{AtomicBool, Ordering},
+        mpsc, Arc, Condvar, Mutex,
+    },
+    thread::JoinHandle,
+    time::{Duration, Instant},
+};
+
+use anyhow::Result;
+
+use crate::affinity::{self, CpuSet};
+
+/// Lifecycle of a [`Job`].  The numeric values are part of the C API.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(i32)]
+pub enum JobStatus {
+    Queued = 0,
+    Running = 1,
+    Done = 2,
+    Failed = 3,
+    Cancelled = 4,
+}
+
+impl JobStatus {
+    /// `true` once the job will not change state again.
+    pub fn is_finished(self) -> bool {
+        matches!(self, Self::Done | Self::Failed | Self::Cancelled)
+    }
+}
+
+/// Passed to the job body so it can stop early when cancelled.
+#[derive(Clone)]
+pub struct CancelToken(Arc<Job>);
+
+impl CancelToken {
+    pub fn is_cancelled(&self) -> bool {
+        self.0.cancel.load(Ordering::Relaxed)
+    }
+}
+
+type Body = Box<dyn FnOnce(&CancelToken) -> Result<Vec<f32>> + Send>;
+
+struct JobState {
+    status: JobStatus,
+    /// Set when the job finishes; taken by [`Job::take_result`].
+    result: Option<Result<Vec<f32>, String>>,
+}
+
+/// Handle to one submitted job.
+pub struct Job {
+    state: Mutex<JobState>,
+    changed: Condvar,
+    cancel: AtomicBool,
+}
+
+impl Job {
+    fn new() -> Arc<Self> {
+        Arc::new(Self {
+            state: Mutex::new(JobState { status: JobStatus::Queued, result: None }),
+            changed: Condvar::new(),
+            cancel: AtomicBool::new(false),
+        })
+    }
+
+    /// Current status without blocking.
+    pub fn status(&self) -> JobStatus {
+        self.state.lock().unwrap().status
+    }
+
+    /// Block until the job finishes or `timeout` elapses (`None` waits
+    /// forever).  Returns the status at that point.
+    pub fn wait(&self, timeout: Option<Duration>) -> JobStatus {
+        let deadline = timeout.map(|t| Instant::now() + t);
+        let mut state = self.state.lock().unwrap();
+        while !state.status.is_finished() {
+            match deadline {
+                None => state = self.changed.wait(state).unwrap(),
+                Some(deadline) => {
+                    let now = Instant::now();
+                    if now >= deadline {
+                        break;
+                    }
+                    state = self.changed.wait_timeout(state, deadline - now).unwrap().0;
+                }
+            }
+        }
+        state.status
+    }
+
+    /// Request cancellation.  A queued job is cancelled immediately; a
+    /// running job stops at its next check of the [`CancelToken`].
+    pub fn cancel(&self) {
+        self.cancel.store(true, Ordering::Relaxed);
+        let mut state = self.state.lock().unwrap();
+        if state.status == JobStatus::Queued {
+            state.status = JobStatus::Cancelled;
+            self.changed.notify_all();
+        }
+    }
+
+    /// Take the samples (or error message) of a finished job.  Returns
+    /// `None` if the job has not finished, was cancelled, or the result was
+    /// already taken.
+    pub fn take_result(&self) -> Option<Result<Vec<f32>, String>> {
+        self.state.lock().unwrap().result.take()
+    }
+
+    fn finish(&self, status: JobStatus, result: Option<Result<Vec<f32>, String>>) {
+        let mut state = self.state.lock().unwrap();
+        state.status = status;
+        state.result = result;
+        self.changed.notify_all();
+    }
+
+    fn run(self: &Arc<Self>, body: Body) {
+        {
+            let mut state = self.state.lock().unwrap();
+            if state.status != JobStatus::Queued {
+                return; // cancelled while queued
+            }
+            state.status = JobStatus::Running;
+            self.changed.notify_all();
+        }
+        let token = CancelToken(Arc::clone(self));
+        // A panicking body must still finish the job (waiters would hang)
+        // and must not take the worker thread down with it.
+        let outcome = match std::panic::catch_unwind(AssertUnwindSafe(|| body(&token))) {
+            Ok(outcome) => outcome,
+            Err(payload) => {
+                let detail = payload
+                    .downcast_ref::<&str>()
+                    .copied()
+                    .or_else(|| payload.downcast_ref::<String>().map(String::as_str));
+                let message = match detail {
+                    Some(detail) => format!("job panicked: {detail}"),
+                    None => "job panicked".to_string(),
+                };
+                return self.finish(JobStatus::Failed, Some(Err(message)));
+            }
+        };
+        match outcome {
+            _ if token.is_cancelled() => self.finish(JobStatus::Cancelled, None),
+            Ok(samples) => self.finish(JobStatus::Done, Some(Ok(samples))),
+            Err(e) => self.finish(JobStatus::Failed, Some(Err(format!("{e:#}")))),
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Pool
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct Queue {
+    tasks: VecDeque<(Arc<Job>, Body)>,
+    shutdown: bool,
+}
+
+struct Shared {
+    queue: Mutex<Queue>,
+    available: Condvar,
+}
+
+/// Fixed-size pool of worker threads running [`Job`]s in FIFO order.
+///
+/// Dropping the pool lets queued jobs finish, then joins the workers.
+pub struct JobPool {
+    shared: Arc<Shared>,
+    workers: Vec<JoinHandle<()>>,
+}
+
+impl JobPool {
+    /// Start `threads` workers (at least one).
+    pub fn new(threads: usize) -> Self {
+        Self::start(threads, None)
+    }
+
+    /// [`new`](Self::new) with every worker pinned to `cpus` (see
+    /// [`crate::affinity`]).  Fails if the workers cannot be pinned.
+    pub fn pinned(threads: usize, cpus: &CpuSet) -> Result<Self> {
+        let (tx, rx) = mpsc::channel();
+        let pool = Self::start(threads, Some((cpus.clone(), tx)));
+        for _ in 0..pool.threads() {
+            rx.recv().expect("job worker exited before pinning")?;
+        }
+        Ok(pool)
+    }
+
+    /// Start the workers; with `pin`, each pins itself and reports the
+    /// outcome before taking work.
+    fn start(threads: usize, pin: Option<(CpuSet, mpsc::Sender<Result<()>>)>) -> Self {
+        let shared = Arc::new(Shared {
+            queue: Mutex::new(Queue { tasks: VecDeque::new(), shutdown: false }),
+            available: Condvar::new(),
+        });
+        let workers = (0..threads.max(1))
+            .map(|i| {
+                let shared = Arc::clone(&shared);
+                let pin = pin.clone();
+                std::thread::Builder::new()
+                    .name(format!("kittentts-job-{i}"))
+                    .spawn(move || {
+                        if let Some((cpus, tx)) = pin {
+                            let _ = tx.send(affinity::pin_current_thread(&cpus));
+                        }
+                        worker(&shared)
+                    })
+                    .expect("failed to spawn kittentts job worker")
+            })
+            .collect();
+        Self { shared, workers }
+    }
+
+    /// Number of worker threads.
+    pub fn threads(&self) -> usize {
+        self.workers.len()
+    }
+
+    /// Number of jobs waiting for a worker.
+    pub fn queued(&self) -> usize {
+        self.shared.queue.lock().unwrap().tasks.len()
+    }
+
+    /// Queue `body` and return its job handle.
+    pub fn submit<F>(&self, body: F) -> Arc<Job>
+    where
+        F: FnOnce(&CancelToken) -> Result<Vec<f32>> + Send + 'static,
+    {
+        let job = Job::new();
+        let mut queue = self.shared.queue.lock().unwrap();
+        queue.tasks.push_back((Arc::clone(&job), Box::new(body)));
+        drop(queue);
+        self.shared.available.notify_one();
+        job
+    }
+}
+
+impl Drop for JobPool {
+    fn drop(&mut self) {
+        self.shared.queue.lock().unwrap().shutdown = true;
+        self.shared.available.notify_all();
+        for w in self.workers.drain(..) {
+            let _ = w.join();
+        }
+    }
+}
+
+fn worker(shared: &Shared) {
+    loop {
+        let (job, body) = {
+            let mut queue = shared.queue.lock().unwrap();
+            loop {
+                if let Some(task) = queue.tasks.pop_front() {
+                    break task;
+                }
+                if queue.shutdown {
+                    return;
+                }
+                queue = shared.available.wait(queue).unwrap();
+            }
+        };
+        job.run(body);
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tests
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_job_runs_to_completion() {
+        let pool = JobPool::new(2);
+        let job = pool.submit(|_| Ok(vec![1.0, 2.0]));
+        assert_eq!(job.wait(None), JobStatus::Done);
+        assert_eq!(job.take_result(), Some(Ok(vec![1.0, 2.0])));
+        assert_eq!(job.take_result(), None, "result can only be taken once");
+    }
+
+    #[test]
+    fn test_failed_job_reports_error() {
+        let pool = JobPool::new(1);
+        let job = pool.submit(|_| anyhow::bail!("no such voice"));
+        assert_eq!(job.wait(None), JobStatus::Failed);
+        assert_eq!(job.take_result(), Some(Err("no such voice".to_string())));
+    }
+
+    #[test]
+    fn test_panicking_job_fails_and_worker_survives() {
+        let pool = JobPool::new(1);
+        let panicked = pool.submit(|_| panic!("synthesis blew up"));
+        assert_eq!(panicked.wait(Some(Duration::from_secs(5))), JobStatus::Failed);
+        assert_eq!(panicked.take_result(), Some(Err("job panicked: synthesis blew up".to_string())));
+
+        let next = pool.submit(|_| Ok(vec![1.0]));
+        assert_eq!(next.wait(Some(Duration::from_secs(5))), JobStatus::Done);
+        assert_eq!(next.take_result(), Some(Ok(vec![1.0])));
+    }
+
+    #[test]
+    fn test_wait_times_out_and_cancel_queued() {
+        let pool = JobPool::new(1);
+        let (release, gate) = mpsc::channel::<()>();
+        let blocker = pool.submit(move |_| {
+            gate.recv().ok();
+            Ok(Vec::new())
+        });
+        let queued = pool.submit(|_| Ok(vec![0.0]));
+
+        assert_eq!(queued.wait(Some(Duration::from_millis(20))), JobStatus::Queued);
+        queued.cancel();
+        assert_eq!(queued.status(), JobStatus::Cancelled);
+
+        release.send(()).unwrap();
+        assert_eq!(blocker.wait(None), JobStatus::Done);
+        assert_eq!(queued.wait(None), JobStatus::Cancelled);
+        assert_eq!(queued.take_result(), None);
+    }
+
+    #[test]
+    fn test_cancel_running_job() {
+        let pool = JobPool::new(1);
+        let (started_tx, started) = mpsc::channel();
+        let job = pool.submit(move |cancel| {
+            started_tx.send(()).unwrap();
+            while !cancel.is_cancelled() {
+                std::thread::sleep(Duration::from_millis(1));
+            }
+            Ok(Vec::new())
+        });
+        started.recv().unwrap();
+        assert_eq!(job.status(), JobStatus::Running);
+        job.cancel();
+        assert_eq!(job.wait(Some(Duration::from_secs(5))), JobStatus::Cancelled);
+    }
+
+    #[test]
+    fn test_drop_finishes_queued_jobs() {
+        let pool = JobPool::new(1);
+        let jobs: Vec<_> = (0..4).map(|i| pool.submit(move |_| Ok(vec![i as f32]))).collect();
+        drop(pool);
+        assert!(jobs.iter().all(|j| j.status() == JobStatus::Done));
+    }
+
+    #[cfg(any(target_os = "linux", target_os = "android"))]
+    #[test]
+    fn test_pinned_workers_stay_on_their_cpus() {
+        let cpus = CpuSet::new([affinity::allowed_cpus().unwrap().cpus()[0]]);
+        let pool = JobPool::pinned(2, &cpus).unwrap();
+        let (tx, rx) = mpsc::channel();
+        let jobs: Vec<_> = (0..2)
+            .map(|_| {
+                let tx = tx.clone();
+                pool.submit(move |_| {
+                    tx.send(affinity::allowed_cpus().unwrap()).unwrap();
+                    Ok(Vec::new())
+                })
+            })
+            .collect();
+        assert!(jobs.iter().all(|j| j.wait(None) == JobStatus::Done));
+        assert!(rx.try_iter().all(|allowed| allowed == cpus));
+        assert!(JobPool::pinned(1, &CpuSet::default()).is_err());
+    }
+}
@@ -67,12 +67,25 @@ pub mod download;
 // C FFI for iOS / Android — exposes kittentts_model_load / synthesize / free.
 pub mod ffi;
 
+pub mod affinity;
+pub mod alloc;
+pub mod autotune;
+pub mod backend;
+pub mod baseline;
+pub mod bundle;
 pub mod encoding;
+pub mod jobs;
+pub mod mmap;
 pub mod model;
 pub mod npz;
 pub mod phonemize;
 pub mod preprocess;
+pub mod profiling;
+#[cfg(feature = "onnxruntime")]
+pub mod runtime;
+pub mod stats;
 pub mod tokenize;
+pub mod trace;
 
 // ─── Re-exports for convenience ─────────────────────────────────────────────
 
@@ -83,3 +96,5 @@ pub use model::KittenTtsOnnx as KittenTTS;
 pub use model::SAMPLE_RATE;
 
 pub use encoding::{AudioEncoder, AudioFormat, EncoderFactory};
+
+pub use stats::{EngineStats, GenerationStats, last_call_stats};
@@ -0,0 +1,149 @@
+//! Read-only memory maps of file regions.
+//!
+//! Used to load the model and voices straight out of a container file
+//! (e.g. an uncompressed asset inside an Android APK) without copying them
+//! to their own files first.  On Unix this is `mmap(2)`; elsewhere the
+//! region is read into memory.
+
+use std::{fs::File, io, ops::Deref};
+
+/// A read-only view of `len` bytes of a file starting at `offset`.
+pub struct Mmap {
+    #[cfg(unix)]
+    ptr: *mut libc::c_void,
+    /// Bytes mapped before `offset` to satisfy page alignment.
+    #[cfg(unix)]
+    lead: usize,
+    #[cfg(not(unix))]
+    buf: Vec<u8>,
+    len: usize,
+}
+
+// The mapping is read-only and owned by this value.
+unsafe impl Send for Mmap {}
+unsafe impl Sync for Mmap {}
+
+impl Mmap {
+    /// Map `len` bytes of `file` starting at `offset`.  `offset` need not be
+    /// page-aligned.  The file may be closed once this returns.
+    ///
+    /// Fails if the region extends past the end of the file: pages beyond
+    /// EOF would map, but reading them raises `SIGBUS`.
+    #[cfg(unix)]
+    pub fn map(file: &File, offset: u64, len: usize) -> io::Result<Self> {
+        use std::os::unix::io::AsRawFd;
+
+        let size = file.metadata()?.len();
+        if offset.checked_add(len as u64).map_or(true, |end| end > size) {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidInput,
+                format!("region {offset}+{len} extends past the end of the file ({size} bytes)"),
+            ));
+        }
+        if len == 0 {
+            return Ok(Self { ptr: std::ptr::null_mut(), lead: 0, len });
+        }
+        let page = unsafe { libc::sysconf(libc::_SC_PAGESIZE) } as u64;
+        let aligned = offset - offset % page;
+        let lead = (offset - aligned) as usize;
+        let ptr = unsafe {
+            libc::mmap(
+                std::ptr::null_mut(),
+                lead + len,
+                libc::PROT_READ,
+                libc::MAP_PRIVATE,
+                file.as_raw_fd(),
+                aligned as libc::off_t,
+            )
+        };
+        if ptr == libc::MAP_FAILED {
+            return Err(io::Error::last_os_error());
+        }
+        Ok(Self { ptr, lead, len })
+    }
+
+    /// Read `len` bytes of `file` starting at `offset`.
+    #[cfg(not(unix))]
+    pub fn map(file: &File, offset: u64, len: usize) -> io::Result<Self> {
+        use std::io::{Read, Seek, SeekFrom};
+
+        let mut file = file;
+        file.seek(SeekFrom::Start(offset))?;
+        let mut buf = vec![0; len];
+        file.read_exact(&mut buf)?;
+        Ok(Self { buf, len })
+    }
+
+    /// Map a whole file.
+    pub fn map_file(file: &File) -> io::Result<Self> {
+        let len = file.metadata()?.len();
+        let len = usize::try_from(len)
+            .map_err(|_| io::Error::new(io::ErrorKind::InvalidInput, "file too large to map"))?;
+        Self::map(file, 0, len)
+    }
+}
+
+impl Deref for Mmap {
+    type Target = [u8];
+
+    #[cfg(unix)]
+    fn deref(&self) -> &[u8] {
+        if self.len == 0 {
+            return &[];
+        }
+        unsafe { std::slice::from_raw_parts((self.ptr as *const u8).add(self.lead), self.len) }
+    }
+
+    #[cfg(not(unix))]
+    fn deref(&self) -> &[u8] {
+        &self.buf
+    }
+}
+
+#[cfg(unix)]
+impl Drop for Mmap {
+    fn drop(&mut self) {
+        if !self.ptr.is_null() {
+            unsafe { libc::munmap(self.ptr, self.lead + self.len) };
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tests
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::io::Write;
+
+    #[test]
+    fn test_map_unaligned_region() {
+        let path = std::env::temp_dir().join("kittentts_mmap_test.bin");
+        let data: Vec<u8> = (0..10_000u32).map(|i| (i % 251) as u8).collect();
+        std::fs::File::create(&path).unwrap().write_all(&data).unwrap();
+
+        let file = File::open(&path).unwrap();
+        let map = Mmap::map(&file, 4_099, 1_000).unwrap();
+        drop(file);
+        assert_eq!(&map[..], &data[4_099..5_099]);
+        assert_eq!(&Mmap::map_file(&File::open(&path).unwrap()).unwrap()[..], &data[..]);
+        assert!(Mmap::map(&File::open(&path).unwrap(), 0, 0).unwrap().is_empty());
+        let _ = std::fs::remove_file(&path);
+    }
+
+    #[test]
+    fn test_map_past_end_fails() {
+        let path = std::env::temp_dir().join("kittentts_mmap_past_end.bin");
+        std::fs::File::create(&path).unwrap().write_all(&[7; 5_000]).unwrap();
+
+        let file = File::open(&path).unwrap();
+        assert!(Mmap::map(&file, 0, 5_000).is_ok());
+        for (offset, len) in [(0, 5_001), (4_096, 1_000), (6_000, 0), (u64::MAX, 1)] {
+            let err = Mmap::map(&file, offset, len).err().expect("region past EOF must fail");
+            assert_eq!(err.kind(), io::ErrorKind::InvalidInput, "{offset}+{len}");
+        }
+        let _ = std::fs::remove_file(&path);
+    }
+}
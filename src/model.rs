@@ -1,7 +1,8 @@
 //! ONNX model runner — mirrors Python's `KittenTTS_1_Onnx`.
 //!
-//! Uses [`ort`] (ONNX Runtime Rust bindings) for inference.
-//! The three model inputs are:
+//! Uses [`ort`] (ONNX Runtime Rust bindings) for inference by default; see
+//! [`crate::backend`] for the alternatives.  Builds without the default
+//! `onnxruntime` feature leave ORT out entirely and load through those.  The three model inputs are:
 //!
 //! | Name        | Shape         | dtype   |
 //! |-------------|---------------|---------|
@@ -9,15 +10,40 @@
 //! | `style`     | `[1, style_d]`| float32 |
 //! | `speed`     | `[1]`         | float32 |
 
-use std::{collections::HashMap, path::Path, sync::Mutex};
+use std::{
+    collections::HashMap,
+    path::{Path, PathBuf},
+    sync::{
+        atomic::{AtomicU64, AtomicUsize, Ordering},
+        Arc, Mutex,
+    },
+};
+#[cfg(feature = "onnxruntime")]
+use std::sync::{MutexGuard, TryLockError};
 
 use anyhow::{Context, Result};
-use ort::{session::Session, value::Tensor};
+use once_cell::sync::OnceCell;
+#[cfg(feature = "onnxruntime")]
+use ort::{
+    session::{
+        builder::{GraphOptimizationLevel, PrepackedWeights, SessionBuilder},
+        RunOptions, Session,
+    },
+    value::Tensor,
+};
+use tracing::field::Empty;
 
 use crate::{
-    npz::{load_npz, NpyArray},
+    backend::InferenceBackend,
+    bundle::{Bundle, VoiceSection},
+    mmap::Mmap,
+    npz::{list_npz, load_npz, load_npz_entry, load_npz_from_bytes, NpyArray},
+    profiling::{ProfileReport, ProfilingOptions},
+    stats::{self, EngineStats, GenerationStats, StageTimer},
     tokenize::ipa_to_ids,
 };
+#[cfg(feature = "onnxruntime")]
+use crate::{profiling::SessionProfiler, runtime};
 
 #[cfg(feature = "espeak")]
 use crate::{phonemize::phonemize, preprocess::TextPreprocessor};
@@ -33,7 +59,7 @@ use crate::{phonemize::phonemize, preprocess::TextPreprocessor};
 /// enough to strip the artifact without cutting into real speech.  A separate
 /// 1-second silence tail is appended in `tts.rs` to keep the audio driver's
 /// hardware buffer alive until the last sample drains.
-const TAIL_TRIM: usize = 2_000;
+pub(crate) const TAIL_TRIM: usize = 2_000;
 
 /// Audio sample rate produced by the model.
 pub const SAMPLE_RATE: u32 = 24_000;
@@ -96,18 +122,745 @@ fn chunk_text(text: &str, max_len: usize) -> Vec<String> {
 struct Voice {
     nrows: usize,
     ncols: usize,
-    data: Vec<f32>, // flat, row-major
+    data: VoiceData,
+}
+
+enum VoiceData {
+    /// Flat, row-major.
+    Owned(Vec<f32>),
+    /// Rows read in place from a bundle mapping: `stride` bytes apart from
+    /// byte `offset`.  Only used where the rows are `f32`-aligned and the
+    /// host is little-endian.
+    Mapped { map: Arc<Mmap>, offset: usize, stride: usize },
 }
 
 impl Voice {
     fn from_npy(arr: NpyArray) -> Self {
-        Self { nrows: arr.nrows(), ncols: arr.ncols(), data: arr.data }
+        Self { nrows: arr.nrows(), ncols: arr.ncols(), data: VoiceData::Owned(arr.data) }
+    }
+
+    fn from_bundle(bundle: &Bundle, section: &VoiceSection) -> Self {
+        let (nrows, ncols) = (section.rows as usize, section.cols as usize);
+        let offset = bundle.voice_start(section);
+        let aligned = (bundle.map().as_ptr() as usize + offset) % std::mem::align_of::<f32>() == 0;
+        let data = if cfg!(target_endian = "little") && aligned {
+            VoiceData::Mapped {
+                map: Arc::clone(bundle.map()),
+                offset,
+                stride: section.row_stride as usize,
+            }
+        } else {
+            VoiceData::Owned(bundle.read_voice(section))
+        };
+        Self { nrows, ncols, data }
     }
 
     /// Row at `text_len`, clamped to valid range.
     fn style_row(&self, text_len: usize) -> &[f32] {
         let i = text_len.min(self.nrows.saturating_sub(1));
-        &self.data[i * self.ncols..(i + 1) * self.ncols]
+        match &self.data {
+            VoiceData::Owned(data) => &data[i * self.ncols..(i + 1) * self.ncols],
+            VoiceData::Mapped { map, offset, stride } => {
+                let bytes = &map[offset + i * stride..][..self.ncols * 4];
+                // SAFETY: bounds checked by the slice above and by
+                // `Bundle::open`; alignment and endianness checked in
+                // `from_bundle`; every bit pattern is a valid f32.
+                unsafe { std::slice::from_raw_parts(bytes.as_ptr().cast::<f32>(), self.ncols) }
+            }
+        }
+    }
+}
+
+/// Voice embeddings, parsed at load time or on first use of each voice.
+enum VoiceStore {
+    Eager(HashMap<String, Voice>),
+    /// Only the names are read at load; each matrix is decompressed from
+    /// `path` the first time its voice is requested.
+    Lazy { path: PathBuf, voices: HashMap<String, OnceCell<Voice>> },
+}
+
+impl VoiceStore {
+    fn load(path: &Path, lazy: bool) -> Result<(Self, Vec<String>)> {
+        if lazy {
+            let names = list_npz(path)?;
+            let voices = names.iter().map(|n| (n.clone(), OnceCell::new())).collect();
+            Ok((Self::Lazy { path: path.to_path_buf(), voices }, names))
+        } else {
+            Ok(Self::eager(load_npz(path)?))
+        }
+    }
+
+    fn from_bytes(bytes: &[u8]) -> Result<(Self, Vec<String>)> {
+        Ok(Self::eager(load_npz_from_bytes(bytes)?))
+    }
+
+    fn from_bundle(bundle: &Bundle) -> (Self, Vec<String>) {
+        let names = bundle.voices().iter().map(|v| v.name.clone()).collect();
+        let voices =
+            bundle.voices().iter().map(|v| (v.name.clone(), Voice::from_bundle(bundle, v))).collect();
+        (Self::Eager(voices), names)
+    }
+
+    fn eager(raw: HashMap<String, NpyArray>) -> (Self, Vec<String>) {
+        let names = raw.keys().cloned().collect();
+        let voices = raw.into_iter().map(|(k, v)| (k, Voice::from_npy(v))).collect();
+        (Self::Eager(voices), names)
+    }
+
+    /// `true` if `key`'s matrix is already in memory (always, when eager).
+    fn is_loaded(&self, key: &str) -> bool {
+        match self {
+            Self::Eager(_) => true,
+            Self::Lazy { voices, .. } => voices.get(key).is_some_and(|cell| cell.get().is_some()),
+        }
+    }
+
+    fn contains(&self, key: &str) -> bool {
+        match self {
+            Self::Eager(voices) => voices.contains_key(key),
+            Self::Lazy { voices, .. } => voices.contains_key(key),
+        }
+    }
+
+    /// The voice's style matrix, or `Ok(None)` if there is no such voice.
+    fn get(&self, key: &str) -> Result<Option<&Voice>> {
+        match self {
+            Self::Eager(voices) => Ok(voices.get(key)),
+            Self::Lazy { path, voices } => {
+                let Some(cell) = voices.get(key) else {
+                    return Ok(None);
+                };
+                cell.get_or_try_init(|| load_npz_entry(path, key).map(Voice::from_npy))
+                    .map(Some)
+                    .with_context(|| format!("Cannot load voice '{}'", key))
+            }
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Load options
+// ─────────────────────────────────────────────────────────────────────────────
+
+/// ONNX Runtime graph optimisation level.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum GraphOptimization {
+    /// No graph rewrites.
+    Disable,
+    /// Semantics-preserving rewrites: constant folding, redundant node removal.
+    Basic,
+    /// Basic plus complex node fusions.
+    Extended,
+    /// Everything, including layout optimisations (ORT's default).
+    All,
+}
+
+#[cfg(feature = "onnxruntime")]
+impl GraphOptimization {
+    fn to_ort(self) -> GraphOptimizationLevel {
+        match self {
+            Self::Disable => GraphOptimizationLevel::Disable,
+            Self::Basic => GraphOptimizationLevel::Level1,
+            Self::Extended => GraphOptimizationLevel::Level2,
+            Self::All => GraphOptimizationLevel::Level3,
+        }
+    }
+}
+
+/// ONNX Runtime execution provider that runs the graph.
+///
+/// Providers other than [`Cpu`](Self::Cpu) take the nodes they have kernels
+/// for; ORT assigns every other node to the CPU provider automatically.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub enum ExecutionProvider {
+    /// ORT's built-in CPU kernels.
+    #[default]
+    Cpu,
+    /// XNNPACK's optimised CPU kernels, often faster on ARM64 for this
+    /// conv-heavy vocoder.  Requires the `xnnpack` Cargo feature.
+    Xnnpack,
+}
+
+impl ExecutionProvider {
+    pub const ALL: [Self; 2] = [Self::Cpu, Self::Xnnpack];
+
+    pub fn name(self) -> &'static str {
+        match self {
+            Self::Cpu => "cpu",
+            Self::Xnnpack => "xnnpack",
+        }
+    }
+
+    /// `true` if this build can register the provider.
+    pub fn is_compiled_in(self) -> bool {
+        match self {
+            Self::Cpu => cfg!(feature = "onnxruntime"),
+            Self::Xnnpack => cfg!(feature = "xnnpack"),
+        }
+    }
+}
+
+impl std::str::FromStr for ExecutionProvider {
+    type Err = anyhow::Error;
+
+    fn from_str(s: &str) -> Result<Self> {
+        Self::ALL
+            .into_iter()
+            .find(|ep| ep.name().eq_ignore_ascii_case(s))
+            .with_context(|| format!("Unknown execution provider '{s}' (expected cpu or xnnpack)"))
+    }
+}
+
+/// Inference engine built by the `load*` constructors.
+///
+/// Options that configure ORT (threads, pool size, profiling, arena,
+/// execution provider, optimised-model cache) are ignored by the others.
+/// The default is ORT, or tract in builds without the `onnxruntime`
+/// feature, so every `load*` path (and the C API) works in either build.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum BackendKind {
+    /// ONNX Runtime.  Requires the `onnxruntime` Cargo feature (default).
+    Ort,
+    /// Pure-Rust [`crate::backend::TractBackend`].  Requires the `tract`
+    /// Cargo feature.
+    Tract,
+}
+
+impl Default for BackendKind {
+    fn default() -> Self {
+        if cfg!(feature = "onnxruntime") {
+            Self::Ort
+        } else {
+            Self::Tract
+        }
+    }
+}
+
+/// How ORT's CPU arena grows when a request needs more than it holds.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ArenaExtend {
+    /// Double the last chunk (ORT's default): few, large allocations.
+    NextPowerOfTwo = 0,
+    /// Allocate exactly what the request needs: tighter, more allocations.
+    SameAsRequested = 1,
+}
+
+/// Sizing of ORT's CPU memory arena.  `None` fields keep ORT's defaults.
+///
+/// The arena is process-wide (see [`crate::runtime`]): every model loaded
+/// with arena options shares it, and they must all ask for the same ones.
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct ArenaOptions {
+    /// Size of the first chunk reserved on the first run.
+    pub initial_chunk_bytes: Option<usize>,
+    pub extend: Option<ArenaExtend>,
+    /// Upper bound on the arena; runs needing more fail instead of growing it.
+    pub max_bytes: Option<usize>,
+}
+
+/// When pooled sessions hand unused arena memory back to the allocator.
+///
+/// ORT grows its arena to the largest input seen and keeps it, so one long
+/// chunk leaves a worker at peak size for good.  A shrink frees every arena
+/// chunk not in use once the run that requests it finishes.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub enum ArenaShrink {
+    /// Keep the arena at its high-water mark (ORT's default).
+    #[default]
+    Never,
+    /// After every run.  Lowest footprint; each run re-grows the arena.
+    EveryRun,
+    /// After runs of at least `min_tokens` input tokens — the ones that
+    /// grow the arena past what ordinary chunks need.
+    AfterLongInput { min_tokens: usize },
+}
+
+#[cfg(feature = "onnxruntime")]
+impl ArenaShrink {
+    fn applies(self, seq_len: usize) -> bool {
+        match self {
+            Self::Never => false,
+            Self::EveryRun => true,
+            Self::AfterLongInput { min_tokens } => seq_len >= min_tokens,
+        }
+    }
+}
+
+/// Run options that make ORT shrink the CPU arena when the run ends.
+#[cfg(feature = "onnxruntime")]
+fn shrink_run_options() -> Result<RunOptions> {
+    let mut options = RunOptions::new().context("Failed to create ORT run options")?;
+    options
+        .add_config_entry("memory.enable_memory_arena_shrinkage", "cpu:0")
+        .context("Failed to enable arena shrinkage")?;
+    Ok(options)
+}
+
+/// Tuning knobs for [`KittenTtsOnnx::load_with_options`].
+///
+/// `LoadOptions::default()` reproduces [`KittenTtsOnnx::load`].
+#[derive(Debug, Clone, Default)]
+pub struct LoadOptions {
+    /// Enable ONNX Runtime's per-operator profiler for a bounded number of
+    /// runs (see [`crate::profiling`]).  Only the first pooled session is
+    /// profiled.
+    pub profiling: Option<ProfilingOptions>,
+    /// Threads ORT uses inside one operator.  `None` keeps ORT's default
+    /// (one per physical core).  Ignored with `shared_threads`.
+    pub intra_threads: Option<usize>,
+    /// Threads ORT uses to run independent graph branches in parallel.
+    /// `None` (or 1) keeps sequential execution.  Ignored with `shared_threads`.
+    pub inter_threads: Option<usize>,
+    /// Run every session on the process-wide ORT thread pools (see
+    /// [`crate::runtime`]) instead of giving each its own, so a session
+    /// pool or several models don't oversubscribe the cores.
+    pub shared_threads: bool,
+    /// Let pooled sessions share one copy of the weights ORT prepacks for
+    /// its kernels (e.g. MatMul/Conv layouts) instead of each packing its
+    /// own.  Other initializers are still held per session.  No effect
+    /// with `session_pool_size` ≤ 1.
+    pub share_prepacked_weights: bool,
+    /// Number of independent ORT sessions.  Each can run one inference at a
+    /// time, so this bounds concurrent `generate` calls; every session holds
+    /// its own copy of the weights.  `0` is treated as 1.
+    pub session_pool_size: usize,
+    /// Graph optimisation level.  `None` keeps ORT's default ([`GraphOptimization::All`]).
+    pub optimization_level: Option<GraphOptimization>,
+    /// Cache for the optimised graph.  If the file is newer than the model
+    /// it is loaded instead, skipping optimisation.  Otherwise ORT writes
+    /// the optimised graph there for the next load.
+    pub optimized_model_path: Option<PathBuf>,
+    /// Run one short inference on every session before returning, so the
+    /// first real request doesn't pay for ORT's lazy initialisation.
+    pub warm_up: bool,
+    /// Read only the voice names at load and decompress each voice's style
+    /// matrix on first use.  Saves memory and load time when a host uses
+    /// only a few of the bundled voices.
+    pub lazy_voices: bool,
+    /// CPU arena sizing.  `None` keeps each session's default arena.
+    pub arena: Option<ArenaOptions>,
+    /// When to shrink the arena after a run.  Independent of `arena`.
+    pub arena_shrink: ArenaShrink,
+    /// Execution provider to run the graph on.  With XNNPACK,
+    /// `intra_threads` sizes XNNPACK's pool and ORT's own intra-op pool is
+    /// reduced to the calling thread.
+    pub execution_provider: ExecutionProvider,
+    /// Inference engine; see [`crate::backend`].
+    pub backend: BackendKind,
+}
+
+/// Wrap an ORT error with a context message.
+///
+/// Session-builder errors carry the builder itself, so they are flattened to
+/// their message instead of going through [`Context`].
+#[cfg(feature = "onnxruntime")]
+fn ort_err<E: std::fmt::Display>(context: &'static str) -> impl FnOnce(E) -> anyhow::Error {
+    move |e| anyhow::anyhow!("{context}: {e}")
+}
+
+/// `true` if `cache` exists and is at least as new as `model`.
+#[cfg(feature = "onnxruntime")]
+fn cache_is_fresh(cache: &Path, model: &Path) -> bool {
+    let mtime = |p: &Path| std::fs::metadata(p).and_then(|m| m.modified()).ok();
+    matches!((mtime(cache), mtime(model)), (Some(c), Some(m)) if c >= m)
+}
+
+/// A model's sessions and the prepacked-weight store they share.
+#[cfg(feature = "onnxruntime")]
+struct SessionPool {
+    sessions: Vec<Mutex<Session>>,
+    prepacked: Option<PrepackedWeights>,
+    /// The first session was built from a fresh optimised-graph cache.
+    cache_hit: bool,
+}
+
+/// One session per pool slot; only the first is profiled.
+#[cfg(feature = "onnxruntime")]
+fn build_sessions(model: ModelSource<'_>, options: &LoadOptions) -> Result<SessionPool> {
+    let size = options.session_pool_size.max(1);
+    let prepacked = (options.share_prepacked_weights && size > 1).then(PrepackedWeights::new);
+    let mut cache_hit = false;
+    let sessions = (0..size)
+        .map(|i| {
+            let (session, hit) = build_session(model, options, prepacked.as_ref(), i == 0)?;
+            cache_hit |= i == 0 && hit;
+            Ok(Mutex::new(session))
+        })
+        .collect::<Result<_>>()?;
+    Ok(SessionPool { sessions, prepacked, cache_hit })
+}
+
+fn build_backend(model: ModelSource<'_>, options: &LoadOptions) -> Result<Backend> {
+    match options.backend {
+        BackendKind::Ort => build_ort(model, options),
+        BackendKind::Tract => build_tract(model).map(Backend::Dyn),
+    }
+}
+
+#[cfg(feature = "onnxruntime")]
+fn build_ort(model: ModelSource<'_>, options: &LoadOptions) -> Result<Backend> {
+    OrtBackend::build(model, options).map(Backend::Ort)
+}
+
+#[cfg(not(feature = "onnxruntime"))]
+fn build_ort(_model: ModelSource<'_>, _options: &LoadOptions) -> Result<Backend> {
+    anyhow::bail!("The ORT backend requires the `onnxruntime` Cargo feature; use BackendKind::Tract")
+}
+
+#[cfg(feature = "tract")]
+fn build_tract(model: ModelSource<'_>) -> Result<Box<dyn InferenceBackend>> {
+    use crate::backend::TractBackend;
+    let backend = match model {
+        ModelSource::File(path) => TractBackend::load(path)?,
+        ModelSource::Memory(bytes) => TractBackend::from_bytes(bytes)?,
+    };
+    Ok(Box::new(backend))
+}
+
+#[cfg(not(feature = "tract"))]
+fn build_tract(_model: ModelSource<'_>) -> Result<Box<dyn InferenceBackend>> {
+    anyhow::bail!("The tract backend requires the `tract` Cargo feature")
+}
+
+/// Where the ONNX graph is read from.
+#[derive(Clone, Copy)]
+enum ModelSource<'a> {
+    File(&'a Path),
+    /// Serialized model bytes; ORT copies what it needs while building the
+    /// session, so the buffer may be released afterwards.
+    Memory(&'a [u8]),
+}
+
+/// Register XNNPACK ahead of the CPU provider with a pool of `threads`
+/// (default: one per logical CPU).  Fails if this ORT build lacks it.
+#[cfg(feature = "xnnpack")]
+fn with_xnnpack(builder: SessionBuilder, threads: Option<usize>) -> Result<SessionBuilder> {
+    use ort::execution_providers::XNNPACKExecutionProvider;
+    use std::num::NonZeroUsize;
+
+    let threads = threads
+        .and_then(NonZeroUsize::new)
+        .or_else(|| std::thread::available_parallelism().ok())
+        .unwrap_or(NonZeroUsize::MIN);
+    let xnnpack = XNNPACKExecutionProvider::default().with_intra_op_num_threads(threads);
+    builder
+        // Spinning ORT threads would compete with XNNPACK's pool for cores.
+        .with_config_entry("session.intra_op.allow_spinning", "0")
+        .and_then(|b| b.with_execution_providers([xnnpack.build().error_on_failure()]))
+        .map_err(ort_err("Failed to register the XNNPACK execution provider"))
+}
+
+#[cfg(all(feature = "onnxruntime", not(feature = "xnnpack")))]
+fn with_xnnpack(_builder: SessionBuilder, _threads: Option<usize>) -> Result<SessionBuilder> {
+    anyhow::bail!("The XNNPACK execution provider requires the `xnnpack` Cargo feature")
+}
+
+/// Build one ORT session for `model` configured by `options`.  Sessions
+/// given the same `prepacked` store pack each weight once between them.
+/// Profiling is enabled only when `profile` is set.
+#[cfg(feature = "onnxruntime")]
+fn build_session(
+    model: ModelSource<'_>,
+    options: &LoadOptions,
+    prepacked: Option<&PrepackedWeights>,
+    profile: bool,
+) -> Result<(Session, bool)> {
+    // The shared pools live in ORT's environment, which the first session
+    // builder creates, so they must exist before `Session::builder()`.
+    let shared = options.shared_threads.then(runtime::ensure_shared).transpose()?;
+    if let Some(arena) = &options.arena {
+        runtime::ensure_arena(arena)?;
+    }
+    let mut builder = Session::builder().context("Failed to create ORT session builder")?;
+    if options.arena.is_some() {
+        builder = builder
+            .with_config_entry("session.use_env_allocators", "1")
+            .map_err(ort_err("Failed to use the shared CPU arena"))?;
+    }
+    if let Some(pool) = shared {
+        builder = builder
+            .with_disable_per_session_threads()
+            .map_err(ort_err("Failed to disable per-session threads"))?;
+        if pool.inter_threads.is_some_and(|n| n > 1) {
+            builder = builder
+                .with_parallel_execution(true)
+                .map_err(ort_err("Failed to enable parallel execution"))?;
+        }
+    } else {
+        // XNNPACK gets the requested threads (below); ORT's pool then only
+        // runs fallback nodes, on the calling thread.
+        let intra = match options.execution_provider {
+            ExecutionProvider::Cpu => options.intra_threads,
+            ExecutionProvider::Xnnpack => Some(1),
+        };
+        if let Some(n) = intra {
+            builder =
+                builder.with_intra_threads(n).map_err(ort_err("Failed to set intra-op threads"))?;
+        }
+        if let Some(n) = options.inter_threads.filter(|&n| n > 1) {
+            builder = builder
+                .with_parallel_execution(true)
+                .and_then(|b| b.with_inter_threads(n))
+                .map_err(ort_err("Failed to set inter-op threads"))?;
+        }
+    }
+    if options.execution_provider == ExecutionProvider::Xnnpack {
+        builder = with_xnnpack(builder, options.intra_threads)?;
+    }
+
+    // A fresh optimised-graph cache is loaded as-is; otherwise optimise the
+    // original model and ask ORT to save the result there.  In-memory models
+    // have no timestamp to compare against, so their cache is only written.
+    // Freshness is checked here, before this session writes the cache.
+    let mut source = model;
+    let mut level = options.optimization_level;
+    let mut cache_hit = false;
+    match (&options.optimized_model_path, model) {
+        (Some(cache), ModelSource::File(path)) if cache_is_fresh(cache, path) => {
+            source = ModelSource::File(cache);
+            level = Some(GraphOptimization::Disable);
+            cache_hit = true;
+        }
+        (Some(cache), _) => {
+            builder = builder
+                .with_optimized_model_path(cache)
+                .map_err(ort_err("Failed to set optimized model path"))?;
+        }
+        (None, _) => {}
+    }
+    if let Some(level) = level {
+        builder = builder
+            .with_optimization_level(level.to_ort())
+            .map_err(ort_err("Failed to set graph optimization level"))?;
+    }
+
+    if let Some(prepacked) = prepacked {
+        builder = builder
+            .with_prepacked_weights(prepacked)
+            .map_err(ort_err("Failed to share prepacked weights"))?;
+    }
+    if let (true, Some(profiling)) = (profile, &options.profiling) {
+        builder = builder
+            .with_profiling(&profiling.prefix)
+            .map_err(ort_err("Failed to enable ORT profiling"))?;
+    }
+    let session = match source {
+        ModelSource::File(path) => builder
+            .commit_from_file(path)
+            .with_context(|| format!("Cannot load ONNX model: {}", path.display()))?,
+        ModelSource::Memory(bytes) => builder
+            .commit_from_memory(bytes)
+            .context("Cannot load ONNX model from memory")?,
+    };
+    Ok((session, cache_hit))
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// ORT backend
+// ─────────────────────────────────────────────────────────────────────────────
+
+/// The default backend: a pool of ORT sessions, each running one inference
+/// at a time.
+#[cfg(feature = "onnxruntime")]
+struct OrtBackend {
+    /// Pool of independent sessions; `infer` takes any idle one.
+    sessions: Vec<Mutex<Session>>,
+    /// Shared by `sessions` when `share_prepacked_weights` is set; declared
+    /// after them so it is dropped last.
+    _prepacked: Option<PrepackedWeights>,
+    /// Round-robin start point for picking a session.
+    next_session: AtomicUsize,
+    /// Profiles `sessions[0]` only.
+    profiler: Option<Mutex<SessionProfiler>>,
+    waits: AtomicU64,
+    arena_shrink: ArenaShrink,
+    /// Passed to the runs `arena_shrink` selects; `None` with `Never`.
+    shrink_run: Option<RunOptions>,
+    arena_shrinks: AtomicU64,
+    last_shrink_rss: Mutex<Option<(u64, u64)>>,
+    /// Built from a fresh `optimized_model_path` cache.
+    cache_hit: bool,
+}
+
+#[cfg(feature = "onnxruntime")]
+impl OrtBackend {
+    fn build(model: ModelSource<'_>, options: &LoadOptions) -> Result<Self> {
+        let SessionPool { sessions, prepacked, cache_hit } = build_sessions(model, options)?;
+        Ok(Self {
+            sessions,
+            _prepacked: prepacked,
+            next_session: AtomicUsize::new(0),
+            profiler: options.profiling.as_ref().map(|p| Mutex::new(SessionProfiler::new(p))),
+            waits: AtomicU64::new(0),
+            arena_shrink: options.arena_shrink,
+            shrink_run: (options.arena_shrink != ArenaShrink::Never)
+                .then(shrink_run_options)
+                .transpose()?,
+            arena_shrinks: AtomicU64::new(0),
+            last_shrink_rss: Mutex::new(None),
+            cache_hit,
+        })
+    }
+
+    /// Lock an idle session, preferring round-robin order; if every session
+    /// is busy, wait for one.
+    fn acquire_session(&self) -> (usize, MutexGuard<'_, Session>) {
+        let n = self.sessions.len();
+        let start = self.next_session.fetch_add(1, Ordering::Relaxed) % n;
+        for k in 0..n {
+            let i = (start + k) % n;
+            match self.sessions[i].try_lock() {
+                Ok(guard) => return (i, guard),
+                Err(TryLockError::WouldBlock) => continue,
+                Err(TryLockError::Poisoned(_)) => panic!("ORT session mutex poisoned"),
+            }
+        }
+        self.waits.fetch_add(1, Ordering::Relaxed);
+        (start, self.sessions[start].lock().expect("ORT session mutex poisoned"))
+    }
+
+    fn shrink(&self, style: &[f32]) -> Result<()> {
+        let owned;
+        let run_options = match &self.shrink_run {
+            Some(run_options) => run_options,
+            None => {
+                owned = shrink_run_options()?;
+                &owned
+            }
+        };
+        let rss_before = stats::current_rss_bytes().unwrap_or(0);
+        self.run_short_on_all(style, Some(run_options))?;
+        self.record_shrink(rss_before);
+        Ok(())
+    }
+
+    fn run_short_on_all(&self, style: &[f32], run_options: Option<&RunOptions>) -> Result<()> {
+        for session in &self.sessions {
+            let ids = ipa_to_ids("həlˈoʊ");
+            let seq_len = ids.len();
+            let inputs = ort::inputs![
+                Tensor::<i64>::from_array(([1usize, seq_len], ids))?,
+                Tensor::<f32>::from_array(([1usize, style.len()], style.to_vec()))?,
+                Tensor::<f32>::from_array(([1usize], vec![1.0f32]))?
+            ];
+            let mut session = session.lock().expect("ORT session mutex poisoned");
+            match run_options {
+                Some(run_options) => session.run_with_options(inputs, run_options),
+                None => session.run(inputs),
+            }
+            .context("ONNX inference failed")?;
+        }
+        Ok(())
+    }
+
+    /// Count an arena shrink that started at `rss_before` bytes.
+    fn record_shrink(&self, rss_before: u64) {
+        let rss_after = stats::current_rss_bytes().unwrap_or(0);
+        self.arena_shrinks.fetch_add(1, Ordering::Relaxed);
+        *self.last_shrink_rss.lock().expect("stats mutex poisoned") = Some((rss_before, rss_after));
+    }
+
+    fn profile_report(&self) -> Option<ProfileReport> {
+        let profiler = self.profiler.as_ref()?;
+        profiler.lock().expect("profiler mutex poisoned").report().cloned()
+    }
+
+    fn finish_profiling(&self) -> Option<ProfileReport> {
+        let profiler = self.profiler.as_ref()?;
+        let mut session = self.sessions[0].lock().expect("ORT session mutex poisoned");
+        let mut profiler = profiler.lock().expect("profiler mutex poisoned");
+        profiler.finish(&mut session);
+        profiler.report().cloned()
+    }
+}
+
+#[cfg(feature = "onnxruntime")]
+impl InferenceBackend for OrtBackend {
+    fn name(&self) -> &'static str {
+        "ort"
+    }
+
+    fn infer(&self, input_ids: Vec<i64>, style: &[f32], speed: f32) -> Result<Vec<f32>> {
+        // Inputs are positional (matching the ONNX graph input order):
+        //   0 → input_ids  [1, seq_len]  i64
+        //   1 → style      [1, style_d]  f32
+        //   2 → speed      [1]           f32
+        let seq_len = input_ids.len();
+        let t_input_ids = Tensor::<i64>::from_array(([1usize, seq_len], input_ids))
+            .context("Failed to build input_ids tensor")?;
+
+        let t_style = Tensor::<f32>::from_array(([1usize, style.len()], style.to_vec()))
+            .context("Failed to build style tensor")?;
+
+        let t_speed = Tensor::<f32>::from_array(([1usize], vec![speed]))
+            .context("Failed to build speed tensor")?;
+
+        let shrink = self.shrink_run.as_ref().filter(|_| self.arena_shrink.applies(seq_len));
+        let rss_before = shrink.map(|_| stats::current_rss_bytes().unwrap_or(0));
+        let (session_idx, mut session) = self.acquire_session();
+        let audio: Vec<f32> = {
+            let outputs = {
+                let _run = tracing::info_span!("ort_run", seq_len).entered();
+                let inputs = ort::inputs![t_input_ids, t_style, t_speed];
+                match shrink {
+                    Some(run_options) => session.run_with_options(inputs, run_options),
+                    None => session.run(inputs),
+                }
+                .context("ONNX inference failed")?
+            };
+
+            // Output 0 is the raw waveform (shape e.g. [1, T] or [T]).
+            let (_shape, audio_data) = outputs[0]
+                .try_extract_tensor::<f32>()
+                .context("Failed to extract audio tensor")?;
+            audio_data.to_vec()
+        };
+        if let (0, Some(profiler)) = (session_idx, &self.profiler) {
+            profiler.lock().expect("profiler mutex poisoned").after_run(&mut session, seq_len);
+        }
+        drop(session);
+        if let Some(rss_before) = rss_before {
+            self.record_shrink(rss_before);
+        }
+        Ok(audio)
+    }
+
+    fn concurrency(&self) -> usize {
+        self.sessions.len()
+    }
+
+    fn waits(&self) -> u64 {
+        self.waits.load(Ordering::Relaxed)
+    }
+
+    fn warm_up(&self, style: &[f32]) -> Result<()> {
+        self.run_short_on_all(style, None)
+    }
+}
+
+/// The engine a model runs on.  ORT stays concrete for its extra controls
+/// (profiling, arena shrinking); anything else is a trait object.
+enum Backend {
+    #[cfg(feature = "onnxruntime")]
+    Ort(OrtBackend),
+    Dyn(Box<dyn InferenceBackend>),
+}
+
+impl Backend {
+    fn get(&self) -> &dyn InferenceBackend {
+        match self {
+            #[cfg(feature = "onnxruntime")]
+            Self::Ort(ort) => ort,
+            Self::Dyn(backend) => backend.as_ref(),
+        }
+    }
+
+    #[cfg(feature = "onnxruntime")]
+    fn ort(&self) -> Option<&OrtBackend> {
+        match self {
+            Self::Ort(ort) => Some(ort),
+            Self::Dyn(_) => None,
+        }
     }
 }
 
@@ -117,8 +870,13 @@ impl Voice {
 
 /// The main TTS model handle.
 pub struct KittenTtsOnnx {
-    session: Mutex<Session>,
-    voices: HashMap<String, Voice>,
+    backend: Backend,
+    /// Per-request totals; the hot-path counters below are kept apart so
+    /// inference never takes this lock.
+    engine: Mutex<EngineStats>,
+    voice_hits: AtomicU64,
+    voice_misses: AtomicU64,
+    voices: VoiceStore,
     speed_priors: HashMap<String, f32>,
     voice_aliases: HashMap<String, String>,
     #[cfg(feature = "espeak")]
@@ -134,29 +892,220 @@ impl KittenTtsOnnx {
         speed_priors: HashMap<String, f32>,
         voice_aliases: HashMap<String, String>,
     ) -> Result<Self> {
-        // ── Load ONNX model with ONNX Runtime ───────────────────────────────
-        let session = Session::builder()
-            .context("Failed to create ORT session builder")?
-            .commit_from_file(model_path)
-            .with_context(|| format!("Cannot load ONNX model: {}", model_path.display()))?;
+        Self::load_with_options(
+            model_path,
+            voices_path,
+            speed_priors,
+            voice_aliases,
+            &LoadOptions::default(),
+        )
+    }
 
-        // ── Voice embeddings ─────────────────────────────────────────────────
-        let raw = load_npz(voices_path)
-            .with_context(|| format!("Cannot load voices: {}", voices_path.display()))?;
+    /// [`load`](Self::load) with explicit [`LoadOptions`].
+    ///
+    /// Voices are decoded on a second thread while the ONNX sessions build.
+    pub fn load_with_options(
+        model_path: &Path,
+        voices_path: &Path,
+        speed_priors: HashMap<String, f32>,
+        voice_aliases: HashMap<String, String>,
+        options: &LoadOptions,
+    ) -> Result<Self> {
+        Self::load_concurrent(
+            || Ok(model_path.to_path_buf()),
+            || Ok(voices_path.to_path_buf()),
+            speed_priors,
+            voice_aliases,
+            options,
+        )
+    }
 
-        let available_voices: Vec<String> = raw.keys().cloned().collect();
-        let voices: HashMap<String, Voice> =
-            raw.into_iter().map(|(k, v)| (k, Voice::from_npy(v))).collect();
+    /// Load with both files obtained concurrently, e.g. downloaded.
+    ///
+    /// `model` runs on the calling thread, which then builds the sessions;
+    /// `voices` runs on a scoped thread, which then decodes the voices.  A
+    /// model error takes precedence over a voices error.
+    pub(crate) fn load_concurrent(
+        model: impl FnOnce() -> Result<PathBuf>,
+        voices: impl FnOnce() -> Result<PathBuf> + Send,
+        speed_priors: HashMap<String, f32>,
+        voice_aliases: HashMap<String, String>,
+        options: &LoadOptions,
+    ) -> Result<Self> {
+        std::thread::scope(|s| {
+            let voices = s.spawn(|| {
+                let voices_path = voices()?;
+                VoiceStore::load(&voices_path, options.lazy_voices)
+                    .with_context(|| format!("Cannot load voices: {}", voices_path.display()))
+            });
+            let backend =
+                model().and_then(|model_path| build_backend(ModelSource::File(&model_path), options));
+            let voices = voices.join().expect("voice loader panicked");
+            let backend = backend?;
+            let (voices, available_voices) = voices?;
+            Self::from_parts(backend, voices, available_voices, speed_priors, voice_aliases, options)
+        })
+    }
 
-        Ok(Self {
-            session: Mutex::new(session),
+    /// [`load_with_options`](Self::load_with_options) from serialized model
+    /// and `voices.npz` bytes, e.g. regions of an mmap'd APK asset or app
+    /// bundle.  Neither buffer is referenced after this returns.
+    ///
+    /// Voices are always parsed eagerly here; `options.lazy_voices` applies
+    /// to file-backed voices only.
+    pub fn load_from_memory(
+        model_bytes: &[u8],
+        voices_bytes: &[u8],
+        speed_priors: HashMap<String, f32>,
+        voice_aliases: HashMap<String, String>,
+        options: &LoadOptions,
+    ) -> Result<Self> {
+        let (backend, voices) = std::thread::scope(|s| {
+            let voices = s.spawn(|| {
+                VoiceStore::from_bytes(voices_bytes).context("Cannot load voices from memory")
+            });
+            let backend = build_backend(ModelSource::Memory(model_bytes), options);
+            (backend, voices.join().expect("voice loader panicked"))
+        });
+        let backend = backend?;
+        let (voices, available_voices) = voices?;
+        Self::from_parts(backend, voices, available_voices, speed_priors, voice_aliases, options)
+    }
+
+    /// Load a `.kitten` bundle (see [`crate::bundle`]) through one mmap.
+    ///
+    /// The backend is built from the mapped ONNX bytes and voice rows are
+    /// read in place, so the voices cost no heap and share pages with other
+    /// processes using the same bundle.  `options.lazy_voices` has no effect.
+    pub fn load_bundle(path: &Path, options: &LoadOptions) -> Result<Self> {
+        let bundle = Bundle::open(path)?;
+        let backend = build_backend(ModelSource::Memory(bundle.model_bytes()), options)?;
+        let (voices, available_voices) = VoiceStore::from_bundle(&bundle);
+        Self::from_parts(
+            backend,
+            voices,
+            available_voices,
+            bundle.speed_priors().clone(),
+            bundle.voice_aliases().clone(),
+            options,
+        )
+    }
+
+    /// Wrap a caller-built backend, e.g. a [`crate::backend::MockBackend`],
+    /// with voices already in memory.  `options.backend` is ignored; of the
+    /// other options only `warm_up` applies.
+    pub fn from_backend(
+        backend: Box<dyn InferenceBackend>,
+        voices: HashMap<String, NpyArray>,
+        speed_priors: HashMap<String, f32>,
+        voice_aliases: HashMap<String, String>,
+        options: &LoadOptions,
+    ) -> Result<Self> {
+        let (voices, available_voices) = VoiceStore::eager(voices);
+        Self::from_parts(
+            Backend::Dyn(backend),
+            voices,
+            available_voices,
+            speed_priors,
+            voice_aliases,
+            options,
+        )
+    }
+
+    fn from_parts(
+        backend: Backend,
+        voices: VoiceStore,
+        available_voices: Vec<String>,
+        speed_priors: HashMap<String, f32>,
+        voice_aliases: HashMap<String, String>,
+        options: &LoadOptions,
+    ) -> Result<Self> {
+        let engine = EngineStats {
+            #[cfg(feature = "onnxruntime")]
+            optimized_model_cache_hit: backend.ort().is_some_and(|ort| ort.cache_hit),
+            ..Default::default()
+        };
+        let model = Self {
+            backend,
+            engine: Mutex::new(engine),
+            voice_hits: AtomicU64::new(0),
+            voice_misses: AtomicU64::new(0),
             voices,
             speed_priors,
             voice_aliases,
             #[cfg(feature = "espeak")]
             preprocessor: TextPreprocessor::new(),
             available_voices,
-        })
+        };
+        if options.warm_up {
+            model.warm_up().context("Warm-up inference failed")?;
+        }
+        Ok(model)
+    }
+
+    /// Run one short inference on every pooled session.
+    fn warm_up(&self) -> Result<()> {
+        match self.probe_style()? {
+            Some(style) => self.backend.get().warm_up(style),
+            None => Ok(()),
+        }
+    }
+
+    /// Shrink every session's CPU arena now, e.g. from a host's idle timer.
+    ///
+    /// ORT only shrinks at the end of a run, so this runs one short
+    /// inference per session (waiting for busy ones).  Recorded in
+    /// [`EngineStats::arena_shrinks`] like policy-driven shrinks.  A no-op
+    /// on backends other than ORT.
+    pub fn shrink_arena(&self) -> Result<()> {
+        #[cfg(feature = "onnxruntime")]
+        if let (Some(ort), Some(style)) = (self.backend.ort(), self.probe_style()?) {
+            return ort.shrink(style);
+        }
+        Ok(())
+    }
+
+    /// Style row for warm-up and shrink runs, from the first voice.
+    fn probe_style(&self) -> Result<Option<&[f32]>> {
+        let Some(first) = self.available_voices.first() else {
+            return Ok(None);
+        };
+        let voice = self.voices.get(first)?.context("voice list out of sync")?;
+        Ok(Some(voice.style_row(0)))
+    }
+
+    /// Inferences the backend runs at once: the number of sessions in the
+    /// pool with ORT.
+    pub fn session_pool_size(&self) -> usize {
+        self.backend.get().concurrency()
+    }
+
+    /// Name of the inference backend, e.g. `"ort"` or `"tract"`.
+    pub fn backend_name(&self) -> &'static str {
+        self.backend.get().name()
+    }
+
+    // ── Statistics ────────────────────────────────────────────────────────────
+
+    /// Cumulative counters since the model was loaded.
+    pub fn engine_stats(&self) -> EngineStats {
+        let mut engine = self.engine.lock().expect("stats mutex poisoned").clone();
+        engine.session_waits = self.backend.get().waits();
+        #[cfg(feature = "onnxruntime")]
+        if let Some(ort) = self.backend.ort() {
+            engine.arena_shrinks = ort.arena_shrinks.load(Ordering::Relaxed);
+            engine.last_shrink_rss = *ort.last_shrink_rss.lock().expect("stats mutex poisoned");
+        }
+        engine.voice_cache_hits = self.voice_hits.load(Ordering::Relaxed);
+        engine.voice_cache_misses = self.voice_misses.load(Ordering::Relaxed);
+        engine
+    }
+
+    /// Fold a finished request into the engine totals and remember it as
+    /// this thread's last call.
+    fn record(&self, stats: &GenerationStats) {
+        self.engine.lock().expect("stats mutex poisoned").record(stats);
+        stats::set_last_call(stats.clone());
     }
 
     // ── Helpers ───────────────────────────────────────────────────────────────
@@ -165,62 +1114,85 @@ impl KittenTtsOnnx {
         self.voice_aliases.get(voice).map(String::as_str).unwrap_or(voice)
     }
 
+    /// `true` if `voice` (or the voice it aliases) is in the voices file.
+    pub fn has_voice(&self, voice: &str) -> bool {
+        self.voices.contains(self.resolve_voice(voice))
+    }
+
+    // ── ORT profiling ─────────────────────────────────────────────────────────
+
+    /// Summary of the ORT profiling window, once it has completed.
+    ///
+    /// Returns `None` when profiling was not enabled in [`LoadOptions`] or
+    /// fewer than [`ProfilingOptions::max_runs`] runs have happened so far,
+    /// and always on backends other than ORT.
+    pub fn profile_report(&self) -> Option<ProfileReport> {
+        #[cfg(feature = "onnxruntime")]
+        if let Some(ort) = self.backend.ort() {
+            return ort.profile_report();
+        }
+        None
+    }
+
+    /// Stop ORT profiling now, before the run budget is spent, and return the
+    /// summary of what was recorded.
+    pub fn finish_profiling(&self) -> Option<ProfileReport> {
+        #[cfg(feature = "onnxruntime")]
+        if let Some(ort) = self.backend.ort() {
+            return ort.finish_profiling();
+        }
+        None
+    }
+
     /// Core inference step: IPA string → audio samples.
     ///
     /// `style_idx` selects which row of the voice style matrix to use.
     /// Pass `text.len()` when the caller has the original text, or `ipa.len()`
     /// when only the IPA is available — both are clamped to the matrix bounds.
+    ///
+    /// Adds this chunk's tokenise / inference time, tokens and samples to
+    /// `stats`.
     fn infer_ipa(
         &self,
         ipa: &str,
         style_idx: usize,
         voice_key: &str,
         effective_speed: f32,
+        stats: &mut GenerationStats,
     ) -> Result<Vec<f32>> {
-        let voice_data = self.voices.get(voice_key).with_context(|| {
+        let span = tracing::info_span!("infer_ipa", seq_len = Empty, style_idx, samples = Empty);
+        let _enter = span.enter();
+
+        let counter = if self.voices.is_loaded(voice_key) { &self.voice_hits } else { &self.voice_misses };
+        counter.fetch_add(1, Ordering::Relaxed);
+        let voice_data = self.voices.get(voice_key)?.with_context(|| {
             format!("Voice '{}' not found. Available: {:?}", voice_key, self.available_voices)
         })?;
 
         // ── Tokenise → [0, tok…, 0] ──────────────────────────────────────────
+        let timer = StageTimer::start();
         let ids = ipa_to_ids(ipa);
         let seq_len = ids.len();
+        span.record("seq_len", seq_len);
 
         // ── Style vector ──────────────────────────────────────────────────────
-        let style_slice = voice_data.style_row(style_idx);
-        let style_dim = style_slice.len();
-
-        // ── Build ORT tensors ─────────────────────────────────────────────────
-        //
-        // Inputs are positional (matching the ONNX graph input order):
-        //   0 → input_ids  [1, seq_len]  i64
-        //   1 → style      [1, style_d]  f32
-        //   2 → speed      [1]           f32
-
-        let t_input_ids = Tensor::<i64>::from_array(([1usize, seq_len], ids))
-            .context("Failed to build input_ids tensor")?;
-
-        let t_style = Tensor::<f32>::from_array(([1usize, style_dim], style_slice.to_vec()))
-            .context("Failed to build style tensor")?;
-
-        let t_speed = Tensor::<f32>::from_array(([1usize], vec![effective_speed]))
-            .context("Failed to build speed tensor")?;
+        let style = voice_data.style_row(style_idx);
+        stats.tokenize.merge(timer.stop());
 
         // ── Inference ─────────────────────────────────────────────────────────
-        let mut session = self.session.lock().expect("ORT session mutex poisoned");
-        let outputs = session
-            .run(ort::inputs![t_input_ids, t_style, t_speed])
-            .context("ONNX inference failed")?;
-
-        // Output 0 is the raw waveform (shape e.g. [1, T] or [T]).
-        let (_shape, audio_data) = outputs[0]
-            .try_extract_tensor::<f32>()
-            .context("Failed to extract audio tensor")?;
-
-        let audio_flat: Vec<f32> = audio_data.to_vec();
+        let timer = StageTimer::start();
+        let audio_flat = self.backend.get().infer(ids, style, effective_speed)?;
 
         // Trim trailing silence (matches Python `audio[..., :-5000]`)
         let trimmed_len = audio_flat.len().saturating_sub(TAIL_TRIM);
-        Ok(audio_flat[..trimmed_len].to_vec())
+        span.record("samples", trimmed_len);
+        let audio = audio_flat[..trimmed_len].to_vec();
+        stats.inference.merge(timer.stop());
+
+        stats.chunks += 1;
+        stats.tokens += seq_len;
+        stats.samples += audio.len();
+        Ok(audio)
     }
 
     // ── Text → audio (requires `espeak` feature) ──────────────────────────────
@@ -230,13 +1202,37 @@ impl KittenTtsOnnx {
     /// **Requires the `espeak` Cargo feature.**
     #[cfg(feature = "espeak")]
     pub fn generate_chunk(&self, text: &str, voice: &str, speed: f32) -> Result<Vec<f32>> {
+        self.generate_chunk_at(0, text, voice, speed, &mut GenerationStats::default())
+    }
+
+    /// [`generate_chunk`](Self::generate_chunk) for chunk number `index` of a
+    /// longer text, accumulating into `stats`.  The index labels the tracing
+    /// span.
+    #[cfg(feature = "espeak")]
+    fn generate_chunk_at(
+        &self,
+        index: usize,
+        text: &str,
+        voice: &str,
+        speed: f32,
+        stats: &mut GenerationStats,
+    ) -> Result<Vec<f32>> {
+        let span = tracing::info_span!(
+            "generate_chunk", chunk = index, text_len = text.len(), samples = Empty
+        );
+        let _enter = span.enter();
+
         let voice_key = self.resolve_voice(voice);
         let effective_speed = speed * self.speed_priors.get(voice_key).copied().unwrap_or(1.0);
 
+        let timer = StageTimer::start();
         let ipa = phonemize(text)
             .with_context(|| format!("Phonemisation failed for {:?}", text))?;
+        stats.phonemize.merge(timer.stop());
 
-        self.infer_ipa(&ipa, text.len(), voice_key, effective_speed)
+        let audio = self.infer_ipa(&ipa, text.len(), voice_key, effective_speed, stats)?;
+        span.record("samples", audio.len());
+        Ok(audio)
     }
 
     // ── IPA → audio (all platforms) ───────────────────────────────────────────
@@ -261,10 +1257,27 @@ impl KittenTtsOnnx {
         voice: &str,
         speed: f32,
         style_idx: usize,
+    ) -> Result<Vec<f32>> {
+        let total = StageTimer::start();
+        let mut stats = GenerationStats::default();
+        let audio = self.ipa_chunk(ipa, voice, speed, style_idx, &mut stats)?;
+        stats.total = total.stop();
+        self.record(&stats);
+        Ok(audio)
+    }
+
+    /// One IPA chunk, accumulating into `stats`.
+    fn ipa_chunk(
+        &self,
+        ipa: &str,
+        voice: &str,
+        speed: f32,
+        style_idx: usize,
+        stats: &mut GenerationStats,
     ) -> Result<Vec<f32>> {
         let voice_key = self.resolve_voice(voice);
         let effective_speed = speed * self.speed_priors.get(voice_key).copied().unwrap_or(1.0);
-        self.infer_ipa(ipa, style_idx, voice_key, effective_speed)
+        self.infer_ipa(ipa, style_idx, voice_key, effective_speed, stats)
     }
 
     /// Run inference on multiple pre-phonemized IPA chunks and concatenate.
@@ -278,20 +1291,113 @@ impl KittenTtsOnnx {
         speed: f32,
     ) -> Result<Vec<f32>> {
         let voice_key = self.resolve_voice(voice);
-        if !self.voices.contains_key(voice_key) {
+        if !self.voices.contains(voice_key) {
             anyhow::bail!(
                 "Unknown voice '{}'. Available: {:?}",
                 voice,
                 self.available_voices
             );
         }
+        let total = StageTimer::start();
+        let mut stats = GenerationStats::default();
         let mut audio = Vec::new();
         for &ipa in chunks {
-            audio.extend(self.generate_from_ipa(ipa, voice, speed, ipa.len())?);
+            audio.extend(self.ipa_chunk(ipa, voice, speed, ipa.len(), &mut stats)?);
         }
+        stats.total = total.stop();
+        self.record(&stats);
         Ok(audio)
     }
 
+    /// Synthesise each IPA string in `items` as a separate utterance.
+    ///
+    /// Items are shared among up to [`session_pool_size`](Self::session_pool_size)
+    /// threads, so a pool larger than one (see [`LoadOptions`]) synthesises
+    /// them in parallel.  Returns one buffer per item, in order; if any item
+    /// fails the whole batch fails with the lowest failing index.
+    pub fn generate_from_ipa_batch(
+        &self,
+        items: &[&str],
+        voice: &str,
+        speed: f32,
+    ) -> Result<Vec<Vec<f32>>> {
+        self.run_batch(items, |ipa| self.generate_from_ipa(ipa, voice, speed, ipa.len()))
+    }
+
+    /// [`generate_from_ipa_batch`](Self::generate_from_ipa_batch) for text.
+    ///
+    /// **Requires the `espeak` Cargo feature.**
+    #[cfg(feature = "espeak")]
+    pub fn generate_batch(
+        &self,
+        texts: &[&str],
+        voice: &str,
+        speed: f32,
+        clean_text: bool,
+    ) -> Result<Vec<Vec<f32>>> {
+        self.run_batch(texts, |text| self.generate(text, voice, speed, clean_text))
+    }
+
+    /// Apply `f` to every item on up to one thread per concurrent inference
+    /// the backend supports.
+    fn run_batch<T: Sync>(
+        &self,
+        items: &[T],
+        f: impl Fn(&T) -> Result<Vec<f32>> + Sync,
+    ) -> Result<Vec<Vec<f32>>> {
+        let label = |i: usize| move || format!("Batch item {i} failed");
+        // Each item records itself as its thread's last call; fold those
+        // into one record for the caller's thread.
+        let mut batch_stats = GenerationStats::default();
+        let workers = self.session_pool_size().min(items.len());
+        if workers <= 1 {
+            let results = items
+                .iter()
+                .enumerate()
+                .map(|(i, item)| {
+                    let r = f(item).with_context(label(i));
+                    batch_stats.merge(&stats::take_last_call().unwrap_or_default());
+                    r
+                })
+                .collect();
+            stats::set_last_call(batch_stats);
+            return results;
+        }
+
+        let next = AtomicUsize::new(0);
+        let mut results: Vec<Option<Result<Vec<f32>>>> = items.iter().map(|_| None).collect();
+        std::thread::scope(|s| {
+            let handles: Vec<_> = (0..workers)
+                .map(|_| {
+                    s.spawn(|| {
+                        let mut done = Vec::new();
+                        let mut worker_stats = GenerationStats::default();
+                        loop {
+                            let i = next.fetch_add(1, Ordering::Relaxed);
+                            let Some(item) = items.get(i) else { break };
+                            done.push((i, f(item)));
+                            worker_stats.merge(&stats::take_last_call().unwrap_or_default());
+                        }
+                        (done, worker_stats)
+                    })
+                })
+                .collect();
+            for h in handles {
+                let (done, worker_stats) = h.join().expect("batch worker panicked");
+                batch_stats.merge(&worker_stats);
+                for (i, r) in done {
+                    results[i] = Some(r);
+                }
+            }
+        });
+        stats::set_last_call(batch_stats);
+        results
+            .into_iter()
+            .enumerate()
+            .map(|(i, r)| r.expect("every batch item runs").with_context(label(i)))
+            .collect()
+    }
+
     /// Run inference from an IPA string and write a 32-bit float WAV file.
     ///
     /// Convenience wrapper around [`generate_from_ipa`] for the common case of
@@ -352,8 +1458,61 @@ impl KittenTtsOnnx {
         speed: f32,
         clean_text: bool,
     ) -> Result<Vec<f32>> {
+        self.generate_with_stats(text, voice, speed, clean_text).map(|(audio, _)| audio)
+    }
+
+    /// [`generate`](Self::generate), also returning per-stage timing (and,
+    /// with the `alloc-stats` feature, allocation counts) for the call.
+    ///
+    /// **Requires the `espeak` Cargo feature.**
+    #[cfg(feature = "espeak")]
+    pub fn generate_with_stats(
+        &self,
+        text: &str,
+        voice: &str,
+        speed: f32,
+        clean_text: bool,
+    ) -> Result<(Vec<f32>, GenerationStats)> {
+        let mut audio = Vec::new();
+        let stats = self.generate_streaming(text, voice, speed, clean_text, |_, chunk| {
+            audio.extend_from_slice(chunk);
+            true
+        })?;
+        Ok((audio, stats))
+    }
+
+    /// Generate audio from `text`, handing each chunk's samples to
+    /// `on_chunk(index, samples)` as soon as its inference finishes.
+    ///
+    /// Chunks are delivered in order on the calling thread.  Return `false`
+    /// from `on_chunk` to stop early; the remaining chunks are not
+    /// synthesised and the call still succeeds.  The returned stats cover
+    /// the chunks actually produced; `total` includes time spent inside
+    /// `on_chunk`.
+    ///
+    /// **Requires the `espeak` Cargo feature.**
+    #[cfg(feature = "espeak")]
+    pub fn generate_streaming<F>(
+        &self,
+        text: &str,
+        voice: &str,
+        speed: f32,
+        clean_text: bool,
+        mut on_chunk: F,
+    ) -> Result<GenerationStats>
+    where
+        F: FnMut(usize, &[f32]) -> bool,
+    {
+        let total = StageTimer::start();
+        let mut stats = GenerationStats::default();
+
+        let span = tracing::info_span!(
+            "generate", text_len = text.len(), chunks = Empty, samples = Empty
+        );
+        let _enter = span.enter();
+
         let voice_key = self.resolve_voice(voice);
-        if !self.voices.contains_key(voice_key) {
+        if !self.voices.contains(voice_key) {
             anyhow::bail!(
                 "Unknown voice '{}'. Available: {:?}",
                 voice,
@@ -361,22 +1520,27 @@ impl KittenTtsOnnx {
             );
         }
 
+        let timer = StageTimer::start();
         let processed = if clean_text {
             self.preprocessor.process(text)
         } else {
             text.to_string()
         };
+        stats.preprocess = timer.stop();
 
         let chunks = chunk_text(&processed, CHUNK_MAX_CHARS);
-        if chunks.is_empty() {
-            return Ok(Vec::new());
-        }
+        span.record("chunks", chunks.len());
 
-        let mut audio = Vec::new();
-        for chunk in &chunks {
-            audio.extend(self.generate_chunk(chunk, voice, speed)?);
+        for (i, chunk) in chunks.iter().enumerate() {
+            let audio = self.generate_chunk_at(i, chunk, voice, speed, &mut stats)?;
+            if !on_chunk(i, &audio) {
+                break;
+            }
         }
-        Ok(audio)
+        span.record("samples", stats.samples);
+        stats.total = total.stop();
+        self.record(&stats);
+        Ok(stats)
     }
 
     /// Generate audio from `text` and save it to a WAV file.
@@ -12,7 +12,7 @@
 use anyhow::{bail, Context, Result};
 use std::{
     collections::HashMap,
-    io::Read,
+    io::{Cursor, Read, Seek},
     path::Path,
 };
 use zip::ZipArchive;
@@ -187,11 +187,16 @@ impl NpyArray {
 
 /// Load an NPZ file and return all arrays indexed by name (`.npy` extension stripped).
 pub fn load_npz(path: &Path) -> Result<HashMap<String, NpyArray>> {
-    let file = std::fs::File::open(path)
-        .with_context(|| format!("Cannot open NPZ file: {}", path.display()))?;
-    let mut archive = ZipArchive::new(file)
-        .with_context(|| format!("Cannot open ZIP archive: {}", path.display()))?;
+    read_all(open_npz(path)?)
+}
 
+/// [`load_npz`] for an NPZ file already in memory (e.g. an mmap'd asset).
+pub fn load_npz_from_bytes(bytes: &[u8]) -> Result<HashMap<String, NpyArray>> {
+    let archive = ZipArchive::new(Cursor::new(bytes)).context("Cannot open ZIP archive")?;
+    read_all(archive)
+}
+
+fn read_all<R: Read + Seek>(mut archive: ZipArchive<R>) -> Result<HashMap<String, NpyArray>> {
     let mut arrays = HashMap::new();
 
     for i in 0..archive.len() {
@@ -200,17 +205,46 @@ pub fn load_npz(path: &Path) -> Result<HashMap<String, NpyArray>> {
             .name()
             .trim_end_matches(".npy")
             .to_string();
+        let size = entry.size();
+        let array = read_entry(&mut entry, &name, size)?;
+        arrays.insert(name, array);
+    }
 
-        let mut buf = Vec::with_capacity(entry.size() as usize);
-        entry.read_to_end(&mut buf).context("Failed to read NPY entry")?;
+    Ok(arrays)
+}
 
-        let (shape, data) = parse_npy(&buf)
-            .with_context(|| format!("Failed to parse NPY entry '{}'", name))?;
+/// List the array names in an NPZ file without decompressing any data.
+pub fn list_npz(path: &Path) -> Result<Vec<String>> {
+    let archive = open_npz(path)?;
+    Ok(archive.file_names().map(|n| n.trim_end_matches(".npy").to_string()).collect())
+}
 
-        arrays.insert(name, NpyArray { shape, data });
-    }
+/// Load a single array by name (without the `.npy` extension).
+pub fn load_npz_entry(path: &Path, name: &str) -> Result<NpyArray> {
+    let mut archive = open_npz(path)?;
+    let mut entry = archive
+        .by_name(&format!("{name}.npy"))
+        .with_context(|| format!("Array '{}' not found in {}", name, path.display()))?;
+    let size = entry.size();
+    read_entry(&mut entry, name, size)
+}
 
-    Ok(arrays)
+fn open_npz(path: &Path) -> Result<ZipArchive<std::fs::File>> {
+    let file = std::fs::File::open(path)
+        .with_context(|| format!("Cannot open NPZ file: {}", path.display()))?;
+    ZipArchive::new(file)
+        .with_context(|| format!("Cannot open ZIP archive: {}", path.display()))
+}
+
+/// Decompress and parse one `.npy` member of `size` bytes.
+fn read_entry(entry: &mut impl Read, name: &str, size: u64) -> Result<NpyArray> {
+    let mut buf = Vec::with_capacity(size as usize);
+    entry.read_to_end(&mut buf).context("Failed to read NPY entry")?;
+
+    let (shape, data) = parse_npy(&buf)
+        .with_context(|| format!("Failed to parse NPY entry '{}'", name))?;
+
+    Ok(NpyArray { shape, data })
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -286,4 +320,30 @@ mod tests {
         let result = parse_npy(b"NOTANPY");
         assert!(result.is_err());
     }
+
+    #[test]
+    fn test_list_and_load_single_entry() {
+        use std::io::Write;
+        use zip::write::SimpleFileOptions;
+
+        let path = std::env::temp_dir().join("kittentts_npz_entry_test.npz");
+        let mut zip = zip::ZipWriter::new(std::fs::File::create(&path).unwrap());
+        for (name, v) in [("a", 1.0f32), ("b", 2.0)] {
+            zip.start_file(format!("{name}.npy"), SimpleFileOptions::default()).unwrap();
+            zip.write_all(&make_npy(&[1, 2], &[v, v])).unwrap();
+        }
+        zip.finish().unwrap();
+
+        let mut names = list_npz(&path).unwrap();
+        names.sort();
+        assert_eq!(names, vec!["a", "b"]);
+        assert_eq!(load_npz_entry(&path, "b").unwrap().data, vec![2.0, 2.0]);
+        assert!(load_npz_entry(&path, "c").is_err());
+
+        let bytes = std::fs::read(&path).unwrap();
+        let arrays = load_npz_from_bytes(&bytes).unwrap();
+        assert_eq!(arrays["a"].data, vec![1.0, 1.0]);
+        assert!(load_npz_from_bytes(b"not a zip").is_err());
+        let _ = std::fs::remove_file(&path);
+    }
 }
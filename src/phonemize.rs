@@ -160,7 +160,13 @@ pub fn is_espeak_available() -> bool {
 pub fn phonemize(text: &str) -> Result<String> {
     #[cfg(feature = "espeak")]
     {
-        inner::run_phonemize(text)
+        let span = tracing::info_span!(
+            "phonemize", text_len = text.len(), ipa_len = tracing::field::Empty
+        );
+        let _enter = span.enter();
+        let ipa = inner::run_phonemize(text)?;
+        span.record("ipa_len", ipa.len());
+        Ok(ipa)
     }
     #[cfg(not(feature = "espeak"))]
     {
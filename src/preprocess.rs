@@ -705,6 +705,11 @@ impl TextPreprocessor {
     }
 
     pub fn process(&self, text: &str) -> String {
+        let span = tracing::info_span!(
+            "preprocess", text_len = text.len(), out_len = tracing::field::Empty
+        );
+        let _enter = span.enter();
+
         let cfg = &self.config;
         let mut text = text.to_string();
 
@@ -775,6 +780,7 @@ impl TextPreprocessor {
             text = remove_extra_whitespace(&text);
         }
 
+        span.record("out_len", text.len());
         text
     }
 }
@@ -0,0 +1,393 @@
+//! ONNX Runtime per-operator profiling.
+//!
+//! When [`LoadOptions::profiling`](crate::model::LoadOptions::profiling) is
+//! set, the ORT session is built with the built-in profiler enabled.  After
+//! [`ProfilingOptions::max_runs`] inference runs the profiler is stopped, ORT
+//! writes its JSON trace (`<prefix>_<timestamp>.json`), and the trace is
+//! aggregated into a [`ProfileSummary`]:
+//!
+//! - total kernel time per operator type (`Conv`, `LSTM`, `MatMul`, …);
+//! - the same breakdown per input sequence-length bucket, so ops that only
+//!   dominate at long inputs stand out.
+//!
+//! The summary is printed to stderr, written next to the trace as
+//! `<trace>.summary.json`, and available from
+//! [`KittenTtsOnnx::profile_report`](crate::model::KittenTtsOnnx::profile_report).
+//!
+//! [`summarize`] also works on any ORT profile JSON on its own.
+
+use std::{
+    collections::BTreeMap,
+    fmt,
+    path::{Path, PathBuf},
+};
+
+use anyhow::{Context, Result};
+#[cfg(feature = "onnxruntime")]
+use ort::session::Session;
+use serde::{Deserialize, Serialize};
+
+/// Upper bounds (exclusive) of the sequence-length buckets, in tokens.
+/// Runs longer than the last bound fall into a final open-ended bucket.
+const BUCKET_BOUNDS: &[usize] = &[32, 64, 128, 256, 512];
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Options
+// ─────────────────────────────────────────────────────────────────────────────
+
+/// Enables ORT's per-operator profiler for a bounded number of runs.
+#[derive(Debug, Clone)]
+pub struct ProfilingOptions {
+    /// Path prefix for the trace file; ORT appends `_<timestamp>.json`.
+    pub prefix: PathBuf,
+    /// Number of inference runs to record before the profiler is stopped.
+    /// Profiling slows every run, so keep this small.
+    pub max_runs: usize,
+}
+
+impl ProfilingOptions {
+    pub fn new(prefix: impl Into<PathBuf>, max_runs: usize) -> Self {
+        Self { prefix: prefix.into(), max_runs: max_runs.max(1) }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Summary types
+// ─────────────────────────────────────────────────────────────────────────────
+
+/// Aggregated kernel time for one operator type.
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct OpStat {
+    pub op_type: String,
+    /// Number of kernel invocations.
+    pub calls: u64,
+    /// Total kernel time in microseconds.
+    pub total_us: u64,
+    /// Share of all kernel time in this scope, 0–100.
+    pub percent: f64,
+}
+
+/// Per-op breakdown for runs whose input length falls in `[min_len, max_len)`.
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct BucketStat {
+    pub min_len: usize,
+    /// `None` for the final open-ended bucket.
+    pub max_len: Option<usize>,
+    pub runs: usize,
+    /// Total `model_run` wall time in microseconds.
+    pub run_us: u64,
+    pub ops: Vec<OpStat>,
+}
+
+/// Result of aggregating one ORT profile trace.
+#[derive(Debug, Clone, Default, Serialize, Deserialize)]
+pub struct ProfileSummary {
+    /// Number of `model_run` events found in the trace.
+    pub runs: usize,
+    /// Total kernel time across all runs, in microseconds.
+    pub kernel_us: u64,
+    /// Per-op totals, most expensive first.
+    pub ops: Vec<OpStat>,
+    /// Per sequence-length bucket, shortest first.  Empty when no sequence
+    /// lengths were supplied.
+    pub buckets: Vec<BucketStat>,
+}
+
+/// A finished profiling session: where ORT wrote the trace and its summary.
+#[derive(Debug, Clone)]
+pub struct ProfileReport {
+    pub trace_path: PathBuf,
+    pub summary: ProfileSummary,
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Summariser
+// ─────────────────────────────────────────────────────────────────────────────
+
+/// One event of ORT's Chrome-trace style profile.
+#[derive(Deserialize)]
+struct Event {
+    #[serde(default)]
+    cat: String,
+    #[serde(default)]
+    name: String,
+    #[serde(default)]
+    ts: u64,
+    #[serde(default)]
+    dur: u64,
+    #[serde(default)]
+    args: EventArgs,
+}
+
+#[derive(Deserialize, Default)]
+struct EventArgs {
+    #[serde(default)]
+    op_name: Option<String>,
+}
+
+fn bucket_of(seq_len: usize) -> usize {
+    BUCKET_BOUNDS.iter().position(|&b| seq_len < b).unwrap_or(BUCKET_BOUNDS.len())
+}
+
+fn op_stats(acc: BTreeMap<String, (u64, u64)>) -> Vec<OpStat> {
+    let total: u64 = acc.values().map(|&(_, us)| us).sum();
+    let mut ops: Vec<OpStat> = acc
+        .into_iter()
+        .map(|(op_type, (calls, total_us))| OpStat {
+            op_type,
+            calls,
+            total_us,
+            percent: if total > 0 { total_us as f64 * 100.0 / total as f64 } else { 0.0 },
+        })
+        .collect();
+    ops.sort_by(|a, b| b.total_us.cmp(&a.total_us).then_with(|| a.op_type.cmp(&b.op_type)));
+    ops
+}
+
+/// Aggregate an ORT profile trace by operator type and sequence length.
+///
+/// `seq_lens[i]` is the input length of the *i*-th `model_run` in the trace
+/// (in run order).  Pass an empty slice to skip the per-bucket breakdown.
+/// Only `*_kernel_time` node events are counted — fence events are
+/// scheduling overhead, not operator cost.
+pub fn summarize(json: &str, seq_lens: &[usize]) -> Result<ProfileSummary> {
+    let events: Vec<Event> =
+        serde_json::from_str(json).context("ORT profile is not a JSON event array")?;
+
+    let mut runs: Vec<(u64, u64)> = events
+        .iter()
+        .filter(|e| e.cat == "Session" && e.name == "model_run")
+        .map(|e| (e.ts, e.ts + e.dur))
+        .collect();
+    runs.sort_unstable();
+
+    let nbuckets = BUCKET_BOUNDS.len() + 1;
+    let mut all: BTreeMap<String, (u64, u64)> = BTreeMap::new();
+    let mut per_bucket: Vec<BTreeMap<String, (u64, u64)>> = vec![BTreeMap::new(); nbuckets];
+    let mut bucket_runs = vec![0usize; nbuckets];
+    let mut bucket_run_us = vec![0u64; nbuckets];
+
+    if !seq_lens.is_empty() {
+        for (i, &(start, end)) in runs.iter().enumerate() {
+            if let Some(&len) = seq_lens.get(i) {
+                let b = bucket_of(len);
+                bucket_runs[b] += 1;
+                bucket_run_us[b] += end - start;
+            }
+        }
+    }
+
+    for e in &events {
+        if e.cat != "Node" || !e.name.ends_with("_kernel_time") {
+            continue;
+        }
+        let Some(op) = e.args.op_name.as_deref() else { continue };
+
+        let slot = all.entry(op.to_string()).or_default();
+        slot.0 += 1;
+        slot.1 += e.dur;
+
+        if seq_lens.is_empty() {
+            continue;
+        }
+        // Attribute the kernel to the run whose window contains it.
+        let run = runs.partition_point(|&(start, _)| start <= e.ts);
+        let Some(run) = run.checked_sub(1) else { continue };
+        if e.ts > runs[run].1 {
+            continue;
+        }
+        if let Some(&len) = seq_lens.get(run) {
+            let slot = per_bucket[bucket_of(len)].entry(op.to_string()).or_default();
+            slot.0 += 1;
+            slot.1 += e.dur;
+        }
+    }
+
+    let kernel_us = all.values().map(|&(_, us)| us).sum();
+    let buckets = per_bucket
+        .into_iter()
+        .enumerate()
+        .filter(|(b, _)| bucket_runs[*b] > 0)
+        .map(|(b, acc)| BucketStat {
+            min_len: if b == 0 { 0 } else { BUCKET_BOUNDS[b - 1] },
+            max_len: BUCKET_BOUNDS.get(b).copied(),
+            runs: bucket_runs[b],
+            run_us: bucket_run_us[b],
+            ops: op_stats(acc),
+        })
+        .collect();
+
+    Ok(ProfileSummary { runs: runs.len(), kernel_us, ops: op_stats(all), buckets })
+}
+
+/// Read an ORT profile trace from disk and [`summarize`] it.
+pub fn summarize_file(path: &Path, seq_lens: &[usize]) -> Result<ProfileSummary> {
+    let json = std::fs::read_to_string(path)
+        .with_context(|| format!("Cannot read ORT profile: {}", path.display()))?;
+    summarize(&json, seq_lens)
+}
+
+impl fmt::Display for ProfileSummary {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        const TOP: usize = 12;
+        writeln!(
+            f,
+            "{} runs, {:.1} ms kernel time",
+            self.runs,
+            self.kernel_us as f64 / 1_000.0
+        )?;
+        writeln!(f, "{:<24} {:>8} {:>12} {:>7}", "op", "calls", "total ms", "%")?;
+        for op in self.ops.iter().take(TOP) {
+            writeln!(
+                f,
+                "{:<24} {:>8} {:>12.2} {:>6.1}%",
+                op.op_type,
+                op.calls,
+                op.total_us as f64 / 1_000.0,
+                op.percent
+            )?;
+        }
+        for b in &self.buckets {
+            let range = match b.max_len {
+                Some(hi) => format!("{}..{}", b.min_len, hi),
+                None => format!("{}..", b.min_len),
+            };
+            let mean_ms = b.run_us as f64 / 1_000.0 / b.runs.max(1) as f64;
+            write!(f, "seq_len {range:<9} {} runs, {mean_ms:.1} ms/run:", b.runs)?;
+            for op in b.ops.iter().take(4) {
+                write!(f, " {} {:.0}%", op.op_type, op.percent)?;
+            }
+            writeln!(f)?;
+        }
+        Ok(())
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Per-session profiler state
+// ─────────────────────────────────────────────────────────────────────────────
+
+/// Tracks the bounded profiling window of one ORT session.
+#[cfg(feature = "onnxruntime")]
+pub(crate) struct SessionProfiler {
+    remaining: usize,
+    seq_lens: Vec<usize>,
+    report: Option<ProfileReport>,
+}
+
+#[cfg(feature = "onnxruntime")]
+impl SessionProfiler {
+    pub(crate) fn new(opts: &ProfilingOptions) -> Self {
+        Self { remaining: opts.max_runs.max(1), seq_lens: Vec::new(), report: None }
+    }
+
+    /// Record one finished run; stops the profiler once the budget is spent.
+    pub(crate) fn after_run(&mut self, session: &mut Session, seq_len: usize) {
+        if self.remaining == 0 {
+            return;
+        }
+        self.seq_lens.push(seq_len);
+        self.remaining -= 1;
+        if self.remaining == 0 {
+            self.finish(session);
+        }
+    }
+
+    /// Stop the profiler now (if still running) and summarise the trace.
+    pub(crate) fn finish(&mut self, session: &mut Session) {
+        if self.report.is_some() {
+            return;
+        }
+        self.remaining = 0;
+        match self.write_report(session) {
+            Ok(report) => {
+                eprintln!(
+                    "[kittentts] ORT profile written to {}\n{}",
+                    report.trace_path.display(),
+                    report.summary
+                );
+                self.report = Some(report);
+            }
+            Err(e) => eprintln!("[kittentts] ORT profiling failed: {e:#}"),
+        }
+    }
+
+    fn write_report(&self, session: &mut Session) -> Result<ProfileReport> {
+        let trace_path = PathBuf::from(
+            session
+                .end_profiling()
+                .map_err(|e| anyhow::anyhow!("Cannot stop ORT profiler: {e}"))?,
+        );
+        let summary = summarize_file(&trace_path, &self.seq_lens)?;
+
+        let mut summary_path = trace_path.clone().into_os_string();
+        summary_path.push(".summary.json");
+        std::fs::write(&summary_path, serde_json::to_vec_pretty(&summary)?)
+            .with_context(|| format!("Cannot write {}", Path::new(&summary_path).display()))?;
+
+        Ok(ProfileReport { trace_path, summary })
+    }
+
+    pub(crate) fn report(&self) -> Option<&ProfileReport> {
+        self.report.as_ref()
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tests
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn node(op: &str, ts: u64, dur: u64) -> String {
+        format!(
+            r#"{{"cat":"Node","pid":1,"tid":1,"dur":{dur},"ts":{ts},"ph":"X","name":"/n/{op}_kernel_time","args":{{"op_name":"{op}","provider":"CPUExecutionProvider"}}}}"#
+        )
+    }
+
+    fn run(ts: u64, dur: u64) -> String {
+        format!(r#"{{"cat":"Session","pid":1,"tid":1,"dur":{dur},"ts":{ts},"ph":"X","name":"model_run","args":{{}}}}"#)
+    }
+
+    fn trace() -> String {
+        let events = [
+            run(0, 100),
+            node("Conv", 10, 40),
+            node("MatMul", 60, 20),
+            r#"{"cat":"Node","pid":1,"tid":1,"dur":5,"ts":55,"ph":"X","name":"/n/Conv_fence_before","args":{"op_name":"Conv"}}"#.to_string(),
+            run(200, 400),
+            node("Conv", 210, 300),
+            node("LSTM", 520, 60),
+        ];
+        format!("[\n{}\n]", events.join(",\n"))
+    }
+
+    #[test]
+    fn test_totals_per_op() {
+        let s = summarize(&trace(), &[]).unwrap();
+        assert_eq!(s.runs, 2);
+        assert_eq!(s.kernel_us, 420);
+        assert_eq!(s.ops[0].op_type, "Conv");
+        assert_eq!(s.ops[0].calls, 2, "fence events must not be counted");
+        assert_eq!(s.ops[0].total_us, 340);
+        assert!(s.buckets.is_empty());
+    }
+
+    #[test]
+    fn test_buckets_by_seq_len() {
+        let s = summarize(&trace(), &[20, 300]).unwrap();
+        assert_eq!(s.buckets.len(), 2);
+        assert_eq!((s.buckets[0].min_len, s.buckets[0].max_len), (0, Some(32)));
+        assert_eq!(s.buckets[0].ops.iter().map(|o| o.total_us).sum::<u64>(), 60);
+        assert_eq!((s.buckets[1].min_len, s.buckets[1].max_len), (256, Some(512)));
+        assert_eq!(s.buckets[1].run_us, 400);
+        assert_eq!(s.buckets[1].ops[0].op_type, "Conv");
+    }
+
+    #[test]
+    fn test_rejects_non_array() {
+        assert!(summarize("{}", &[]).is_err());
+    }
+}
@@ -0,0 +1,227 @@
+//! Process-wide ONNX Runtime environment with shared thread pools.
+//!
+//! By default every ORT session owns its thread pools: one intra-op thread
+//! per physical core, plus an inter-op pool when parallel execution is on.
+//! A session pool of four, or two models in one process, therefore starts
+//! several pools that each expect the whole machine, and they thrash.
+//!
+//! [`init`] creates ORT's environment once with *global* intra-op and
+//! inter-op pools.  Sessions loaded with [`LoadOptions::shared_threads`]
+//! disable their own pools and run on these, so the process keeps a fixed
+//! number of ORT threads however many sessions and models it holds.
+//!
+//! ```no_run
+//! use kittentts::{model::LoadOptions, runtime::{self, ThreadPoolOptions}};
+//!
+//! runtime::init(ThreadPoolOptions { intra_threads: Some(4), ..Default::default() })?;
+//! let options = LoadOptions { shared_threads: true, session_pool_size: 4, ..Default::default() };
+//! # anyhow::Ok(())
+//! ```
+//!
+//! ORT's environment is created by the first session built in the process,
+//! so [`init`] must run before any model is loaded.  Loading with
+//! `shared_threads` without calling [`init`] first initialises the pools
+//! with ORT's defaults.
+//!
+//! The environment also owns the CPU arena used by models loaded with
+//! [`LoadOptions::arena`], registered by the first such load.
+//!
+//! [`LoadOptions::shared_threads`]: crate::model::LoadOptions::shared_threads
+//! [`LoadOptions::arena`]: crate::model::LoadOptions::arena
+
+use std::ffi::{c_char, CStr};
+
+use anyhow::{bail, ensure, Context, Result};
+use once_cell::sync::OnceCell;
+use ort::{
+    environment::{get_environment, GlobalThreadPoolOptions},
+    memory::{AllocationDevice, AllocatorType, MemoryInfo, MemoryType},
+    AsPointer,
+};
+
+use crate::model::ArenaOptions;
+
+/// Sizing and placement of the process-wide ORT thread pools.
+///
+/// `ThreadPoolOptions::default()` keeps ORT's defaults for everything.
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct ThreadPoolOptions {
+    /// Threads shared by every session for work inside one operator,
+    /// including the calling thread.  `None` keeps ORT's default (one per
+    /// physical core).
+    pub intra_threads: Option<usize>,
+    /// Threads shared by every session for independent graph branches.
+    /// Sessions switch to parallel execution when this is above 1.
+    pub inter_threads: Option<usize>,
+    /// Let idle pool threads spin before sleeping.  Spinning lowers
+    /// latency for back-to-back runs but burns CPU between requests.
+    /// `None` keeps ORT's default (on).
+    pub spin: Option<bool>,
+    /// Logical processors each intra-op thread is pinned to, in ORT's
+    /// `intra_op_thread_affinities` syntax: one `;`-separated group per
+    /// thread except the caller, each a `,`-separated list of 1-based
+    /// processor ids or `first-last` ranges — e.g. `"2;3;4"` for four
+    /// threads.  Requires `intra_threads`.
+    pub intra_affinity: Option<String>,
+}
+
+impl ThreadPoolOptions {
+    fn validate(&self) -> Result<()> {
+        let Some(affinity) = &self.intra_affinity else { return Ok(()) };
+        let Some(threads) = self.intra_threads else {
+            bail!("intra_affinity requires intra_threads");
+        };
+        let groups = affinity.split(';').count();
+        ensure!(
+            groups + 1 == threads,
+            "intra_affinity has {groups} group(s); {threads} intra-op threads need {}",
+            threads.saturating_sub(1)
+        );
+        for group in affinity.split(';') {
+            for id in group.split(',').flat_map(|range| range.split('-')) {
+                ensure!(
+                    id.trim().parse::<u32>().is_ok_and(|n| n > 0),
+                    "invalid processor id '{id}' in intra_affinity '{affinity}'"
+                );
+            }
+        }
+        Ok(())
+    }
+}
+
+static SHARED: OnceCell<ThreadPoolOptions> = OnceCell::new();
+
+/// Create ORT's environment with global thread pools configured by `options`.
+///
+/// Call once, before loading any model.  Calling again with the same
+/// options is a no-op; different options are an error, as is calling it
+/// after ORT's environment already exists.
+pub fn init(options: ThreadPoolOptions) -> Result<()> {
+    let active = SHARED.get_or_try_init(|| commit(&options).map(|()| options.clone()))?;
+    ensure!(
+        *active == options,
+        "shared ORT thread pools already initialised with {active:?}"
+    );
+    Ok(())
+}
+
+/// The options the shared pools were created with, if [`init`] has run.
+pub fn shared() -> Option<&'static ThreadPoolOptions> {
+    SHARED.get()
+}
+
+/// The shared pools, created with ORT's defaults if [`init`] has not run.
+pub(crate) fn ensure_shared() -> Result<&'static ThreadPoolOptions> {
+    SHARED.get_or_try_init(|| {
+        let options = ThreadPoolOptions::default();
+        commit(&options).map(|()| options)
+    })
+}
+
+fn commit(options: &ThreadPoolOptions) -> Result<()> {
+    options.validate()?;
+    let mut pool = GlobalThreadPoolOptions::default();
+    if let Some(n) = options.intra_threads {
+        pool = pool.with_intra_threads(n).context("Failed to set shared intra-op threads")?;
+    }
+    if let Some(n) = options.inter_threads {
+        pool = pool.with_inter_threads(n).context("Failed to set shared inter-op threads")?;
+    }
+    if let Some(spin) = options.spin {
+        pool = pool.with_spin_control(spin).context("Failed to set thread spinning")?;
+    }
+    if let Some(affinity) = &options.intra_affinity {
+        pool = pool
+            .with_intra_affinity(affinity)
+            .context("Failed to set intra-op thread affinity")?;
+    }
+    let committed = ort::init().with_name("kittentts").with_global_thread_pool(pool).commit();
+    ensure!(
+        committed,
+        "ORT environment already exists; initialise the shared thread pools before loading any model"
+    );
+    Ok(())
+}
+
+// ─── CPU arena ──────────────────────────────────────────────────────────────
+
+static ARENA: OnceCell<ArenaOptions> = OnceCell::new();
+
+/// Register the environment's CPU arena configured by `options`, which
+/// sessions opt into with `session.use_env_allocators`.  Created once per
+/// process; a later model asking for different options is an error.
+pub(crate) fn ensure_arena(options: &ArenaOptions) -> Result<()> {
+    let active = ARENA.get_or_try_init(|| register_arena(options).map(|()| options.clone()))?;
+    ensure!(active == options, "ORT CPU arena already configured with {active:?}");
+    Ok(())
+}
+
+fn register_arena(options: &ArenaOptions) -> Result<()> {
+    // CreateArenaCfgV2 takes parallel key / value arrays; absent keys keep
+    // ORT's defaults.
+    let mut keys: Vec<*const c_char> = Vec::new();
+    let mut values: Vec<usize> = Vec::new();
+    let entries = [
+        (c"initial_chunk_size_bytes", options.initial_chunk_bytes),
+        (c"max_mem", options.max_bytes),
+        (c"arena_extend_strategy", options.extend.map(|e| e as usize)),
+    ];
+    for (key, value) in entries {
+        if let Some(value) = value {
+            keys.push(key.as_ptr());
+            values.push(value);
+        }
+    }
+
+    let api = ort::api();
+    let mut cfg = std::ptr::null_mut();
+    ort_status(unsafe { (api.CreateArenaCfgV2)(keys.as_ptr(), values.as_ptr(), keys.len(), &mut cfg) })
+        .context("Invalid CPU arena options")?;
+    let registered = (|| {
+        let info = MemoryInfo::new(AllocationDevice::CPU, 0, AllocatorType::Arena, MemoryType::Default)
+            .context("Failed to describe CPU memory")?;
+        let env = get_environment().context("Failed to create ORT environment")?;
+        ort_status(unsafe { (api.CreateAndRegisterAllocator)(env.ptr().cast_mut(), info.ptr(), cfg) })
+            .context("Failed to register CPU arena")
+    })();
+    unsafe { (api.ReleaseArenaCfg)(cfg) };
+    registered
+}
+
+/// Convert a raw `OrtStatus` (null on success) into a `Result`.
+fn ort_status(status: ort::sys::OrtStatusPtr) -> Result<()> {
+    if status.0.is_null() {
+        return Ok(());
+    }
+    let api = ort::api();
+    let message = unsafe { CStr::from_ptr((api.GetErrorMessage)(status.0)) }
+        .to_string_lossy()
+        .into_owned();
+    unsafe { (api.ReleaseStatus)(status.0) };
+    bail!("{message}")
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tests
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_affinity_validation() {
+        let opts = |threads: Option<usize>, affinity: &str| ThreadPoolOptions {
+            intra_threads: threads,
+            intra_affinity: Some(affinity.to_string()),
+            ..Default::default()
+        };
+        assert!(ThreadPoolOptions::default().validate().is_ok());
+        assert!(opts(Some(4), "2;3;4").validate().is_ok());
+        assert!(opts(Some(3), "1,2;3-4").validate().is_ok());
+        assert!(opts(None, "2;3").validate().is_err());
+        assert!(opts(Some(4), "2;3").validate().is_err());
+        assert!(opts(Some(2), "0").validate().is_err());
+        assert!(opts(Some(2), "x").validate().is_err());
+    }
+}
@@ -0,0 +1,288 @@
+//! Per-request generation statistics.
+//!
+//! [`KittenTtsOnnx::generate_with_stats`](crate::model::KittenTtsOnnx::generate_with_stats)
+//! returns a [`GenerationStats`] alongside the audio.  It holds wall time and,
+//! with the `alloc-stats` feature, allocation counters for each pipeline
+//! stage.
+//!
+//! Every synthesis call is also folded into the model's cumulative
+//! [`EngineStats`] and remembered per thread (see [`last_call_stats`]).
+
+use std::{
+    cell::RefCell,
+    time::{Duration, Instant},
+};
+
+use crate::{
+    alloc::{AllocScope, AllocStats},
+    model::SAMPLE_RATE,
+};
+
+/// Time and allocations spent in one pipeline stage.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct StageStats {
+    pub time: Duration,
+    /// All zero without the `alloc-stats` feature.
+    pub alloc: AllocStats,
+}
+
+impl StageStats {
+    /// Add a later run of the same stage (e.g. the next chunk).
+    pub fn merge(&mut self, other: StageStats) {
+        self.time += other.time;
+        self.alloc.merge(other.alloc);
+    }
+}
+
+/// Breakdown of one `generate` call.
+///
+/// Stages are measured on the calling thread; `total` covers the whole call
+/// including work not attributed to a stage (chunking, concatenation).
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct GenerationStats {
+    /// Number of text chunks synthesised.
+    pub chunks: usize,
+    /// Token IDs fed to the model, summed over chunks (including pads).
+    pub tokens: usize,
+    /// Output samples at [`SAMPLE_RATE`].
+    pub samples: usize,
+
+    /// Text normalisation (`TextPreprocessor::process`).
+    pub preprocess: StageStats,
+    /// Text → IPA (espeak-ng).
+    pub phonemize: StageStats,
+    /// IPA → token IDs and style-row lookup.
+    pub tokenize: StageStats,
+    /// The backend's inference call: input tensors, the run, output
+    /// extraction, plus the tail trim.
+    pub inference: StageStats,
+    /// The whole call.
+    pub total: StageStats,
+}
+
+impl GenerationStats {
+    /// Seconds of audio produced.
+    pub fn audio_seconds(&self) -> f64 {
+        self.samples as f64 / SAMPLE_RATE as f64
+    }
+
+    /// Real-time factor: wall time ÷ audio duration (< 1 is faster than
+    /// real time).  `0.0` when no audio was produced.
+    pub fn real_time_factor(&self) -> f64 {
+        let audio = self.audio_seconds();
+        if audio > 0.0 {
+            self.total.time.as_secs_f64() / audio
+        } else {
+            0.0
+        }
+    }
+
+    /// Fold the stats of another call (or chunk) into this one.
+    pub fn merge(&mut self, other: &GenerationStats) {
+        self.chunks += other.chunks;
+        self.tokens += other.tokens;
+        self.samples += other.samples;
+        self.preprocess.merge(other.preprocess);
+        self.phonemize.merge(other.phonemize);
+        self.tokenize.merge(other.tokenize);
+        self.inference.merge(other.inference);
+        self.total.merge(other.total);
+    }
+}
+
+/// Cumulative counters for one model since it was loaded.
+///
+/// Returned by [`KittenTtsOnnx::engine_stats`](crate::model::KittenTtsOnnx::engine_stats).
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct EngineStats {
+    /// Completed synthesis calls (a batch counts one per item).
+    pub requests: u64,
+    /// Chunks, tokens, samples and stage times summed over all requests.
+    pub totals: GenerationStats,
+    /// Inferences that found every pooled session busy and had to wait.
+    pub session_waits: u64,
+    /// Voice lookups served from memory.
+    pub voice_cache_hits: u64,
+    /// Voice lookups that decompressed the voice first (lazy voices only).
+    pub voice_cache_misses: u64,
+    /// The optimised-graph cache was loaded instead of optimising at startup.
+    pub optimized_model_cache_hit: bool,
+    /// Largest Rust heap growth of a single request on its calling thread.
+    /// Excludes ONNX Runtime's own allocations (arena, intra-op threads),
+    /// which are most of inference memory; see [`crate::alloc`].  Zero
+    /// without `alloc-stats`.
+    pub peak_rust_heap_bytes: u64,
+    /// ORT CPU arena shrinks, by policy or
+    /// [`shrink_arena`](crate::model::KittenTtsOnnx::shrink_arena).
+    pub arena_shrinks: u64,
+    /// Process RSS in bytes `(before, after)` the latest shrink; zero where
+    /// RSS is unavailable.  For a policy-driven shrink, `before` is taken
+    /// as its run starts, so a footprint that no longer ratchets shows as
+    /// `after ≈ before`.
+    pub last_shrink_rss: Option<(u64, u64)>,
+}
+
+impl EngineStats {
+    /// Seconds of audio produced.
+    pub fn audio_seconds(&self) -> f64 {
+        self.totals.audio_seconds()
+    }
+
+    /// Overall real-time factor (see [`GenerationStats::real_time_factor`]).
+    pub fn real_time_factor(&self) -> f64 {
+        self.totals.real_time_factor()
+    }
+
+    /// Fraction of voice lookups that hit; `1.0` before any lookup.
+    pub fn voice_cache_hit_rate(&self) -> f64 {
+        let total = self.voice_cache_hits + self.voice_cache_misses;
+        if total == 0 {
+            1.0
+        } else {
+            self.voice_cache_hits as f64 / total as f64
+        }
+    }
+
+    /// Fold one finished request into the totals.
+    pub(crate) fn record(&mut self, stats: &GenerationStats) {
+        self.requests += 1;
+        self.totals.merge(stats);
+        self.peak_rust_heap_bytes = self.peak_rust_heap_bytes.max(stats.total.alloc.peak_live_bytes);
+    }
+}
+
+thread_local! {
+    static LAST_CALL: RefCell<Option<GenerationStats>> = const { RefCell::new(None) };
+}
+
+/// Stats of the most recent synthesis call made on this thread, on any
+/// model.  For a batch they cover all its items.  `None` before the first
+/// call.
+pub fn last_call_stats() -> Option<GenerationStats> {
+    LAST_CALL.with(|l| l.borrow().clone())
+}
+
+pub(crate) fn set_last_call(stats: GenerationStats) {
+    LAST_CALL.with(|l| *l.borrow_mut() = Some(stats));
+}
+
+pub(crate) fn take_last_call() -> Option<GenerationStats> {
+    LAST_CALL.with(|l| l.borrow_mut().take())
+}
+
+/// Measures one stage: wall time plus an [`AllocScope`].
+pub(crate) struct StageTimer {
+    start: Instant,
+    scope: AllocScope,
+}
+
+impl StageTimer {
+    pub(crate) fn start() -> Self {
+        Self { start: Instant::now(), scope: AllocScope::begin() }
+    }
+
+    pub(crate) fn stop(self) -> StageStats {
+        let time = self.start.elapsed();
+        StageStats { time, alloc: self.scope.finish() }
+    }
+}
+
+// ─── Resident set size ───────────────────────────────────────────────────────
+
+/// Current resident set size of this process in bytes (`VmRSS`).
+///
+/// Linux / Android only; `None` elsewhere or if `/proc` is unavailable.
+pub fn current_rss_bytes() -> Option<u64> {
+    proc_status_kb("VmRSS:").map(|kb| kb * 1024)
+}
+
+/// Peak resident set size of this process in bytes (`VmHWM`).
+///
+/// Linux / Android only; `None` elsewhere or if `/proc` is unavailable.
+pub fn peak_rss_bytes() -> Option<u64> {
+    proc_status_kb("VmHWM:").map(|kb| kb * 1024)
+}
+
+fn proc_status_kb(key: &str) -> Option<u64> {
+    if !cfg!(any(target_os = "linux", target_os = "android")) {
+        return None;
+    }
+    let status = std::fs::read_to_string("/proc/self/status").ok()?;
+    parse_status_kb(&status, key)
+}
+
+/// Parse a `Key:   1234 kB` line out of `/proc/self/status`.
+fn parse_status_kb(status: &str, key: &str) -> Option<u64> {
+    let line = status.lines().find(|l| l.starts_with(key))?;
+    line[key.len()..].split_whitespace().next()?.parse().ok()
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tests
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_real_time_factor() {
+        let mut stats = GenerationStats { samples: SAMPLE_RATE as usize * 2, ..Default::default() };
+        stats.total.time = Duration::from_millis(500);
+        assert!((stats.audio_seconds() - 2.0).abs() < 1e-9);
+        assert!((stats.real_time_factor() - 0.25).abs() < 1e-9);
+        assert_eq!(GenerationStats::default().real_time_factor(), 0.0);
+    }
+
+    #[test]
+    fn test_merge_sums_counts_and_times() {
+        let mut a = GenerationStats { chunks: 1, tokens: 10, samples: 100, ..Default::default() };
+        a.inference.time = Duration::from_millis(3);
+        let b = a.clone();
+        a.merge(&b);
+        assert_eq!((a.chunks, a.tokens, a.samples), (2, 20, 200));
+        assert_eq!(a.inference.time, Duration::from_millis(6));
+    }
+
+    #[test]
+    fn test_stage_timer_measures_time() {
+        let timer = StageTimer::start();
+        std::thread::sleep(Duration::from_millis(2));
+        let stage = timer.stop();
+        assert!(stage.time >= Duration::from_millis(2));
+    }
+
+    #[test]
+    fn test_engine_stats_record() {
+        let mut engine = EngineStats::default();
+        assert_eq!(engine.voice_cache_hit_rate(), 1.0);
+        let mut call = GenerationStats { chunks: 2, samples: SAMPLE_RATE as usize, ..Default::default() };
+        call.total.alloc.peak_live_bytes = 300;
+        engine.record(&call);
+        call.total.alloc.peak_live_bytes = 100;
+        engine.record(&call);
+        assert_eq!((engine.requests, engine.totals.chunks), (2, 4));
+        assert!((engine.audio_seconds() - 2.0).abs() < 1e-9);
+        assert_eq!(engine.peak_rust_heap_bytes, 300);
+        engine.voice_cache_hits = 3;
+        engine.voice_cache_misses = 1;
+        assert!((engine.voice_cache_hit_rate() - 0.75).abs() < 1e-9);
+    }
+
+    #[test]
+    fn test_last_call_is_per_thread() {
+        set_last_call(GenerationStats { chunks: 7, ..Default::default() });
+        assert_eq!(last_call_stats().map(|s| s.chunks), Some(7));
+        std::thread::spawn(|| assert!(last_call_stats().is_none())).join().unwrap();
+        assert_eq!(take_last_call().map(|s| s.chunks), Some(7));
+        assert!(last_call_stats().is_none());
+    }
+
+    #[test]
+    fn test_parse_status_kb() {
+        let status = "Name:\tkittentts\nVmHWM:\t  204800 kB\nVmRSS:\t  102400 kB\n";
+        assert_eq!(parse_status_kb(status, "VmHWM:"), Some(204_800));
+        assert_eq!(parse_status_kb(status, "VmRSS:"), Some(102_400));
+        assert_eq!(parse_status_kb(status, "VmSwap:"), None);
+    }
+}
@@ -0,0 +1,84 @@
+//! Tracing instrumentation and optional Chrome-trace / Perfetto export.
+//!
+//! The synthesis pipeline is instrumented with [`tracing`] spans:
+//!
+//! | Span              | Fields                                   |
+//! |-------------------|------------------------------------------|
+//! | `generate`        | `text_len`, `chunks`, `samples`          |
+//! | `generate_chunk`  | `chunk`, `text_len`, `samples`           |
+//! | `preprocess`      | `text_len`, `out_len`                    |
+//! | `phonemize`       | `text_len`, `ipa_len`                    |
+//! | `infer_ipa`       | `seq_len`, `style_idx`, `samples`        |
+//! | `ort_run`         | `seq_len`                                |
+//! | `tract_run`       | `seq_len` (tract backend)                |
+//! | `encode`          | `format`, `samples`                      |
+//!
+//! With no subscriber installed the spans cost one relaxed atomic load each.
+//! Any `tracing` subscriber picks them up; the **`chrome-trace`** Cargo
+//! feature additionally provides a subscriber that writes the Chrome trace
+//! event format, which opens directly in `chrome://tracing` or
+//! <https://ui.perfetto.dev>.
+//!
+//! ```no_run
+//! // KITTENTTS_TRACE=/tmp/kittentts.json ./my-app
+//! let _guard = kittentts::trace::init_from_env().unwrap();
+//! // … synthesise …
+//! // the trace file is flushed when `_guard` is dropped.
+//! ```
+
+use std::path::Path;
+
+use anyhow::Result;
+#[cfg(not(feature = "chrome-trace"))]
+use anyhow::anyhow;
+
+/// Environment variable naming the Chrome-trace output file.
+pub const TRACE_ENV: &str = "KITTENTTS_TRACE";
+
+/// Keeps the trace subscriber alive; the trace file is flushed and closed
+/// when this guard is dropped.
+pub struct TraceGuard {
+    #[cfg(feature = "chrome-trace")]
+    _flush: tracing_chrome::FlushGuard,
+}
+
+/// Install a global subscriber that writes every span to `path` as Chrome
+/// trace JSON.
+///
+/// Fails if a global subscriber is already installed.
+///
+/// **Requires the `chrome-trace` Cargo feature.**
+pub fn init_chrome_trace(path: &Path) -> Result<TraceGuard> {
+    #[cfg(feature = "chrome-trace")]
+    {
+        use tracing_subscriber::layer::SubscriberExt;
+
+        let (layer, flush) = tracing_chrome::ChromeLayerBuilder::new()
+            .file(path)
+            .include_args(true)
+            .build();
+        let subscriber = tracing_subscriber::registry().with(layer);
+        tracing::subscriber::set_global_default(subscriber)
+            .map_err(|e| anyhow::anyhow!("Cannot install trace subscriber: {e}"))?;
+        Ok(TraceGuard { _flush: flush })
+    }
+    #[cfg(not(feature = "chrome-trace"))]
+    {
+        let _ = path;
+        Err(anyhow!(
+            "Chrome-trace export requires the `chrome-trace` Cargo feature.\n\
+             Enable it with: kittentts = {{ features = [\"chrome-trace\"] }}"
+        ))
+    }
+}
+
+/// Call [`init_chrome_trace`] with the path in `$KITTENTTS_TRACE`.
+///
+/// Returns `Ok(None)` when the variable is unset or empty, so this is safe to
+/// call unconditionally at startup.
+pub fn init_from_env() -> Result<Option<TraceGuard>> {
+    match std::env::var_os(TRACE_ENV) {
+        Some(path) if !path.is_empty() => init_chrome_trace(Path::new(&path)).map(Some),
+        _ => Ok(None),
+    }
+}
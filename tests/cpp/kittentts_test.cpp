@@ -0,0 +1,118 @@
+// Tests for include/kittentts.hpp.  Built and run by scripts/test-cpp.sh.
+//
+// Model-backed checks run only when KITTENTTS_MODEL_DIR points at a directory
+// with kitten_tts_mini_v0_8.onnx and voices.npz; otherwise they are skipped,
+// like the model tests in tests/integration_tests.rs.
+
+#include "kittentts.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            ++failures;                                                    \
+        }                                                                  \
+    } while (0)
+
+template <class F>
+static bool throws(F &&f) {
+    try {
+        f();
+    } catch (const kittentts::Error &) {
+        return true;
+    }
+    return false;
+}
+
+static void test_without_model() {
+    CHECK(throws([] { kittentts::Model::load("/nonexistent.onnx", "/nonexistent.npz"); }));
+
+    kittentts::LoadOptions opts;
+    CHECK(opts.version == KITTENTTS_LOAD_OPTIONS_VERSION);
+    CHECK(opts.session_pool_size == 1);
+    CHECK(opts.graph_optimization_level == -1);
+    CHECK(opts.shared_threads == 0 && opts.share_prepacked_weights == 0);
+    CHECK(throws([] { kittentts::init_shared_threads(2, 0, 7); }));
+    opts.version = 999;
+    CHECK(throws([&] { kittentts::Model::load("a.onnx", "b.npz", opts); }));
+
+    kittentts::Audio empty;
+    CHECK(empty.empty() && empty.begin() == empty.end());
+    kittentts::Audio moved = std::move(empty);
+    CHECK(moved.size() == 0);
+}
+
+static void test_with_model(const std::string &dir) {
+    auto model = kittentts::Model::load(dir + "/kitten_tts_mini_v0_8.onnx", dir + "/voices.npz");
+    std::string json = model.voices_json();
+    CHECK(json.size() > 2 && json.front() == '[');
+    // First voice name: between the first pair of quotes.
+    std::string voice = json.substr(2, json.find('"', 2) - 2);
+
+    kittentts::Audio ipa = model.synthesize_ipa("həloʊ", voice);
+    CHECK(ipa.size() > 2400 && ipa.sample_rate() == 24000);
+    CHECK(ipa.f32() != nullptr && ipa.i16() == nullptr);
+
+    auto batch = model.synthesize_ipa_batch({"həloʊ", "ɡʊdbaɪ"}, voice, 1.0f,
+                                            kittentts::SampleFormat::I16);
+    CHECK(batch.size() == 2 && batch[1].i16() != nullptr && !batch[1].empty());
+    CHECK(model.synthesize_ipa_batch({}, voice).empty());
+    CHECK(model.synthesize_batch({}, voice).empty());
+    CHECK(throws([&] { model.synthesize_ipa("həloʊ", "no-such-voice"); }));
+
+    kittentts::Audio text = model.synthesize("Hello there.", voice);
+    CHECK(!text.empty());
+
+    std::vector<float> into;
+    model.synthesize_into("Hello there.", voice, 1.0f, into);
+    CHECK(into.size() == text.size());
+    model.synthesize_into("Hi.", voice, 1.0f, into);  // shrinks, keeps storage
+    CHECK(!into.empty() && into.size() < text.size());
+    model.synthesize_into("Hello there.", voice, 1.0f, into);
+    CHECK(into.size() == text.size());
+    std::vector<float> raw(16);
+    size_t needed = model.synthesize_into("Hello there.", voice, 1.0f, raw.data(), raw.size());
+    CHECK(needed == text.size());
+    raw.resize(needed);
+    CHECK(model.synthesize_into("Hello there.", voice, 1.0f, raw.data(), raw.size()) == needed);
+
+    size_t chunks = 0;
+    model.stream("First sentence. Second sentence. Third sentence.", voice, 1.0f,
+                 [&](const float *, size_t n, size_t) { return n > 0 && ++chunks < 2; });
+    CHECK(chunks == 2);
+    CHECK(throws([&] {
+        model.stream("Hello.", voice, 1.0f, [](const float *, size_t, size_t) -> bool {
+            throw kittentts::Error("from callback");
+        });
+    }));
+
+    auto future = model.synthesize_async("Hello there.", voice);
+    CHECK(future.get().size() == text.size());
+
+    KittenTtsStats stats = model.stats();
+    CHECK(stats.requests >= 5 && stats.samples > 0 && stats.real_time_factor > 0.0);
+}
+
+int main() {
+    test_without_model();
+
+    if (const char *dir = std::getenv("KITTENTTS_MODEL_DIR")) {
+        test_with_model(dir);
+    } else {
+        std::fprintf(stderr, "SKIP model tests: KITTENTTS_MODEL_DIR not set\n");
+    }
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("kittentts.hpp: all checks passed\n");
+    return 0;
+}
@@ -9,39 +9,10 @@
 //!   cargo test --features espeak            # + phonemisation tests
 //!   KITTENTTS_MODEL_DIR=… cargo test        # + inference tests
 
-use std::path::{Path, PathBuf};
-
-// ── Helper: locate model directory ───────────────────────────────────────────
-
-/// Return the path to a bundled model directory that contains:
-///   - `kitten_tts_mini_v0_8.onnx`
-///   - `voices.npz`
-///   - `config.json`
-///
-/// Search order:
-///   1. `$KITTENTTS_MODEL_DIR` environment variable
-///   2. `ios/KittenTTSApp/KittenTTSApp/Models/` relative to workspace root
-///   3. `android/KittenTTSApp/app/src/main/assets/models/` relative to workspace root
-fn model_dir() -> Option<PathBuf> {
-    // 1. Explicit override
-    if let Ok(dir) = std::env::var("KITTENTTS_MODEL_DIR") {
-        let p = PathBuf::from(dir);
-        if p.join("kitten_tts_mini_v0_8.onnx").exists() {
-            return Some(p);
-        }
-    }
+#[path = "../benches/common/mod.rs"]
+mod common;
 
-    // 2. Workspace-relative paths
-    let manifest = Path::new(env!("CARGO_MANIFEST_DIR"));
-    let candidates = [
-        manifest.join("ios/KittenTTSApp/KittenTTSApp/Models"),
-        manifest.join("android/KittenTTSApp/app/src/main/assets/models"),
-    ];
-    candidates
-        .iter()
-        .find(|p| p.join("kitten_tts_mini_v0_8.onnx").exists())
-        .cloned()
-}
+use common::model_dir;
 
 // ─────────────────────────────────────────────────────────────────────────────
 // § tokenize
@@ -358,9 +329,10 @@ mod phonemize {
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-// § model inference (e2e)
+// § model inference (e2e, requires `onnxruntime` feature)
 // ─────────────────────────────────────────────────────────────────────────────
 
+#[cfg(feature = "onnxruntime")]
 mod model {
     use kittentts::model::{KittenTtsOnnx, SAMPLE_RATE};
     use std::collections::HashMap;
@@ -395,6 +367,265 @@ mod model {
         eprintln!("Available voices: {:?}", tts.available_voices);
     }
 
+    #[test]
+    fn load_from_memory_matches_file_load() {
+        use kittentts::{mmap::Mmap, model::LoadOptions};
+
+        let Some(model_dir) = super::model_dir() else {
+            eprintln!("SKIP load_from_memory_matches_file_load: model directory not found");
+            return;
+        };
+        let Some(from_file) = load_bundled_model() else { return };
+        let map = |name: &str| {
+            Mmap::map_file(&std::fs::File::open(model_dir.join(name)).unwrap()).unwrap()
+        };
+        let tts = KittenTtsOnnx::load_from_memory(
+            &map("kitten_tts_mini_v0_8.onnx"),
+            &map("voices.npz"),
+            HashMap::new(),
+            HashMap::new(),
+            &LoadOptions::default(),
+        )
+        .expect("load_from_memory should succeed");
+
+        let mut a = tts.available_voices.clone();
+        let mut b = from_file.available_voices.clone();
+        a.sort();
+        b.sort();
+        assert_eq!(a, b);
+        let voice = &a[0];
+        let x = tts.generate_from_ipa("həloʊ", voice, 1.0, 5).unwrap();
+        let y = from_file.generate_from_ipa("həloʊ", voice, 1.0, 5).unwrap();
+        assert_eq!(x.len(), y.len(), "same model bytes must produce the same audio");
+        let max_diff = x.iter().zip(&y).map(|(a, b)| (a - b).abs()).fold(0.0f32, f32::max);
+        assert!(max_diff < 1e-3, "audio differs by up to {max_diff}");
+    }
+
+    #[test]
+    fn bundle_round_trip_matches_file_load() {
+        use kittentts::{bundle, model::LoadOptions};
+
+        let Some(model_dir) = super::model_dir() else {
+            eprintln!("SKIP bundle_round_trip_matches_file_load: model directory not found");
+            return;
+        };
+        let Some(from_file) = load_bundled_model() else { return };
+        let config = model_dir.join("config.json");
+        let path = std::env::temp_dir().join("kittentts_test_bundle.kitten");
+        bundle::pack(
+            &model_dir.join("kitten_tts_mini_v0_8.onnx"),
+            &model_dir.join("voices.npz"),
+            config.exists().then_some(config.as_path()),
+            &path,
+        )
+        .expect("pack should succeed");
+
+        let tts = KittenTtsOnnx::load_bundle(&path, &LoadOptions::default())
+            .expect("load_bundle should succeed");
+        let mut a = tts.available_voices.clone();
+        let mut b = from_file.available_voices.clone();
+        a.sort();
+        b.sort();
+        assert_eq!(a, b);
+        let voice = &a[0];
+        let x = tts.generate_from_ipa("həloʊ", voice, 1.0, 5).unwrap();
+        let y = from_file.generate_from_ipa("həloʊ", voice, 1.0, 5).unwrap();
+        assert_eq!(x.len(), y.len(), "bundled voices must match voices.npz");
+        let max_diff = x.iter().zip(&y).map(|(a, b)| (a - b).abs()).fold(0.0f32, f32::max);
+        assert!(max_diff < 1e-3, "audio differs by up to {max_diff}");
+
+        // Unpacking restores files that load through the regular path.
+        let out = std::env::temp_dir().join("kittentts_test_bundle_unpacked");
+        bundle::unpack(&path, &out).expect("unpack should succeed");
+        let again = KittenTtsOnnx::load(
+            &out.join("model.onnx"),
+            &out.join("voices.npz"),
+            HashMap::new(),
+            HashMap::new(),
+        )
+        .expect("unpacked files should load");
+        assert_eq!(again.generate_from_ipa("həloʊ", voice, 1.0, 5).unwrap().len(), x.len());
+        let _ = std::fs::remove_file(&path);
+        let _ = std::fs::remove_dir_all(&out);
+    }
+
+    #[test]
+    fn load_with_pool_and_lazy_voices() {
+        use kittentts::model::LoadOptions;
+
+        let Some(model_dir) = super::model_dir() else {
+            eprintln!("SKIP load_with_pool_and_lazy_voices: model directory not found");
+            return;
+        };
+        let options = LoadOptions {
+            session_pool_size: 2,
+            intra_threads: Some(1),
+            warm_up: true,
+            lazy_voices: true,
+            share_prepacked_weights: true,
+            ..Default::default()
+        };
+        let tts = KittenTtsOnnx::load_with_options(
+            &model_dir.join("kitten_tts_mini_v0_8.onnx"),
+            &model_dir.join("voices.npz"),
+            HashMap::new(),
+            HashMap::new(),
+            &options,
+        )
+        .expect("load_with_options should succeed");
+        assert_eq!(tts.session_pool_size(), 2);
+        assert!(!tts.has_voice("no-such-voice"));
+
+        let voice = tts.available_voices.first().expect("at least one voice").clone();
+
+        // A batch is spread over both sessions; results stay in input order.
+        let items = ["həloʊ", "ɡʊdbaɪ", "θæŋk juː"];
+        let batch = tts.generate_from_ipa_batch(&items, &voice, 1.0).expect("batch should succeed");
+        assert_eq!(batch.len(), items.len());
+        let single = tts.generate_from_ipa(items[1], &voice, 1.0, items[1].len()).unwrap();
+        assert_eq!(batch[1].len(), single.len());
+
+        // Both sessions serve requests concurrently.
+        std::thread::scope(|s| {
+            let handles: Vec<_> = (0..4)
+                .map(|_| s.spawn(|| tts.generate_from_ipa("həloʊ", &voice, 1.0, 5).unwrap()))
+                .collect();
+            for h in handles {
+                assert!(!h.join().unwrap().is_empty());
+            }
+        });
+
+        // 3 batch items + 1 single + 4 threaded requests.  The lazily loaded
+        // voice misses on first use (possibly once per racing batch worker).
+        let stats = tts.engine_stats();
+        assert_eq!(stats.requests, 8);
+        assert!((1..=2).contains(&stats.voice_cache_misses));
+        assert_eq!(stats.voice_cache_hits + stats.voice_cache_misses, 8);
+        assert!(stats.totals.samples > 0 && stats.real_time_factor() > 0.0);
+        let last = kittentts::last_call_stats().expect("this thread synthesised");
+        assert_eq!(last.samples, single.len());
+    }
+
+    #[test]
+    fn optimized_model_cache_misses_then_hits() {
+        use kittentts::model::LoadOptions;
+
+        let Some(model_dir) = super::model_dir() else {
+            eprintln!("SKIP optimized_model_cache_misses_then_hits: model directory not found");
+            return;
+        };
+        let cache = std::env::temp_dir().join(format!("kittentts-opt-{}.onnx", std::process::id()));
+        let _ = std::fs::remove_file(&cache);
+        let options = LoadOptions { optimized_model_path: Some(cache.clone()), ..Default::default() };
+        let load = || {
+            KittenTtsOnnx::load_with_options(
+                &model_dir.join("kitten_tts_mini_v0_8.onnx"),
+                &model_dir.join("voices.npz"),
+                HashMap::new(),
+                HashMap::new(),
+                &options,
+            )
+            .expect("load_with_options should succeed")
+        };
+
+        let cold = load();
+        assert!(!cold.engine_stats().optimized_model_cache_hit, "first load must optimise");
+        assert!(cache.exists(), "first load should write the cache");
+        let warm = load();
+        assert!(warm.engine_stats().optimized_model_cache_hit, "second load should reuse the cache");
+        std::fs::remove_file(&cache).ok();
+    }
+
+    #[test]
+    fn arena_shrinks_after_long_input() {
+        use kittentts::model::{ArenaExtend, ArenaOptions, ArenaShrink, LoadOptions};
+
+        let Some(model_dir) = super::model_dir() else {
+            eprintln!("SKIP arena_shrinks_after_long_input: model directory not found");
+            return;
+        };
+        let options = LoadOptions {
+            arena: Some(ArenaOptions { extend: Some(ArenaExtend::SameAsRequested), ..Default::default() }),
+            arena_shrink: ArenaShrink::AfterLongInput { min_tokens: 40 },
+            ..Default::default()
+        };
+        let tts = KittenTtsOnnx::load_with_options(
+            &model_dir.join("kitten_tts_mini_v0_8.onnx"),
+            &model_dir.join("voices.npz"),
+            HashMap::new(),
+            HashMap::new(),
+            &options,
+        )
+        .expect("load_with_options should succeed");
+        let voice = tts.available_voices.first().expect("at least one voice").clone();
+
+        tts.generate_from_ipa("həloʊ", &voice, 1.0, 5).unwrap();
+        assert_eq!(tts.engine_stats().arena_shrinks, 0, "short input must not shrink");
+
+        let long = "ðə kwɪk bɹaʊn fɑːks dʒʌmps oʊvɚ ðə leɪzi dɑːɡ.";
+        let audio = tts.generate_from_ipa(long, &voice, 1.0, long.len()).unwrap();
+        assert!(!audio.is_empty());
+        let stats = tts.engine_stats();
+        assert_eq!(stats.arena_shrinks, 1);
+        assert!(stats.last_shrink_rss.is_some());
+
+        tts.shrink_arena().expect("idle shrink should succeed");
+        assert_eq!(tts.engine_stats().arena_shrinks, 2);
+    }
+
+    #[test]
+    fn autotune_measures_then_reuses_cache() {
+        use kittentts::autotune::{self, AutotuneOptions, Objective, Topology};
+        use kittentts::model::LoadOptions;
+
+        let Some(model_dir) = super::model_dir() else {
+            eprintln!("SKIP autotune_measures_then_reuses_cache: model directory not found");
+            return;
+        };
+        let cache = std::env::temp_dir().join(format!("kittentts-autotune-it-{}.json", std::process::id()));
+        let candidates = vec![
+            Topology { sessions: 1, intra_threads: 2 },
+            Topology { sessions: 2, intra_threads: 1 },
+        ];
+        let tune = AutotuneOptions {
+            objective: Objective::Throughput,
+            model_id: "kitten_tts_mini_v0_8".into(),
+            candidates: candidates.clone(),
+            iterations: 1,
+            cache_path: Some(cache.clone()),
+        };
+        let load = |o: &LoadOptions| {
+            KittenTtsOnnx::load_with_options(
+                &model_dir.join("kitten_tts_mini_v0_8.onnx"),
+                &model_dir.join("voices.npz"),
+                HashMap::new(),
+                HashMap::new(),
+                o,
+            )
+        };
+
+        let first = autotune::tune(load, &LoadOptions::default(), &tune).expect("tuning should succeed");
+        assert!(!first.cached);
+        assert_eq!(first.measurements.len(), 2);
+        assert!(candidates.contains(&first.chosen));
+        assert!(first.measurements.iter().all(|m| m.latency_ms > 0.0 && m.audio_sec_per_sec > 0.0));
+
+        let again = autotune::tune(|_| unreachable!("cached"), &LoadOptions::default(), &tune).unwrap();
+        assert!(again.cached);
+        assert_eq!(again.chosen, first.chosen);
+
+        // Another model or candidate list must measure afresh.
+        let measure = |_: &LoadOptions| -> anyhow::Result<KittenTtsOnnx> { anyhow::bail!("measured") };
+        let other_model = AutotuneOptions { model_id: "other".into(), ..tune.clone() };
+        assert!(autotune::tune(measure, &LoadOptions::default(), &other_model).is_err());
+        let fewer = AutotuneOptions { candidates: candidates[..1].to_vec(), ..tune.clone() };
+        assert!(autotune::tune(measure, &LoadOptions::default(), &fewer).is_err());
+
+        let tts = load(&first.chosen.apply(LoadOptions::default())).unwrap();
+        assert_eq!(tts.session_pool_size(), first.chosen.sessions);
+        std::fs::remove_file(&cache).ok();
+    }
+
     #[test]
     fn generate_from_ipa_produces_audio() {
         let Some(tts) = load_bundled_model() else {
@@ -518,4 +749,363 @@ mod model {
             .expect("generate_chunk should succeed");
         assert!(!audio.is_empty(), "chunk audio must not be empty");
     }
+
+    #[cfg(feature = "espeak")]
+    #[test]
+    fn generate_streaming_delivers_chunks_and_stops() {
+        let Some(tts) = load_bundled_model() else {
+            eprintln!("SKIP generate_streaming_delivers_chunks_and_stops: model files not found");
+            return;
+        };
+        let voice = tts.available_voices.first().expect("at least one voice");
+        let text = "First sentence here. Second sentence here. Third sentence here.";
+
+        let mut indices = Vec::new();
+        let mut streamed = Vec::new();
+        tts.generate_streaming(text, voice, 1.0, true, |i, chunk| {
+            indices.push(i);
+            streamed.extend_from_slice(chunk);
+            true
+        })
+        .expect("generate_streaming should succeed");
+        assert!(indices.len() >= 2, "expected several chunks, got {indices:?}");
+        assert_eq!(indices, (0..indices.len()).collect::<Vec<_>>());
+        assert!(!streamed.is_empty());
+
+        let mut calls = 0;
+        let stats = tts
+            .generate_streaming(text, voice, 1.0, true, |_, _| {
+                calls += 1;
+                false
+            })
+            .expect("stopping early is not an error");
+        assert_eq!((calls, stats.chunks), (1, 1));
+    }
+
+    #[cfg(feature = "espeak")]
+    #[test]
+    fn generate_with_stats_reports_stages() {
+        let Some(tts) = load_bundled_model() else {
+            eprintln!("SKIP generate_with_stats_reports_stages: model files not found");
+            return;
+        };
+        let voice = tts.available_voices.first().expect("at least one voice");
+        let (audio, stats) = tts
+            .generate_with_stats("Hello world. How are you?", voice, 1.0, true)
+            .expect("generate_with_stats should succeed");
+        assert_eq!(stats.samples, audio.len());
+        assert!(stats.chunks >= 1 && stats.tokens > 0, "{stats:?}");
+        assert!(stats.inference.time > std::time::Duration::ZERO);
+        assert!(stats.total.time >= stats.inference.time);
+        if kittentts::alloc::is_enabled() {
+            assert!(stats.total.alloc.allocations > 0, "{stats:?}");
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// § backends
+// ─────────────────────────────────────────────────────────────────────────────
+
+mod backends {
+    use kittentts::backend::{self, MockBackend};
+    use kittentts::model::{BackendKind, KittenTtsOnnx, LoadOptions};
+    use std::collections::HashMap;
+    use std::path::Path;
+
+    #[cfg(feature = "tract")]
+    fn load(dir: &Path, backend: BackendKind) -> KittenTtsOnnx {
+        KittenTtsOnnx::load_with_options(
+            &dir.join("kitten_tts_mini_v0_8.onnx"),
+            &dir.join("voices.npz"),
+            HashMap::new(),
+            HashMap::new(),
+            &LoadOptions { backend, ..Default::default() },
+        )
+        .expect("load_with_options should succeed")
+    }
+
+    #[test]
+    fn mock_backend_runs_the_pipeline() {
+        let mock = MockBackend { concurrency: 2, ..Default::default() };
+        let tts = KittenTtsOnnx::from_backend(
+            Box::new(mock),
+            backend::synthetic_voices(&["a", "b"]),
+            HashMap::from([("a".to_string(), 1.0)]),
+            HashMap::from([("Alias".to_string(), "b".to_string())]),
+            &LoadOptions { warm_up: true, ..Default::default() },
+        )
+        .expect("mock backend should load");
+        assert_eq!(tts.backend_name(), "mock");
+        assert_eq!(tts.session_pool_size(), 2);
+        assert!(tts.has_voice("Alias"));
+        assert!(tts.profile_report().is_none());
+        tts.shrink_arena().expect("no-op without ORT");
+
+        // 600 samples per token (pads included) after the tail trim.
+        let audio = tts.generate_from_ipa("həloʊ", "Alias", 1.0, 5).unwrap();
+        assert_eq!(audio.len(), kittentts::tokenize::ipa_to_ids("həloʊ").len() * 600);
+        let batch = tts.generate_from_ipa_batch(&["həloʊ", "həloʊ", "həloʊ"], "a", 1.0).unwrap();
+        assert!(batch.iter().all(|a| a == &audio));
+        let stats = tts.engine_stats();
+        assert_eq!(stats.totals.chunks, 4);
+        assert_eq!(stats.arena_shrinks, 0);
+    }
+
+    #[cfg(not(feature = "tract"))]
+    #[test]
+    fn tract_backend_requires_feature() {
+        let err = KittenTtsOnnx::load_with_options(
+            Path::new("missing.onnx"),
+            Path::new("missing.npz"),
+            HashMap::new(),
+            HashMap::new(),
+            &LoadOptions { backend: BackendKind::Tract, ..Default::default() },
+        )
+        .err()
+        .expect("tract must not load without its feature");
+        assert!(format!("{err:#}").contains("`tract`"), "{err:#}");
+    }
+
+    #[cfg(not(feature = "onnxruntime"))]
+    #[test]
+    fn ort_backend_requires_feature() {
+        let err = KittenTtsOnnx::load_with_options(
+            Path::new("missing.onnx"),
+            Path::new("missing.npz"),
+            HashMap::new(),
+            HashMap::new(),
+            &LoadOptions { backend: BackendKind::Ort, ..Default::default() },
+        )
+        .err()
+        .expect("ORT must not load without its feature");
+        assert_eq!(BackendKind::default(), BackendKind::Tract);
+        assert!(format!("{err:#}").contains("`onnxruntime`"), "{err:#}");
+    }
+
+    #[cfg(feature = "tract")]
+    #[test]
+    fn tract_runs_the_model() {
+        let Some(dir) = super::model_dir() else {
+            eprintln!("SKIP tract_runs_the_model: model directory not found");
+            return;
+        };
+        let tts = load(&dir, BackendKind::Tract);
+        let voice = tts.available_voices.first().expect("at least one voice").clone();
+        let audio = tts.generate_from_ipa("həloʊ", &voice, 1.0, 5).unwrap();
+        assert!(!audio.is_empty() && audio.iter().all(|s| s.is_finite()));
+        assert!(tts.profile_report().is_none());
+    }
+
+    #[cfg(all(feature = "tract", feature = "onnxruntime"))]
+    #[test]
+    fn tract_matches_ort() {
+        let Some(dir) = super::model_dir() else {
+            eprintln!("SKIP tract_matches_ort: model directory not found");
+            return;
+        };
+        let ort = load(&dir, BackendKind::Ort);
+        let tract = load(&dir, BackendKind::Tract);
+        assert_eq!(tract.backend_name(), "tract");
+        let voice = ort.available_voices.first().expect("at least one voice").clone();
+
+        for (ipa, speed) in [("həloʊ", 1.0), ("ðə kwɪk bɹaʊn fɑːks.", 1.3)] {
+            let a = ort.generate_from_ipa(ipa, &voice, speed, ipa.len()).unwrap();
+            let b = tract.generate_from_ipa(ipa, &voice, speed, ipa.len()).unwrap();
+            assert_eq!(a.len(), b.len(), "{ipa}: lengths differ");
+            let max_diff = a.iter().zip(&b).map(|(x, y)| (x - y).abs()).fold(0.0f32, f32::max);
+            assert!(max_diff < 1e-2, "{ipa}: tract differs from ORT by up to {max_diff}");
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// § affinity (Linux CPU sets)
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(all(target_os = "linux", feature = "onnxruntime"))]
+mod affinity {
+    use kittentts::affinity::{allowed_cpus, current_cpu, pin_current_thread, Replicas};
+    use kittentts::jobs::JobStatus;
+    use kittentts::model::{KittenTtsOnnx, LoadOptions};
+    use std::collections::HashMap;
+
+    #[test]
+    fn replicas_serve_requests_on_local_cpus() {
+        let Some(dir) = super::model_dir() else {
+            eprintln!("SKIP replicas_serve_requests_on_local_cpus: model directory not found");
+            return;
+        };
+        let sets = allowed_cpus().unwrap().split(2);
+        if sets.len() < 2 {
+            eprintln!("SKIP replicas_serve_requests_on_local_cpus: needs two CPUs");
+            return;
+        }
+        let replicas = Replicas::load(
+            sets.clone(),
+            |options| {
+                KittenTtsOnnx::load_with_options(
+                    &dir.join("kitten_tts_mini_v0_8.onnx"),
+                    &dir.join("voices.npz"),
+                    HashMap::new(),
+                    HashMap::new(),
+                    options,
+                )
+            },
+            &LoadOptions::default(),
+        )
+        .expect("replicas should load");
+        assert_eq!(replicas.len(), 2);
+        let voice = replicas.model(0).available_voices[0].clone();
+        let reference = replicas.model(0).generate_from_ipa("həloʊ", &voice, 1.0, 5).unwrap();
+
+        // A caller pinned to the second set is served by the second replica,
+        // on a worker confined to that set.
+        let local = sets[1].clone();
+        let (index, job) = std::thread::scope(|s| {
+            s.spawn(|| {
+                pin_current_thread(&local).unwrap();
+                let index = replicas.local_index();
+                let (local, voice) = (local.clone(), voice.clone());
+                let job = replicas.submit(move |tts, _| {
+                    let cpu = current_cpu().unwrap();
+                    anyhow::ensure!(local.contains(cpu), "worker ran on CPU {cpu}, outside {local}");
+                    tts.generate_from_ipa("həloʊ", &voice, 1.0, 5)
+                });
+                (index, job)
+            })
+            .join()
+            .unwrap()
+        });
+        assert_eq!(index, 1);
+        assert_eq!(job.wait(None), JobStatus::Done);
+        let audio = job.take_result().unwrap().unwrap();
+        assert_eq!(audio.len(), reference.len());
+        assert_eq!(replicas.model(1).engine_stats().requests, 1);
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// § download (a local stand-in for the Hub)
+// ─────────────────────────────────────────────────────────────────────────────
+
+mod download {
+    use anyhow::{Context, Result};
+    use kittentts::download::{load_from_fetcher, LoadProgress, RepoFetcher};
+    use kittentts::model::LoadOptions;
+    use std::path::PathBuf;
+    use std::sync::atomic::{AtomicUsize, Ordering};
+    use std::time::Duration;
+
+    /// Serves `config.json` from `config_dir` and everything else from
+    /// `files_dir`, with latency, recording how many fetches overlap.
+    struct SlowDir {
+        config_dir: PathBuf,
+        files_dir: PathBuf,
+        in_flight: AtomicUsize,
+        max_in_flight: AtomicUsize,
+    }
+
+    impl RepoFetcher for SlowDir {
+        fn fetch(&self, filename: &str) -> Result<PathBuf> {
+            let now = self.in_flight.fetch_add(1, Ordering::SeqCst) + 1;
+            self.max_in_flight.fetch_max(now, Ordering::SeqCst);
+            std::thread::sleep(Duration::from_millis(100));
+            self.in_flight.fetch_sub(1, Ordering::SeqCst);
+
+            let dir = if filename == "config.json" { &self.config_dir } else { &self.files_dir };
+            let path = dir.join(filename);
+            path.exists().then_some(path).with_context(|| format!("404: {filename}"))
+        }
+    }
+
+    fn stand_in(name: &str, config: &str, files_dir: PathBuf) -> SlowDir {
+        let config_dir = std::env::temp_dir().join(format!("kittentts_fetch_{name}"));
+        std::fs::create_dir_all(&config_dir).unwrap();
+        std::fs::write(config_dir.join("config.json"), config).unwrap();
+        SlowDir {
+            config_dir,
+            files_dir,
+            in_flight: AtomicUsize::new(0),
+            max_in_flight: AtomicUsize::new(0),
+        }
+    }
+
+    #[test]
+    fn unsupported_model_type_fails_before_fetching_files() {
+        let repo = stand_in(
+            "bad_type",
+            r#"{"type":"TFLITE","model_file":"m.onnx","voices":"v.npz"}"#,
+            std::env::temp_dir(),
+        );
+        let mut events = 0;
+        let err = load_from_fetcher(&repo, &LoadOptions::default(), |_| events += 1)
+            .err()
+            .expect("should reject the model type");
+        assert!(format!("{err:#}").contains("TFLITE"), "{err:#}");
+        assert_eq!(events, 1);
+    }
+
+    #[cfg(feature = "onnxruntime")]
+    #[test]
+    fn model_and_voices_are_fetched_concurrently() {
+        let Some(model_dir) = super::model_dir() else {
+            eprintln!("SKIP model_and_voices_are_fetched_concurrently: model directory not found");
+            return;
+        };
+        let repo = stand_in(
+            "concurrent",
+            r#"{"type":"ONNX1","model_file":"kitten_tts_mini_v0_8.onnx","voices":"voices.npz"}"#,
+            model_dir,
+        );
+        let mut events = Vec::new();
+        let tts = load_from_fetcher(&repo, &LoadOptions::default(), |p| events.push(p))
+            .expect("load_from_fetcher should succeed");
+
+        assert!(!tts.available_voices.is_empty());
+        assert_eq!(repo.max_in_flight.load(Ordering::SeqCst), 2);
+        assert!(matches!(events.as_slice(), [
+            LoadProgress::Fetching { step: 1, .. },
+            LoadProgress::Fetching { step: 2, .. },
+            LoadProgress::Fetching { step: 3, .. },
+            LoadProgress::Loading,
+        ]), "{events:?}");
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// § perf baseline (requires `espeak` and `onnxruntime` features)
+// ─────────────────────────────────────────────────────────────────────────────
+
+#[cfg(all(feature = "espeak", feature = "onnxruntime"))]
+mod baseline {
+    use kittentts::baseline::{compare, record_corpus, Thresholds, Verdict, REFERENCE_CORPUS};
+    use kittentts::model::KittenTtsOnnx;
+    use std::collections::HashMap;
+
+    #[test]
+    fn record_and_compare_against_self() {
+        let Some(dir) = super::model_dir() else {
+            eprintln!("SKIP record_and_compare_against_self: model files not found");
+            return;
+        };
+        let tts = KittenTtsOnnx::load(
+            &dir.join("kitten_tts_mini_v0_8.onnx"),
+            &dir.join("voices.npz"),
+            HashMap::new(),
+            HashMap::new(),
+        )
+        .expect("model should load");
+        let voice = tts.available_voices.first().expect("at least one voice");
+
+        let b = record_corpus(&tts, &REFERENCE_CORPUS[..2], voice, 2, 1, "e2e")
+            .expect("record_corpus should succeed");
+        assert_eq!(b.utterances, 4);
+        assert!(b.chars_per_sec > 0.0 && b.audio_sec_per_sec > 0.0, "{b:?}");
+        assert!(b.latency_ms.p50 > 0.0 && b.latency_ms.p99 >= b.latency_ms.p50);
+        assert!(b.stages.inference_ms > 0.0);
+
+        let cmp = compare(&b, &b, &Thresholds::default());
+        assert!(cmp.metrics.iter().all(|m| m.verdict == Verdict::Unchanged), "{cmp}");
+    }
 }
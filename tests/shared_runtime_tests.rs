@@ -0,0 +1,73 @@
+//! Tests for the process-wide ORT thread pools (`kittentts::runtime`).
+//!
+//! ORT's environment is created once per process, so these live in their
+//! own test binary: the shared pools must be initialised before any model
+//! in the process is loaded, which `tests/integration_tests.rs` can't
+//! guarantee.  Everything runs in one test function for the same reason.
+//!
+//! Run with:
+//!   KITTENTTS_MODEL_DIR=… cargo test --test shared_runtime_tests
+
+#![cfg(feature = "onnxruntime")]
+
+use std::collections::HashMap;
+
+use kittentts::{
+    model::{KittenTtsOnnx, LoadOptions},
+    runtime::{self, ThreadPoolOptions},
+};
+
+#[path = "../benches/common/mod.rs"]
+mod common;
+
+/// Threads in this process, where the OS makes that cheap to find out.
+fn thread_count() -> Option<usize> {
+    std::fs::read_dir("/proc/self/task").ok().map(|d| d.count())
+}
+
+#[test]
+fn sessions_share_one_set_of_pools() {
+    let Some(dir) = common::model_dir() else {
+        eprintln!("SKIP sessions_share_one_set_of_pools: model files not found");
+        return;
+    };
+    let pools = ThreadPoolOptions { intra_threads: Some(2), spin: Some(false), ..Default::default() };
+    runtime::init(pools.clone()).expect("first init should succeed");
+    runtime::init(pools.clone()).expect("repeating the same options is a no-op");
+    assert!(runtime::init(ThreadPoolOptions::default()).is_err(), "different options must fail");
+    assert_eq!(runtime::shared(), Some(&pools));
+
+    let load = |shared_threads| {
+        KittenTtsOnnx::load_with_options(
+            &dir.join("kitten_tts_mini_v0_8.onnx"),
+            &dir.join("voices.npz"),
+            HashMap::new(),
+            HashMap::new(),
+            &LoadOptions { session_pool_size: 4, shared_threads, ..Default::default() },
+        )
+        .expect("load should succeed")
+    };
+    let before = thread_count();
+    let shared = load(true);
+    let voice = shared.available_voices[0].clone();
+
+    // Four sessions in flight at once, all on the one shared intra-op pool.
+    let outputs: Vec<Vec<f32>> = std::thread::scope(|s| {
+        let handles: Vec<_> = (0..4)
+            .map(|_| s.spawn(|| shared.generate_from_ipa("həloʊ", &voice, 1.0, 5).unwrap()))
+            .collect();
+        handles.into_iter().map(|h| h.join().unwrap()).collect()
+    });
+    if let (Some(before), Some(after)) = (before, thread_count()) {
+        // One extra pool thread (intra_threads includes the caller), not one per session.
+        assert!(after <= before + 1, "threads grew from {before} to {after}");
+    }
+
+    let own = load(false);
+    let reference = own.generate_from_ipa("həloʊ", &voice, 1.0, 5).unwrap();
+    for audio in &outputs {
+        assert_eq!(audio.len(), reference.len());
+        let max_diff = audio.iter().zip(&reference).map(|(a, b)| (a - b).abs()).fold(0.0f32, f32::max);
+        assert!(max_diff < 1e-3, "shared-pool audio differs by up to {max_diff}");
+    }
+}